@@ -0,0 +1,135 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <system_error>
+#include <utility>
+#include <Windows.h>
+
+namespace wl {
+
+// Page-granular buffer for gigabyte-class data, allocated straight from
+// VirtualAlloc instead of the heap. When the process holds the lock-memory
+// privilege the pages are large (2MB on x64), which spares TLB misses in
+// scan loops over the buffer; without the privilege, or when the large-page
+// allocation fails (it needs contiguous physical memory), it silently falls
+// back to ordinary 4KB pages. The memory can optionally be bound to a NUMA
+// node, keeping a scan thread pinned there working against local RAM.
+class big_buffer final {
+private:
+	BYTE*  _pMem = nullptr;
+	size_t _sz = 0;          // size the caller asked for
+	bool   _largePages = false;
+
+public:
+	~big_buffer() {
+		this->free();
+	}
+
+	big_buffer() = default;
+	big_buffer(big_buffer&& other) noexcept :
+		_pMem{other._pMem}, _sz{other._sz}, _largePages{other._largePages}
+	{
+		other._pMem = nullptr;
+		other._sz = 0;
+		other._largePages = false;
+	}
+
+	big_buffer& operator=(big_buffer&& other) noexcept {
+		this->free();
+		std::swap(this->_pMem, other._pMem);
+		std::swap(this->_sz, other._sz);
+		std::swap(this->_largePages, other._largePages);
+		return *this;
+	}
+
+	BYTE*  data() const noexcept             { return this->_pMem; }
+	size_t size() const noexcept             { return this->_sz; }
+	bool   empty() const noexcept            { return !this->_sz; }
+	bool   uses_large_pages() const noexcept { return this->_largePages; }
+
+	big_buffer& free() noexcept {
+		if (this->_pMem) {
+			VirtualFree(this->_pMem, 0, MEM_RELEASE);
+			this->_pMem = nullptr;
+			this->_sz = 0;
+			this->_largePages = false;
+		}
+		return *this;
+	}
+
+	// Allocates the buffer, freeing any previous allocation. Pass a NUMA node
+	// to bind the physical pages to it; -1 lets the system choose. Large pages
+	// are attempted first when available, plain 4KB pages otherwise.
+	big_buffer& alloc(size_t numBytes, int numaNode = -1) {
+		this->free();
+		if (!numBytes) return *this;
+
+		size_t largeMin = _large_page_minimum();
+		if (largeMin) { // privilege held and hardware supports it
+			size_t rounded = (numBytes + largeMin - 1) / largeMin * largeMin; // MEM_LARGE_PAGES requires multiples
+			this->_pMem = static_cast<BYTE*>(this->_virtual_alloc(rounded,
+				MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, numaNode));
+			if (this->_pMem) {
+				this->_sz = numBytes;
+				this->_largePages = true;
+				return *this;
+			}
+			// Physical memory too fragmented for contiguous large pages right
+			// now; fall through to the ordinary allocation.
+		}
+
+		this->_pMem = static_cast<BYTE*>(this->_virtual_alloc(numBytes,
+			MEM_RESERVE | MEM_COMMIT, numaNode));
+		if (!this->_pMem) {
+			throw std::system_error(GetLastError(), std::system_category(),
+				"VirtualAlloc failed when trying to allocate big buffer");
+		}
+		this->_sz = numBytes;
+		return *this;
+	}
+
+	// Tries to enable SeLockMemoryPrivilege on the process token, which
+	// MEM_LARGE_PAGES requires; returns whether large pages are usable. Called
+	// lazily by alloc(), but call it at startup to learn upfront whether the
+	// account has the "Lock pages in memory" right.
+	static bool enable_large_pages() noexcept {
+		return _large_page_minimum() != 0;
+	}
+
+private:
+	static LPVOID _virtual_alloc(size_t numBytes, DWORD allocType, int numaNode) noexcept {
+		if (numaNode >= 0) {
+			return VirtualAllocExNuma(GetCurrentProcess(), nullptr, numBytes,
+				allocType, PAGE_READWRITE, static_cast<DWORD>(numaNode));
+		}
+		return VirtualAlloc(nullptr, numBytes, allocType, PAGE_READWRITE);
+	}
+
+	// Large page size when the privilege could be enabled, 0 otherwise.
+	// The token adjustment runs once per process.
+	static size_t _large_page_minimum() noexcept {
+		static size_t largeMin = []() noexcept -> size_t {
+			HANDLE hToken = nullptr;
+			if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES, &hToken)) {
+				return 0;
+			}
+			TOKEN_PRIVILEGES tp{};
+			tp.PrivilegeCount = 1;
+			tp.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+			bool enabled = LookupPrivilegeValueW(nullptr, SE_LOCK_MEMORY_NAME,
+					&tp.Privileges[0].Luid) &&
+				AdjustTokenPrivileges(hToken, FALSE, &tp, 0, nullptr, nullptr) &&
+				GetLastError() == ERROR_SUCCESS; // AdjustTokenPrivileges "succeeds" even when it grants nothing
+			CloseHandle(hToken);
+			return enabled ? GetLargePageMinimum() : 0;
+		}();
+		return largeMin;
+	}
+};
+
+}//namespace wl
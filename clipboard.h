@@ -0,0 +1,195 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <functional>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <Windows.h>
+#include <CommCtrl.h>
+
+namespace wl {
+namespace _wli {
+
+// Pending delayed-render callbacks behind clipboard::set_text_delayed, keyed
+// by the owner window. The text lambda runs only when some app actually
+// pastes; until then the clipboard holds a null CF_UNICODETEXT promise.
+class clipboard_render final {
+private:
+	struct _pending final {
+		HWND                          hOwner = nullptr;
+		std::function<std::wstring()> render;
+	};
+
+	std::vector<_pending> _pendings; // one live copy per owner window at most
+
+	clipboard_render() = default;
+
+public:
+	clipboard_render(const clipboard_render&) = delete;
+	clipboard_render& operator=(const clipboard_render&) = delete;
+
+	static clipboard_render& instance() {
+		static clipboard_render obj; // thread-safe in C++11
+		return obj;
+	}
+
+	void set(HWND hOwner, std::function<std::wstring()> render) {
+		for (_pending& p : this->_pendings) {
+			if (p.hOwner == hOwner) {
+				p.render = std::move(render); // new copy replaces the old promise
+				return;
+			}
+		}
+		this->_pendings.push_back({hOwner, std::move(render)});
+	}
+
+	std::function<std::wstring()>* find(HWND hOwner) noexcept {
+		for (_pending& p : this->_pendings) {
+			if (p.hOwner == hOwner) return &p.render;
+		}
+		return nullptr;
+	}
+
+	void clear(HWND hOwner) noexcept {
+		for (size_t i = 0; i < this->_pendings.size(); ++i) {
+			if (this->_pendings[i].hOwner == hOwner) {
+				this->_pendings.erase(this->_pendings.begin() + i);
+				return;
+			}
+		}
+	}
+};
+
+// Copies the text into a movable global block, the ownership-transfer format
+// SetClipboardData wants for CF_UNICODETEXT.
+inline HGLOBAL clipboard_alloc_text(const std::wstring& text) {
+	size_t numBytes = (text.length() + 1) * sizeof(wchar_t);
+	HGLOBAL hGlob = GlobalAlloc(GMEM_MOVEABLE, numBytes);
+	if (!hGlob) {
+		throw std::system_error(GetLastError(), std::system_category(),
+			"GlobalAlloc failed for clipboard text");
+	}
+	CopyMemory(GlobalLock(hGlob), text.c_str(), numBytes);
+	GlobalUnlock(hGlob);
+	return hGlob;
+}
+
+}//namespace _wli
+
+// Clipboard helpers. Besides the plain set_text/get_text pair, the delayed
+// variants make copying large grids instantaneous: the clipboard gets a null
+// CF_UNICODETEXT promise and the serialization lambda runs only if another
+// app actually pastes.
+namespace clipboard {
+
+// Copies the text to the clipboard right away, building the whole block now.
+inline void set_text(HWND hOwner, const std::wstring& text) {
+	if (!OpenClipboard(hOwner)) {
+		throw std::system_error(GetLastError(), std::system_category(),
+			"OpenClipboard failed");
+	}
+	EmptyClipboard();
+	SetClipboardData(CF_UNICODETEXT, _wli::clipboard_alloc_text(text));
+	CloseClipboard();
+}
+
+// Returns the clipboard text, or an empty string if no text is available.
+inline std::wstring get_text() {
+	std::wstring ret;
+	if (!IsClipboardFormatAvailable(CF_UNICODETEXT) || !OpenClipboard(nullptr)) {
+		return ret;
+	}
+	HGLOBAL hGlob = GetClipboardData(CF_UNICODETEXT);
+	if (hGlob) {
+		ret = reinterpret_cast<const wchar_t*>(GlobalLock(hGlob));
+		GlobalUnlock(hGlob);
+	}
+	CloseClipboard();
+	return ret;
+}
+
+// Announces text on the clipboard without building it: the copy returns
+// instantly however big the content, and the lambda serializes it only when
+// another app pastes. The owner must forward three messages:
+//   on_message(WM_RENDERFORMAT,     ...) -> clipboard::render_now(hwnd())
+//   on_message(WM_RENDERALLFORMATS, ...) -> clipboard::render_all(hwnd())
+//   on_message(WM_DESTROYCLIPBOARD, ...) -> clipboard::owner_lost(hwnd())
+inline void set_text_delayed(HWND hOwner, std::function<std::wstring()> renderer) {
+	if (!OpenClipboard(hOwner)) {
+		throw std::system_error(GetLastError(), std::system_category(),
+			"OpenClipboard failed");
+	}
+	EmptyClipboard();
+	SetClipboardData(CF_UNICODETEXT, nullptr); // null handle = render on demand
+	CloseClipboard();
+	_wli::clipboard_render::instance().set(hOwner, std::move(renderer));
+}
+
+// Call from the owner's WM_RENDERFORMAT handler: runs the pending lambda and
+// hands the built text over. The clipboard is already open here, per the API
+// contract, so only SetClipboardData is issued.
+inline void render_now(HWND hOwner) {
+	std::function<std::wstring()>* pRender = _wli::clipboard_render::instance().find(hOwner);
+	if (pRender && *pRender) {
+		SetClipboardData(CF_UNICODETEXT, _wli::clipboard_alloc_text((*pRender)()));
+	}
+}
+
+// Call from the owner's WM_RENDERALLFORMATS handler: the window is going away
+// while still owning the clipboard, so the promise must be fulfilled now.
+inline void render_all(HWND hOwner) {
+	if (!OpenClipboard(hOwner)) return;
+	if (GetClipboardOwner() == hOwner) {
+		render_now(hOwner);
+	}
+	CloseClipboard();
+	_wli::clipboard_render::instance().clear(hOwner);
+}
+
+// Call from the owner's WM_DESTROYCLIPBOARD handler: someone else took the
+// clipboard, the pending lambda will never run and can be dropped.
+inline void owner_lost(HWND hOwner) {
+	_wli::clipboard_render::instance().clear(hOwner);
+}
+
+// Builds a renderer over listview cells for set_text_delayed: when pasted, the
+// selected rows are serialized as tab-separated columns with CRLF row ends,
+// through one reused LVM_GETITEMTEXT buffer — no per-cell allocation, and no
+// cost at all if the user never pastes.
+inline std::function<std::wstring()> listview_renderer(HWND hList, std::vector<size_t> columns) {
+	return [hList, columns]() -> std::wstring {
+		std::wstring ret, cellBuf(64, L'\0');
+		ret.reserve(static_cast<size_t>(ListView_GetSelectedCount(hList)) * 32); // guess, grows if short
+
+		int iItem = -1;
+		while ((iItem = ListView_GetNextItem(hList, iItem, LVNI_SELECTED)) != -1) {
+			for (size_t c = 0; c < columns.size(); ++c) {
+				LVITEMW lvi{};
+				lvi.iItem = iItem;
+				lvi.iSubItem = static_cast<int>(columns[c]);
+				int written = 0;
+				for (;;) {
+					lvi.cchTextMax = static_cast<int>(cellBuf.size());
+					lvi.pszText = &cellBuf[0];
+					written = static_cast<int>(SendMessageW(hList, LVM_GETITEMTEXT,
+						iItem, reinterpret_cast<LPARAM>(&lvi)));
+					if (written < static_cast<int>(cellBuf.size()) - 1) break;
+					cellBuf.resize(cellBuf.size() * 2); // didn't fit, retry bigger
+				}
+				if (c) ret += L'\t';
+				ret.append(cellBuf.data(), static_cast<size_t>(written));
+			}
+			ret += L"\r\n";
+		}
+		return ret;
+	};
+}
+
+}//namespace clipboard
+}//namespace wl
@@ -10,6 +10,7 @@
 #include "internals/styler.h"
 #include "str.h"
 #include "wnd.h"
+#include "wstr_view.h"
 
 namespace wl {
 
@@ -80,8 +81,47 @@ public:
 		return *this;
 	}
 
+	// Adds one entry from a slice, with no delimiter parsing. CB_ADDSTRING
+	// wants termination, so the view is staged through a per-thread buffer
+	// reused across calls; a parser feeding slices of a mapped file adds
+	// entries without one wstring each once the buffer is warm.
+	combobox& add(wstr_view entry) {
+		thread_local std::wstring buf;
+		SendMessageW(this->_hWnd, CB_ADDSTRING, 0,
+			reinterpret_cast<LPARAM>(entry.c_str_in(buf)));
+		return *this;
+	}
+
+	// Adds many entries at once, already split by the caller. The control storage is
+	// pre-allocated with CB_INITSTORAGE and redrawing is suspended until the last
+	// entry is in, which avoids the per-entry reallocation and repaint that make
+	// add() slow on tens of thousands of entries.
+	combobox& add_many(const std::vector<std::wstring>& entries) noexcept {
+		size_t totalBytes = 0;
+		for (const std::wstring& s : entries) {
+			totalBytes += (s.length() + 1) * sizeof(wchar_t);
+		}
+		SendMessageW(this->_hWnd, CB_INITSTORAGE,
+			entries.size(), static_cast<LPARAM>(totalBytes));
+
+		SendMessageW(this->_hWnd, WM_SETREDRAW, static_cast<WPARAM>(FALSE), 0);
+		for (const std::wstring& s : entries) {
+			SendMessageW(this->_hWnd, CB_ADDSTRING, 0, reinterpret_cast<LPARAM>(s.c_str()));
+		}
+		SendMessageW(this->_hWnd, WM_SETREDRAW, static_cast<WPARAM>(TRUE), 0);
+		return *this;
+	}
+
 	std::wstring get_text(size_t index) const {
 		std::wstring buf;
+		this->get_text_to(index, buf);
+		return buf;
+	}
+
+	// Retrieves the text of the given item into a caller-provided buffer, reusing
+	// its capacity across calls so repeated reads stay allocation-free. Returns buf.
+	std::wstring& get_text_to(size_t index, std::wstring& buf) const {
+		buf.clear();
 		size_t len = SendMessageW(this->_hWnd, CB_GETLBTEXTLEN, index, 0);
 		if (len) {
 			buf.resize(len, L'\0');
@@ -0,0 +1,158 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <functional>
+#include <vector>
+#include "menu.h"
+#include <CommCtrl.h>
+
+namespace wl {
+
+// Coalesces enable/check state of command ids. Instead of pushing dozens of
+// EnableMenuItem/CheckMenuItem calls on every selection change, the
+// application declares one state lambda per command id and only marks ids
+// dirty when its state changes. Evaluation is deferred to update_menu() —
+// called from WM_INITMENUPOPUP, so only commands of the menu actually opening
+// are evaluated — and the result is diffed against what was last applied, so
+// USER calls happen only for states that really changed.
+class command_state final {
+public:
+	// Desired state of one command; returned by the evaluator lambdas.
+	struct state final {
+		bool enabled = true;
+		bool checked = false;
+
+		bool operator==(const state& other) const noexcept {
+			return this->enabled == other.enabled && this->checked == other.checked;
+		}
+		bool operator!=(const state& other) const noexcept { return !this->operator==(other); }
+	};
+
+private:
+	struct _entry final {
+		WORD                   cmdId = 0;
+		std::function<state()> evaluator;
+		bool                   dirty = true;
+		state                  value; // last evaluated, meaningful only when !dirty
+		// What each target currently shows; unconditional first apply, diff after.
+		bool  menuKnown = false,  toolbarKnown = false;
+		state menuApplied,        toolbarApplied;
+	};
+
+	std::vector<_entry> _entries; // a few dozen commands, linear scan is fine
+
+public:
+	command_state() = default;
+	command_state(command_state&&) = default;
+	command_state& operator=(command_state&&) = default; // movable only
+
+	// Declares the state lambda of a command id, replacing any previous one.
+	command_state& set(WORD cmdId, std::function<state()> evaluator) {
+		_entry* e = this->_find(cmdId);
+		if (!e) {
+			this->_entries.emplace_back();
+			e = &this->_entries.back();
+			e->cmdId = cmdId;
+		}
+		e->evaluator = std::move(evaluator);
+		e->dirty = true;
+		return *this;
+	}
+
+	// Marks one command dirty; its lambda will run again on the next update.
+	// Call this from the code that changes the state the lambda reads — it is
+	// just a flag store, no USER call happens here.
+	command_state& invalidate(WORD cmdId) noexcept {
+		_entry* e = this->_find(cmdId);
+		if (e) e->dirty = true;
+		return *this;
+	}
+
+	// Marks every command dirty, for coarse events like selection change.
+	command_state& invalidate_all() noexcept {
+		for (_entry& e : this->_entries) {
+			e.dirty = true;
+		}
+		return *this;
+	}
+
+	// Refreshes the commands of the given menu; call from WM_INITMENUPOPUP
+	// passing the wParam. Only items of this menu are touched, only dirty ones
+	// are re-evaluated, and Enable/CheckMenuItem run only when the evaluated
+	// state differs from what the menu already shows.
+	void update_menu(HMENU hOpeningMenu) {
+		menu m{hOpeningMenu};
+		size_t numItems = m.get_item_count();
+
+		for (size_t pos = 0; pos < numItems; ++pos) {
+			WORD cmdId = m.get_item_id(pos);
+			if (cmdId == static_cast<WORD>(-1)) continue; // separator or submenu
+
+			_entry* e = this->_find(cmdId);
+			if (!e || !e->evaluator) continue;
+
+			this->_evaluate_if_dirty(*e);
+			if (e->menuKnown && e->menuApplied == e->value) continue; // nothing changed
+
+			if (!e->menuKnown || e->menuApplied.enabled != e->value.enabled) {
+				m.enable_item_by_id(cmdId, e->value.enabled);
+			}
+			if (!e->menuKnown || e->menuApplied.checked != e->value.checked) {
+				m.set_item_check_by_id(cmdId, e->value.checked);
+			}
+			e->menuApplied = e->value;
+			e->menuKnown = true;
+		}
+	}
+
+	void update_menu(const menu& m) { this->update_menu(m.hmenu()); }
+
+	// Refreshes the declared commands present on the given toolbar, sending
+	// TB_ENABLEBUTTON/TB_CHECKBUTTON only for states that actually changed.
+	// Unlike menus there is no "opening" moment, so call this after
+	// invalidating, typically from the same place that changes the selection.
+	void update_toolbar(HWND hToolbar) {
+		for (_entry& e : this->_entries) {
+			if (!e.evaluator) continue;
+			if (SendMessageW(hToolbar, TB_COMMANDTOINDEX, e.cmdId, 0) == -1) {
+				continue; // this command has no button here
+			}
+
+			this->_evaluate_if_dirty(e);
+			if (e.toolbarKnown && e.toolbarApplied == e.value) continue;
+
+			if (!e.toolbarKnown || e.toolbarApplied.enabled != e.value.enabled) {
+				SendMessageW(hToolbar, TB_ENABLEBUTTON, e.cmdId,
+					MAKELPARAM(e.value.enabled ? TRUE : FALSE, 0));
+			}
+			if (!e.toolbarKnown || e.toolbarApplied.checked != e.value.checked) {
+				SendMessageW(hToolbar, TB_CHECKBUTTON, e.cmdId,
+					MAKELPARAM(e.value.checked ? TRUE : FALSE, 0));
+			}
+			e.toolbarApplied = e.value;
+			e.toolbarKnown = true;
+		}
+	}
+
+private:
+	_entry* _find(WORD cmdId) noexcept {
+		for (_entry& e : this->_entries) {
+			if (e.cmdId == cmdId) return &e;
+		}
+		return nullptr;
+	}
+
+	void _evaluate_if_dirty(_entry& e) {
+		if (e.dirty) {
+			e.value = e.evaluator();
+			e.dirty = false;
+		}
+	}
+};
+
+}//namespace wl
@@ -1,141 +1,304 @@
-/**
- * Part of WinLamb - Win32 API Lambda Library
- * https://github.com/rodrigocfd/winlamb
- * Copyright 2017-present Rodrigo Cesar de Freitas Dias
- * This library is released under the MIT License
- */
-
-#pragma once
-#include <Windows.h>
-
-namespace wl {
-
-// Wrapper to SYSTEMTIME structure.
-class datetime final {
-private:
-	SYSTEMTIME _st{};
-
-public:
-	datetime() noexcept                     { this->set_now(); }
-	datetime(LONGLONG ms) noexcept          { this->operator=(ms); }
-	datetime(const SYSTEMTIME& st) noexcept { this->operator=(st); }
-	datetime(const FILETIME& ft) noexcept   { this->operator=(ft); }
-
-	const SYSTEMTIME& systemtime() const noexcept {
-		return this->_st;
-	}
-
-	datetime& operator=(LONGLONG ms) noexcept {
-		SecureZeroMemory(&this->_st, sizeof(SYSTEMTIME));
-
-		this->_st.wMilliseconds = ms % 1000;
-		ms = (ms - this->_st.wMilliseconds) / 1000; // now in seconds
-		this->_st.wSecond = ms % 60;
-		ms = (ms - this->_st.wSecond) / 60; // now in minutes
-		this->_st.wMinute = ms % 60;
-		ms = (ms - this->_st.wMinute) / 60; // now in hours
-		this->_st.wHour = ms % 24;
-		ms = (ms - this->_st.wHour) / 24; // now in days
-		return *this;
-	}
-
-	datetime& operator=(const SYSTEMTIME& st) noexcept {
-		memcpy(&this->_st, &st, sizeof(SYSTEMTIME));
-		return *this;
-	}
-
-	datetime& operator=(const FILETIME& ft) noexcept {
-		SYSTEMTIME st1{};
-		FileTimeToSystemTime(&ft, &st1);
-
-		TIME_ZONE_INFORMATION tzi{};
-		GetTimeZoneInformation(&tzi);
-		SystemTimeToTzSpecificLocalTime(&tzi, &st1, &this->_st);
-		return *this;
-	}
-
-	datetime& set_now() noexcept {
-		SYSTEMTIME st1{};
-		GetSystemTime(&st1);
-
-		TIME_ZONE_INFORMATION tzi{};
-		GetTimeZoneInformation(&tzi);
-		SystemTimeToTzSpecificLocalTime(&tzi, &st1, &this->_st);
-		return *this;
-	}
-
-	LONGLONG timestamp() const noexcept {
-		// http://www.frenk.com/2009/12/convert-filetime-to-unix-timestamp/
-		LARGE_INTEGER date, adjust;
-		_st_to_li(this->_st, date);
-		adjust.QuadPart = 11644473600000 * 10000; // 100-nanoseconds = milliseconds * 10000
-		date.QuadPart -= adjust.QuadPart; // removes the diff between 1970 and 1601
-		//return date.QuadPart / 10000000; // converts back from 100-nanoseconds to seconds
-		return date.QuadPart / 10000; // to milliseconds; to printf use %I64u
-	}
-
-	size_t ms_diff_from(const datetime& other) const noexcept {
-		LARGE_INTEGER liUs, liThem;
-		_st_to_li(this->_st, liUs);
-		_st_to_li(other._st, liThem);
-
-		// 100-nanoseconds to milliseconds; to printf a LARGE_INTEGER use %I64u.
-		// To int32, max is 1,193 hours; to int64, a shitload of hours.
-		return static_cast<size_t>((liUs.QuadPart - liThem.QuadPart) / 10000);
-	}
-
-	datetime& add_ms(LONGLONG ms) noexcept {
-		LARGE_INTEGER li;
-		_st_to_li(this->_st, li);
-		li.QuadPart += ms * 10000; // milliseconds to 100-nanoseconds
-		_li_to_st(li, this->_st);
-		return *this;
-	}
-
-	datetime& add_sec(LONGLONG sec) noexcept { return this->add_ms(sec * 1000); }
-	datetime& add_min(LONGLONG min) noexcept { return this->add_sec(min * 60); }
-	datetime& add_hour(LONGLONG h) noexcept  { return this->add_min(h * 60); }
-	datetime& add_day(LONGLONG d) noexcept   { return this->add_hour(d * 24); }
-
-	const wchar_t* name_month() const noexcept {
-		const wchar_t* months[] = { L"January", L"February", L"March", L"April", L"May", L"June",
-			L"July", L"August", L"September", L"October", L"November", L"December" };
-		return months[this->_st.wMonth - 1];
-	}
-
-	const wchar_t* name_month_short() const noexcept {
-		const wchar_t* months[] = { L"Jan", L"Feb", L"Mar", L"Apr", L"May", L"Jun",
-			L"Jul", L"Aug", L"Sep", L"Oct", L"Nov", L"Dec" };
-		return months[this->_st.wMonth - 1];
-	}
-
-	const wchar_t* name_weekday() const noexcept {
-		const wchar_t* weekday[] = { L"Sunday", L"Monday", L"Tuesday", L"Wednesday",
-			L"Thursday", L"Friday", L"Saturday" };
-		return weekday[this->_st.wDayOfWeek];
-	}
-
-	const wchar_t* name_weekday_short() const noexcept {
-		const wchar_t* weekday[] = { L"Sun", L"Mon", L"Tue", L"Wed", L"Thu", L"Fri", L"Sat" };
-		return weekday[this->_st.wDayOfWeek];
-	}
-
-private:
-	static void _st_to_li(const SYSTEMTIME& st, LARGE_INTEGER& li) noexcept {
-		FILETIME ft{};
-		SystemTimeToFileTime(&st, &ft);
-
-		li.HighPart = ft.dwHighDateTime;
-		li.LowPart = ft.dwLowDateTime;
-	}
-
-	static void _li_to_st(const LARGE_INTEGER& li, SYSTEMTIME& st) noexcept {
-		FILETIME ft{};
-		ft.dwHighDateTime = li.HighPart;
-		ft.dwLowDateTime = li.LowPart;
-
-		FileTimeToSystemTime(&ft, &st);
-	}
-};
-
-}//namespace wl
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <Windows.h>
+
+namespace wl {
+namespace _wli {
+
+// Locale date/time pictures and AM/PM designators, fetched once per process;
+// datetime::format_to expands them itself, so formatting a timestamp never
+// goes back through GetDateFormat/GetTimeFormat.
+struct datetime_locale final {
+	wchar_t datePattern[80];
+	wchar_t timePattern[80];
+	wchar_t amDesig[16];
+	wchar_t pmDesig[16];
+
+	static const datetime_locale& get() noexcept {
+		static const datetime_locale obj; // thread-safe in C++11
+		return obj;
+	}
+
+private:
+	datetime_locale() noexcept {
+		if (!GetLocaleInfoW(LOCALE_USER_DEFAULT, LOCALE_SSHORTDATE, this->datePattern, ARRAYSIZE(this->datePattern))) {
+			lstrcpyW(this->datePattern, L"yyyy-MM-dd");
+		}
+		if (!GetLocaleInfoW(LOCALE_USER_DEFAULT, LOCALE_STIMEFORMAT, this->timePattern, ARRAYSIZE(this->timePattern))) {
+			lstrcpyW(this->timePattern, L"HH:mm:ss");
+		}
+		if (!GetLocaleInfoW(LOCALE_USER_DEFAULT, LOCALE_S1159, this->amDesig, ARRAYSIZE(this->amDesig))) {
+			lstrcpyW(this->amDesig, L"AM");
+		}
+		if (!GetLocaleInfoW(LOCALE_USER_DEFAULT, LOCALE_S2359, this->pmDesig, ARRAYSIZE(this->pmDesig))) {
+			lstrcpyW(this->pmDesig, L"PM");
+		}
+	}
+};
+
+}//namespace _wli
+
+// Date/time value over a 64-bit tick count (100-nanosecond intervals since
+// 1601, local time). Arithmetic and comparisons are plain integer ops; the
+// SYSTEMTIME breakdown is computed lazily and only at API boundaries.
+class datetime final {
+private:
+	LONGLONG           _ticks = 0;     // 100-ns intervals since 1601-01-01, local time
+	mutable SYSTEMTIME _st{};          // lazy breakdown of _ticks
+	mutable bool       _stValid = false;
+
+public:
+	datetime() noexcept                     { this->set_now(); }
+	datetime(LONGLONG ms) noexcept          { this->operator=(ms); }
+	datetime(const SYSTEMTIME& st) noexcept { this->operator=(st); }
+	datetime(const FILETIME& ft) noexcept   { this->operator=(ft); }
+
+	const SYSTEMTIME& systemtime() const noexcept {
+		if (!this->_stValid) { // breakdown deferred until someone actually needs fields
+			FILETIME ft{};
+			ft.dwHighDateTime = static_cast<DWORD>(this->_ticks >> 32);
+			ft.dwLowDateTime = static_cast<DWORD>(this->_ticks);
+			FileTimeToSystemTime(&ft, &this->_st);
+			this->_stValid = true;
+		}
+		return this->_st;
+	}
+
+	// Raw 100-nanosecond tick count; handy for bulk sorting and hashing.
+	LONGLONG ticks() const noexcept {
+		return this->_ticks;
+	}
+
+	datetime& operator=(LONGLONG ms) noexcept {
+		this->_ticks = ms * 10000; // milliseconds to 100-nanoseconds
+
+		// Kept from the SYSTEMTIME days: a bare duration breaks down into
+		// zero-dated fields, so it can be displayed as hours/minutes/seconds.
+		SecureZeroMemory(&this->_st, sizeof(SYSTEMTIME));
+		this->_st.wMilliseconds = ms % 1000;
+		ms = (ms - this->_st.wMilliseconds) / 1000; // now in seconds
+		this->_st.wSecond = ms % 60;
+		ms = (ms - this->_st.wSecond) / 60; // now in minutes
+		this->_st.wMinute = ms % 60;
+		ms = (ms - this->_st.wMinute) / 60; // now in hours
+		this->_st.wHour = ms % 24;
+		ms = (ms - this->_st.wHour) / 24; // now in days
+		this->_stValid = true;
+		return *this;
+	}
+
+	datetime& operator=(const SYSTEMTIME& st) noexcept {
+		FILETIME ft{};
+		SystemTimeToFileTime(&st, &ft);
+		this->_ticks = (static_cast<LONGLONG>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+
+		memcpy(&this->_st, &st, sizeof(SYSTEMTIME));
+		this->_stValid = true;
+		return *this;
+	}
+
+	datetime& operator=(const FILETIME& ft) noexcept {
+		SYSTEMTIME st1{};
+		FileTimeToSystemTime(&ft, &st1);
+
+		TIME_ZONE_INFORMATION tzi{};
+		GetTimeZoneInformation(&tzi);
+		SYSTEMTIME st2{};
+		SystemTimeToTzSpecificLocalTime(&tzi, &st1, &st2);
+		return this->operator=(st2);
+	}
+
+	datetime& set_now() noexcept {
+		SYSTEMTIME st1{};
+		GetSystemTime(&st1);
+
+		TIME_ZONE_INFORMATION tzi{};
+		GetTimeZoneInformation(&tzi);
+		SYSTEMTIME st2{};
+		SystemTimeToTzSpecificLocalTime(&tzi, &st1, &st2);
+		return this->operator=(st2);
+	}
+
+	LONGLONG timestamp() const noexcept {
+		// http://www.frenk.com/2009/12/convert-filetime-to-unix-timestamp/
+		LONGLONG epochDiff = 11644473600000 * 10000; // diff between 1970 and 1601, in 100-ns
+		//return (this->_ticks - epochDiff) / 10000000; // 100-nanoseconds to seconds
+		return (this->_ticks - epochDiff) / 10000; // to milliseconds; to printf use %I64u
+	}
+
+	size_t ms_diff_from(const datetime& other) const noexcept {
+		// 100-nanoseconds to milliseconds; pure integer math, no FILETIME round trip.
+		// To int32, max is 1,193 hours; to int64, a shitload of hours.
+		return static_cast<size_t>((this->_ticks - other._ticks) / 10000);
+	}
+
+	datetime& add_ms(LONGLONG ms) noexcept {
+		this->_ticks += ms * 10000; // milliseconds to 100-nanoseconds
+		this->_stValid = false; // breakdown recomputed on demand
+		return *this;
+	}
+
+	datetime& add_sec(LONGLONG sec) noexcept { return this->add_ms(sec * 1000); }
+	datetime& add_min(LONGLONG min) noexcept { return this->add_sec(min * 60); }
+	datetime& add_hour(LONGLONG h) noexcept  { return this->add_min(h * 60); }
+	datetime& add_day(LONGLONG d) noexcept   { return this->add_hour(d * 24); }
+
+	bool operator==(const datetime& other) const noexcept { return this->_ticks == other._ticks; }
+	bool operator!=(const datetime& other) const noexcept { return this->_ticks != other._ticks; }
+	bool operator<(const datetime& other) const noexcept  { return this->_ticks < other._ticks; }
+	bool operator<=(const datetime& other) const noexcept { return this->_ticks <= other._ticks; }
+	bool operator>(const datetime& other) const noexcept  { return this->_ticks > other._ticks; }
+	bool operator>=(const datetime& other) const noexcept { return this->_ticks >= other._ticks; }
+
+	const wchar_t* name_month() const noexcept {
+		const wchar_t* months[] = { L"January", L"February", L"March", L"April", L"May", L"June",
+			L"July", L"August", L"September", L"October", L"November", L"December" };
+		return months[this->systemtime().wMonth - 1];
+	}
+
+	const wchar_t* name_month_short() const noexcept {
+		const wchar_t* months[] = { L"Jan", L"Feb", L"Mar", L"Apr", L"May", L"Jun",
+			L"Jul", L"Aug", L"Sep", L"Oct", L"Nov", L"Dec" };
+		return months[this->systemtime().wMonth - 1];
+	}
+
+	const wchar_t* name_weekday() const noexcept {
+		const wchar_t* weekday[] = { L"Sunday", L"Monday", L"Tuesday", L"Wednesday",
+			L"Thursday", L"Friday", L"Saturday" };
+		return weekday[this->systemtime().wDayOfWeek];
+	}
+
+	const wchar_t* name_weekday_short() const noexcept {
+		const wchar_t* weekday[] = { L"Sun", L"Mon", L"Tue", L"Wed", L"Thu", L"Fri", L"Sat" };
+		return weekday[this->systemtime().wDayOfWeek];
+	}
+
+	// Formats into the caller's buffer, allocation-free, expanding the picture
+	// itself: d/dd/ddd/dddd, M/MM/MMM/MMMM, yy/yyyy, h/H, m, s, tt and 'quoted'
+	// literals, like GetDateFormat pictures. Returns the length written, or 0 if
+	// the buffer is too small (contents then undefined). Built for bulk paths
+	// formatting thousands of timestamps per repaint.
+	size_t format_to(wchar_t* buf, size_t bufLen, const wchar_t* pattern) const noexcept {
+		const SYSTEMTIME& st = this->systemtime();
+		const _wli::datetime_locale& loc = _wli::datetime_locale::get();
+		size_t o = 0;
+
+		for (size_t i = 0; pattern[i]; ) {
+			wchar_t c = pattern[i];
+
+			if (c == L'\'') { // quoted literal, copied verbatim
+				++i;
+				while (pattern[i] && pattern[i] != L'\'') {
+					if (!_put_char(buf, bufLen, o, pattern[i++])) return 0;
+				}
+				if (pattern[i]) ++i; // closing quote
+				continue;
+			}
+
+			size_t run = 1;
+			while (pattern[i + run] == c) ++run; // token length decides padding/name form
+			bool fit = true;
+
+			switch (c) {
+			case L'd':
+				if (run >= 4)      fit = _put_str(buf, bufLen, o, this->name_weekday());
+				else if (run == 3) fit = _put_str(buf, bufLen, o, this->name_weekday_short());
+				else               fit = _put_num(buf, bufLen, o, st.wDay, run);
+				break;
+			case L'M':
+				if (run >= 4)      fit = _put_str(buf, bufLen, o, this->name_month());
+				else if (run == 3) fit = _put_str(buf, bufLen, o, this->name_month_short());
+				else               fit = _put_num(buf, bufLen, o, st.wMonth, run);
+				break;
+			case L'y':
+				if (run >= 3) fit = _put_num(buf, bufLen, o, st.wYear, 4);
+				else          fit = _put_num(buf, bufLen, o, st.wYear % 100, 2);
+				break;
+			case L'h': {
+				UINT h12 = st.wHour % 12;
+				fit = _put_num(buf, bufLen, o, h12 ? h12 : 12, run);
+				break;
+			}
+			case L'H': fit = _put_num(buf, bufLen, o, st.wHour, run); break;
+			case L'm': fit = _put_num(buf, bufLen, o, st.wMinute, run); break;
+			case L's': fit = _put_num(buf, bufLen, o, st.wSecond, run); break;
+			case L't':
+				fit = _put_str(buf, bufLen, o, st.wHour < 12 ? loc.amDesig : loc.pmDesig,
+					run == 1 ? 1 : static_cast<size_t>(-1)); // single t = first char only
+				break;
+			case L'g': break; // era designator; not carried
+			default:
+				for (size_t k = 0; k < run && fit; ++k) {
+					fit = _put_char(buf, bufLen, o, c); // ordinary separator
+				}
+			}
+			if (!fit) return 0;
+			i += run;
+		}
+
+		if (o >= bufLen) return 0; // no room for terminating null
+		buf[o] = L'\0';
+		return o;
+	}
+
+	template<size_t N>
+	size_t format_to(wchar_t (&buf)[N], const wchar_t* pattern) const noexcept {
+		return this->format_to(buf, N, pattern);
+	}
+
+	// Formats with the user locale's short date and time pictures, cached at
+	// first use — no GetDateFormat/GetTimeFormat call per timestamp.
+	size_t format_to(wchar_t* buf, size_t bufLen) const noexcept {
+		const _wli::datetime_locale& loc = _wli::datetime_locale::get();
+		size_t lenDate = this->format_to(buf, bufLen, loc.datePattern);
+		if (!lenDate || lenDate + 1 >= bufLen) return 0;
+		buf[lenDate] = L' ';
+		size_t lenTime = this->format_to(buf + lenDate + 1, bufLen - lenDate - 1, loc.timePattern);
+		return lenTime ? lenDate + 1 + lenTime : 0;
+	}
+
+	template<size_t N>
+	size_t format_to(wchar_t (&buf)[N]) const noexcept {
+		return this->format_to(buf, N);
+	}
+
+private:
+	static bool _put_char(wchar_t* buf, size_t bufLen, size_t& o, wchar_t c) noexcept {
+		if (o >= bufLen) return false;
+		buf[o++] = c;
+		return true;
+	}
+
+	static bool _put_str(wchar_t* buf, size_t bufLen, size_t& o,
+		const wchar_t* s, size_t maxChars = static_cast<size_t>(-1)) noexcept
+	{
+		for (size_t i = 0; s[i] && i < maxChars; ++i) {
+			if (!_put_char(buf, bufLen, o, s[i])) return false;
+		}
+		return true;
+	}
+
+	static bool _put_num(wchar_t* buf, size_t bufLen, size_t& o, UINT val, size_t width) noexcept {
+		wchar_t digits[8];
+		size_t numDigits = 0;
+		do {
+			digits[numDigits++] = static_cast<wchar_t>(L'0' + val % 10);
+			val /= 10;
+		} while (val);
+		for (size_t i = numDigits; i < width && i < 4; ++i) {
+			digits[numDigits++] = L'0'; // zero pad up to the token length
+		}
+		while (numDigits) { // digits were produced backwards
+			if (!_put_char(buf, bufLen, o, digits[--numDigits])) return false;
+		}
+		return true;
+	}
+};
+
+}//namespace wl
@@ -89,6 +89,54 @@ public:
 		return this->_baseLoop.run_loop(this->_hWnd, hAccel); // can be used as program return value
 	}
 
+	// Registers a lambda to run whenever the message queue goes empty; returning
+	// true keeps it registered for the next gap, false unregisters it.
+	void add_idle_callback(std::function<bool()> callback) {
+		this->_baseLoop.add_idle_callback(std::move(callback));
+	}
+
+	// Queues a one-shot task to run at low priority in a message-queue gap.
+	void post_idle_task(std::function<void()> task) {
+		this->_baseLoop.post_idle_task(std::move(task));
+	}
+
+	// Registers a per-frame lambda for animations, driven by a high-resolution
+	// waitable timer inside the pump — steadier than SetTimer, paused while the
+	// window is minimized. Receives the milliseconds since the previous frame;
+	// returning true keeps it registered, false unregisters it.
+	void on_frame(std::function<bool(double)> callback) {
+		this->_baseLoop.add_frame_callback(std::move(callback));
+	}
+
+	// Sets the animation frame period; 15ms (roughly 60Hz) if never called.
+	void set_frame_period(UINT ms) noexcept {
+		this->_baseLoop.set_frame_period(ms);
+	}
+
+	// Registers global hotkeys dispatched straight into this dialog's
+	// on_command handlers: one sorted lookup in the pump, no WM_COMMAND round
+	// trip and no HACCEL rebuild when hotkeys are added later.
+	void add_accels(std::initializer_list<_wli::base_loop::accel> accels) {
+		this->_baseLoop.add_accels(nullptr, [this](WORD cmdId) -> bool {
+			return this->try_command(cmdId);
+		}, accels.begin(), accels.size());
+	}
+
+	// Registers a hotkey layer for a child window, active while it or one of
+	// its children holds the focus; it shadows the global layer on key
+	// clashes. The dispatch callback usually forwards to the child's
+	// try_command. Call remove_accels_for when the child goes away.
+	void add_accels_for(HWND hTarget, std::function<bool(WORD)> dispatch,
+		std::initializer_list<_wli::base_loop::accel> accels)
+	{
+		this->_baseLoop.add_accels(hTarget, std::move(dispatch), accels.begin(), accels.size());
+	}
+
+	// Unregisters the hotkey layers of the given child window.
+	void remove_accels_for(HWND hTarget) {
+		this->_baseLoop.remove_accels(hTarget);
+	}
+
 private:
 	void _set_icon(HINSTANCE hInst) const noexcept {
 		if (this->setup.iconId) {
@@ -6,11 +6,19 @@
  */
 
 #pragma once
+#include <atomic>
+#include <cerrno>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include "file.h"
+#include "internals/alloc_profiler.h"
+#include "internals/download_connection_cache.h"
 #include "internals/download_session.h"
 #include "internals/download_url.h"
 #include "insert_order_map.h"
 #include "str.h"
+#include <process.h>
 
 namespace wl {
 
@@ -20,14 +28,51 @@ public:
 	using session = _wli::download_session;
 	using url_crack = _wli::download_url;
 
+	// Cooperative cancellation flag: hand a copy to the download and keep one on
+	// the controlling side; request_cancel() makes the receive loop stop between
+	// chunks. Copies share the same flag, so it crosses threads freely; the cost
+	// on the download side is one relaxed load per chunk, nothing per byte.
+	class cancel_token final {
+	private:
+		std::shared_ptr<std::atomic<bool>> _flag{std::make_shared<std::atomic<bool>>(false)};
+
+	public:
+		void request_cancel() noexcept { this->_flag->store(true, std::memory_order_relaxed); }
+		bool is_cancelled() const noexcept { return this->_flag->load(std::memory_order_relaxed); }
+	};
+
 private:
 	const session& _session;
 	HINTERNET      _hConnect = nullptr, _hRequest = nullptr;
 	size_t         _contentLength = 0, _totalGot = 0;
 	std::wstring   _url, _verb, _referrer;
 	insert_order_map<std::wstring, std::wstring> _requestHeaders;
-	insert_order_map<std::wstring, std::wstring> _responseHeaders;
-	std::function<void()> _startCallback, _progressCallback;
+
+	// Response headers are kept as the raw WinHttpQueryHeaders block with an
+	// index over it: names and values are null-terminated in place during the
+	// single parse pass, so no per-header string is ever allocated unless the
+	// caller asks for the full map.
+	struct _hdr_entry final {
+		size_t hash;    // case-insensitive hash of the name
+		size_t nameOff; // offsets into _rawResponseHeaders
+		size_t valOff;
+	};
+	std::wstring            _rawResponseHeaders;
+	std::vector<_hdr_entry> _headerIndex;     // document order
+	std::vector<size_t>     _headerHashSorted; // indexes into _headerIndex, sorted by hash
+	mutable insert_order_map<std::wstring, std::wstring> _responseHeaders; // materialized on demand
+	mutable bool            _responseHeadersBuilt = false;
+	std::function<void()> _startCallback, _progressCallback, _finishCallback;
+	std::function<void(const std::exception&)>  _errorCallback;
+	std::function<void(const BYTE*, size_t)>    _sinkCallback; // receives each chunk, if set
+	file*             _sinkFile = nullptr; // chunks are appended here, if set
+	std::vector<BYTE> _chunkBuf; // bounded reassembly buffer, reused between chunks
+	bool              _reuseConnection = true;  // consult the shared connection cache?
+	bool              _connectIsShared = false; // does _hConnect belong to the cache?
+	cancel_token      _cancelToken;             // shared flag, checked once per chunk
+	bool              _hasCancelToken = false;
+	int               _timeoutConnectMs = -1, _timeoutHeadersMs = -1, _timeoutBodyMs = -1; // -1 = WinHttp defaults
+	size_t            _rangeFirst = -1, _rangeLast = -1; // byte range to request, inclusive; -1 = whole resource
 
 public:
 	std::vector<BYTE> data;
@@ -45,13 +90,43 @@ public:
 			this->_hRequest = nullptr;
 		}
 		if (this->_hConnect) {
-			WinHttpCloseHandle(this->_hConnect);
+			if (!this->_connectIsShared) { // cached handles are owned by the cache, kept warm
+				WinHttpCloseHandle(this->_hConnect);
+			}
 			this->_hConnect = nullptr;
+			this->_connectIsShared = false;
 		}
 		this->_contentLength = this->_totalGot = 0;
 		return *this;
 	}
 
+	// Enables or disables reuse of warm connections from the shared per-process
+	// cache; enabled by default.
+	download& set_connection_reuse(bool doReuse) noexcept {
+		this->_reuseConnection = doReuse;
+		return *this;
+	}
+
+	// Sets per-phase timeouts, so a stalled server releases the worker in
+	// bounded time: connect covers name resolution and the TCP/TLS handshake,
+	// headers covers sending the request and waiting for the response line, and
+	// body bounds each chunk read. Zero means infinite, -1 keeps the WinHttp
+	// default for that phase.
+	download& set_timeouts(int connectMs, int headersMs, int bodyMs) noexcept {
+		this->_timeoutConnectMs = connectMs;
+		this->_timeoutHeadersMs = headersMs;
+		this->_timeoutBodyMs = bodyMs;
+		return *this;
+	}
+
+	// Attaches a cancellation token; request_cancel() on any copy of it makes
+	// the receive loop stop between chunks and clean up.
+	download& set_cancel_token(cancel_token token) noexcept {
+		this->_cancelToken = std::move(token);
+		this->_hasCancelToken = true;
+		return *this;
+	}
+
 	download& add_request_header(const wchar_t* name, const wchar_t* value) {
 		this->_requestHeaders[name] = value;
 		return *this;
@@ -74,6 +149,64 @@ public:
 		return *this;
 	}
 
+	// Defines a lambda to be called once, after an asynchronous download completes.
+	download& on_finish(std::function<void()> callback) noexcept {
+		this->_finishCallback = std::move(callback);
+		return *this;
+	}
+
+	// Defines a lambda to be called if an asynchronous download fails.
+	download& on_error(std::function<void(const std::exception&)> callback) noexcept {
+		this->_errorCallback = std::move(callback);
+		return *this;
+	}
+
+	// Streams each received chunk into the lambda instead of accumulating into
+	// the data member; only a bounded per-chunk buffer is ever held in memory.
+	download& set_sink(std::function<void(const BYTE* pChunk, size_t chunkSize)> sinkCallback) noexcept {
+		this->_sinkCallback = std::move(sinkCallback);
+		return *this;
+	}
+
+	// Appends each received chunk to the given open file instead of accumulating
+	// into the data member; only a bounded per-chunk buffer is ever held in memory.
+	download& set_sink(file& sinkFile) noexcept {
+		this->_sinkFile = &sinkFile;
+		return *this;
+	}
+
+	// Requests only the given byte range, inclusive; lastByte -1 means up to the
+	// end of the resource. The server must support Range requests.
+	download& set_range(size_t firstByte, size_t lastByte = -1) noexcept {
+		this->_rangeFirst = firstByte;
+		this->_rangeLast = lastByte;
+		return *this;
+	}
+
+	// Resumes a partial download into the given file: whatever tail is missing,
+	// according to the current file size, is range-requested and appended.
+	// Returns only after it completes, like start().
+	download& resume_to_file(const std::wstring& destFilePath) {
+		file fout;
+		fout.open_or_create(destFilePath);
+
+		size_t alreadyGot = fout.size();
+		if (alreadyGot) {
+			this->set_range(alreadyGot); // ask only for the missing tail
+			fout.seek_to(alreadyGot);
+		}
+		this->set_sink(fout);
+
+		try {
+			this->start();
+		} catch (...) {
+			this->_clear_resume_state(); // fout dies now, even on failure
+			throw;
+		}
+		this->_clear_resume_state();
+		return *this;
+	}
+
 	// Effectively starts the download, returning only after it completes.
 	download& start() {
 		if (this->_hConnect) {
@@ -86,15 +219,19 @@ public:
 		this->_init_handles();
 		this->_contact_server();
 		this->_parse_headers();
+		this->_apply_timeouts(this->_timeoutBodyMs); // body chunks get their own receive bound
 		this->data.clear(); // prepare buffer to receive data
-		if (this->_contentLength) { // server informed content length?
-			this->data.reserve(this->_contentLength);
+		if (this->_contentLength && !this->_has_sink()) { // server informed content length?
+			this->data.reserve(this->_contentLength); // with a sink, nothing is accumulated here
 		}
 
 		if (this->_startCallback) this->_startCallback(); // run user callback
 
 		if (this->_hConnect && this->_hRequest) { // user didn't call abort()
 			for (;;) {
+				if (this->_hasCancelToken && this->_cancelToken.is_cancelled()) {
+					break; // one relaxed load per chunk; the byte loop below is untouched
+				}
 				DWORD incomingBytes = this->_get_incoming_byte_count(); // chunk size about to come
 				if (!incomingBytes) break; // no more bytes remaining
 				this->_receive_bytes(incomingBytes); // chunk will be appended into this->data
@@ -106,8 +243,165 @@ public:
 		return this->abort(); // cleanup
 	}
 
+	// Starts the download in a background thread, returning immediately. Chunks
+	// go to the sink, if any; on_progress, on_finish and on_error run in the
+	// worker thread, so UI updates from them must be marshaled with
+	// post_thread_ui/run_thread_ui. This object must outlive the download.
+	download& start_async() {
+		if (this->_hConnect) {
+			throw std::logic_error("A download is already in progress.");
+		}
+
+		uintptr_t hThread = _beginthreadex(nullptr, 0, [](void* ptr) noexcept -> unsigned int {
+			download* pSelf = reinterpret_cast<download*>(ptr);
+			try {
+				pSelf->start();
+				if (pSelf->_finishCallback) pSelf->_finishCallback();
+			} catch (const std::exception& e) {
+				if (pSelf->_errorCallback) pSelf->_errorCallback(e);
+			}
+			return 0;
+		}, this, 0, nullptr);
+
+		if (!hThread) { // otherwise the download silently never runs and no callback ever fires
+			throw std::system_error(errno, std::generic_category(),
+				"_beginthreadex failed in start_async");
+		}
+		CloseHandle(reinterpret_cast<HANDLE>(hThread));
+		return *this;
+	}
+
+	// Downloads the URL into the destination file with numSegments parallel
+	// ranged requests, each writing its slice at the right offset of the
+	// preallocated file. The server must support Range requests and inform the
+	// content length. The progress callback, if any, is invoked serialized from
+	// the workers as (totalGot, contentLength).
+	static void download_parallel(const session& sess, const std::wstring& url,
+		const std::wstring& destFilePath, size_t numSegments = 4,
+		std::function<void(size_t totalGot, size_t contentLength)> progressCallback = nullptr)
+	{
+		if (!numSegments) {
+			throw std::invalid_argument("Zero download segments requested.");
+		}
+		if (numSegments > MAXIMUM_WAIT_OBJECTS) numSegments = MAXIMUM_WAIT_OBJECTS;
+
+		// Probe the content length without downloading the body.
+		download probe{sess, url, L"HEAD"};
+		probe.start();
+		size_t contentLength = probe.get_content_length();
+		if (!contentLength) {
+			throw std::runtime_error("Server didn't inform content length; can't split segments.");
+		}
+		if (numSegments > contentLength) numSegments = contentLength; // tiny file
+
+		file fout;
+		fout.open_or_create(destFilePath);
+		fout.set_new_size(contentLength); // preallocate, workers write at offsets
+
+		struct _segment_pack final {
+			const session*     pSess;
+			const std::wstring* pUrl;
+			file*              pFout;
+			std::mutex*        pFoutMtx;
+			size_t             firstByte, lastByte; // inclusive
+			std::atomic<size_t>* pTotalGot;
+			size_t             contentLength;
+			std::function<void(size_t, size_t)>* pProgress;
+			std::exception_ptr thrownExcept;
+		};
+
+		std::mutex foutMtx;
+		std::atomic<size_t> totalGot{0};
+		std::vector<_segment_pack> segments(numSegments);
+		std::vector<HANDLE> workers(numSegments, nullptr);
+
+		size_t segmentSize = contentLength / numSegments;
+		for (size_t i = 0; i < numSegments; ++i) {
+			size_t firstByte = i * segmentSize;
+			size_t lastByte = (i == numSegments - 1) ?
+				contentLength - 1 : firstByte + segmentSize - 1; // last segment takes the remainder
+
+			segments[i] = {&sess, &url, &fout, &foutMtx, firstByte, lastByte,
+				&totalGot, contentLength, &progressCallback, nullptr};
+
+			workers[i] = reinterpret_cast<HANDLE>(
+				_beginthreadex(nullptr, 0, [](void* ptr) noexcept -> unsigned int {
+					_segment_pack* pSeg = reinterpret_cast<_segment_pack*>(ptr);
+					try {
+						size_t writeOffset = pSeg->firstByte; // running offset of this slice
+
+						download dl{*pSeg->pSess, *pSeg->pUrl};
+						dl.set_range(pSeg->firstByte, pSeg->lastByte);
+						dl.set_sink([pSeg, &writeOffset](const BYTE* pChunk, size_t chunkSize) -> void {
+							std::lock_guard<std::mutex> lock(*pSeg->pFoutMtx); // one writer at a time
+							pSeg->pFout->seek_to(writeOffset);
+							pSeg->pFout->write(pChunk, chunkSize);
+							writeOffset += chunkSize;
+
+							size_t gotSoFar = (*pSeg->pTotalGot += chunkSize);
+							if (*pSeg->pProgress) (*pSeg->pProgress)(gotSoFar, pSeg->contentLength);
+						});
+						dl.start();
+					} catch (...) {
+						pSeg->thrownExcept = std::current_exception();
+					}
+					return 0;
+				}, &segments[i], 0, nullptr));
+
+			if (!workers[i]) { // a null handle would make WaitForMultipleObjects fail below
+				if (i) { // the spawned workers reference the locals, let them finish first
+					WaitForMultipleObjects(static_cast<DWORD>(i), &workers[0], TRUE, INFINITE);
+					for (size_t k = 0; k < i; ++k) CloseHandle(workers[k]);
+				}
+				throw std::system_error(errno, std::generic_category(),
+					"_beginthreadex failed in download_parallel");
+			}
+		}
+
+		WaitForMultipleObjects(static_cast<DWORD>(numSegments), &workers[0], TRUE, INFINITE);
+		for (HANDLE hWorker : workers) CloseHandle(hWorker);
+		for (_segment_pack& seg : segments) {
+			if (seg.thrownExcept) std::rethrow_exception(seg.thrownExcept); // 1st failure wins
+		}
+	}
+
 	const insert_order_map<std::wstring, std::wstring>& get_request_headers() const noexcept  { return this->_requestHeaders; }
-	const insert_order_map<std::wstring, std::wstring>& get_response_headers() const noexcept { return this->_responseHeaders; }
+
+	// Case-insensitive response header lookup over the hash index: one hash,
+	// one binary search, no allocation. Returns the value sliced out of the
+	// retained raw block, or nullptr if the header is absent; the pointer stays
+	// valid until the next start().
+	const wchar_t* header(const wchar_t* name) const noexcept {
+		size_t h = _hash_header_name(name);
+		auto matched = std::lower_bound(
+			this->_headerHashSorted.begin(), this->_headerHashSorted.end(), h,
+			[this](size_t idx, size_t hash) noexcept -> bool {
+				return this->_headerIndex[idx].hash < hash;
+			});
+		for (; matched != this->_headerHashSorted.end() &&
+			this->_headerIndex[*matched].hash == h; ++matched) // walk the collision run
+		{
+			const _hdr_entry& entry = this->_headerIndex[*matched];
+			if (!lstrcmpiW(name, &this->_rawResponseHeaders[entry.nameOff])) {
+				return &this->_rawResponseHeaders[entry.valOff];
+			}
+		}
+		return nullptr;
+	}
+
+	// Returns all response headers as a map; built from the index on first call,
+	// so callers reading only a few named headers never pay for it.
+	const insert_order_map<std::wstring, std::wstring>& get_response_headers() const {
+		if (!this->_responseHeadersBuilt) {
+			this->_responseHeaders.clear();
+			for (const _hdr_entry& entry : this->_headerIndex) {
+				this->_responseHeaders[&this->_rawResponseHeaders[entry.nameOff]] =
+					&this->_rawResponseHeaders[entry.valOff];
+			}
+			this->_responseHeadersBuilt = true;
+		}
+		return this->_responseHeaders;
+	}
 	size_t get_content_length() const noexcept   { return this->_contentLength; }
 	size_t get_total_downloaded() const noexcept { return this->_totalGot; }
 
@@ -128,8 +422,14 @@ private:
 		url_crack crackedUrl;
 		crackedUrl.crack(_url);
 
-		// Open the connection handle.
-		this->_hConnect = WinHttpConnect(this->_session.hsession(), crackedUrl.host(), crackedUrl.port(), 0);
+		// Open the connection handle, preferring a warm one from the shared cache.
+		if (this->_reuseConnection) {
+			this->_hConnect = _wli::download_connection_cache::instance().get_or_open(
+				this->_session.hsession(), crackedUrl.host(), crackedUrl.port());
+			this->_connectIsShared = this->_hConnect != nullptr;
+		} else {
+			this->_hConnect = WinHttpConnect(this->_session.hsession(), crackedUrl.host(), crackedUrl.port(), 0);
+		}
 		if (!this->_hConnect) {
 			this->_abort_and_throw(GetLastError(), "WinHttpConnect failed");
 		}
@@ -144,6 +444,22 @@ private:
 		if (!this->_hRequest) {
 			this->_abort_and_throw(GetLastError(), "WinHttpOpenRequest failed");
 		}
+
+		this->_apply_timeouts(this->_timeoutHeadersMs); // headers govern receive until the body starts
+	}
+
+	// Applies the configured timeouts to the request handle; phases left at -1
+	// keep the WinHttp defaults (60s connect, 30s send/receive).
+	void _apply_timeouts(int receiveMs) noexcept {
+		if (this->_timeoutConnectMs == -1 && this->_timeoutHeadersMs == -1 &&
+			this->_timeoutBodyMs == -1)
+		{
+			return; // untouched, keep WinHttp behavior exactly as before
+		}
+		int connectMs = this->_timeoutConnectMs != -1 ? this->_timeoutConnectMs : 60000;
+		int sendMs = this->_timeoutHeadersMs != -1 ? this->_timeoutHeadersMs : 30000;
+		if (receiveMs == -1) receiveMs = 30000;
+		WinHttpSetTimeouts(this->_hRequest, connectMs, connectMs, sendMs, receiveMs);
 	}
 
 	void _contact_server() {
@@ -160,6 +476,18 @@ private:
 			}
 		}
 
+		// Add the Range header, if a byte range was requested.
+		if (this->_rangeFirst != -1) {
+			std::wstring rangeHeader = L"Range: bytes=";
+			rangeHeader += std::to_wstring(this->_rangeFirst);
+			rangeHeader += L'-';
+			if (this->_rangeLast != -1) rangeHeader += std::to_wstring(this->_rangeLast);
+
+			if (!WinHttpAddRequestHeaders(this->_hRequest, rangeHeader.c_str(), static_cast<ULONG>(-1L), WINHTTP_ADDREQ_FLAG_ADD)) {
+				this->_abort_and_throw(GetLastError(), "WinHttpAddRequestHeaders failed on Range header");
+			}
+		}
+
 		// Send the request to server.
 		if (!WinHttpSendRequest(this->_hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0, WINHTTP_NO_REQUEST_DATA, 0, 0, 0)) {
 			this->_abort_and_throw(GetLastError(), "WinHttpSendRequest failed");
@@ -169,44 +497,113 @@ private:
 		if (!WinHttpReceiveResponse(this->_hRequest, nullptr)) {
 			this->_abort_and_throw(GetLastError(), "WinHttpReceiveResponse failed");
 		}
+
+		// A server that ignores the Range header answers 200 with the whole
+		// body; treating that as the requested slice would corrupt whatever
+		// the caller appends it to, so only 206 Partial Content is accepted.
+		if (this->_rangeFirst != -1 && this->_query_status_code() != 206) {
+			throw std::runtime_error("Server ignored the Range request and sent the full body.");
+		}
+	}
+
+	DWORD _query_status_code() const noexcept {
+		DWORD status = 0, statusSize = sizeof(status);
+		WinHttpQueryHeaders(this->_hRequest,
+			WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
+			WINHTTP_HEADER_NAME_BY_INDEX, &status, &statusSize, WINHTTP_NO_HEADER_INDEX);
+		return status;
+	}
+
+	// resume_to_file wires a stack-local file and a byte range into the object;
+	// both must be unwired whether start() returns or throws, or the next plain
+	// start() would write through a dangling pointer and re-send the old range.
+	void _clear_resume_state() noexcept {
+		this->_sinkFile = nullptr;
+		this->_rangeFirst = this->_rangeLast = -1;
+	}
+
+	// Case-insensitive FNV-1a over the header name; lookup and index share it.
+	static size_t _hash_header_name(const wchar_t* name) noexcept {
+		size_t h = 14695981039346656037ULL;
+		for (; *name; ++name) {
+			h = (h ^ static_cast<size_t>(towlower(*name))) * 1099511628211ULL;
+		}
+		return h;
 	}
 
 	void _parse_headers() {
-		// Retrieve the response header.
+		// Retrieve the raw response header block, which is retained as-is.
 		DWORD rehSize = 0;
 		WinHttpQueryHeaders(this->_hRequest, WINHTTP_QUERY_RAW_HEADERS_CRLF,
 			WINHTTP_HEADER_NAME_BY_INDEX, WINHTTP_NO_OUTPUT_BUFFER, &rehSize, WINHTTP_NO_HEADER_INDEX);
 
-		std::wstring rawReh(rehSize / sizeof(wchar_t), L'\0'); // raw response headers
+		this->_rawResponseHeaders.assign(rehSize / sizeof(wchar_t), L'\0');
 
 		if (!WinHttpQueryHeaders(this->_hRequest, WINHTTP_QUERY_RAW_HEADERS_CRLF,
-			WINHTTP_HEADER_NAME_BY_INDEX, &rawReh[0], &rehSize, WINHTTP_NO_HEADER_INDEX))
+			WINHTTP_HEADER_NAME_BY_INDEX, &this->_rawResponseHeaders[0], &rehSize, WINHTTP_NO_HEADER_INDEX))
 		{
 			this->_abort_and_throw(GetLastError(), "WinHttpQueryHeaders failed");
 		}
 
-		// Parse the raw response headers into an associative array.
-		this->_responseHeaders.clear();
-		std::vector<std::wstring> lines = str::split_lines(rawReh);
-
-		for (const std::wstring& line : lines) {
-			if (line.empty()) {
-				continue;
+		// One pass over the block: each line is sliced in place — the colon and
+		// the CR are overwritten with nulls, so names and values become plain
+		// null-terminated strings inside the retained buffer, no copies made.
+		this->_headerIndex.clear();
+		this->_headerHashSorted.clear();
+		this->_responseHeadersBuilt = false;
+
+		std::wstring& raw = this->_rawResponseHeaders;
+		size_t blockLen = raw.length();
+		size_t i = 0;
+		while (i < blockLen && raw[i]) {
+			size_t lineEnd = i;
+			while (lineEnd < blockLen && raw[lineEnd] != L'\r' && raw[lineEnd] != L'\n' && raw[lineEnd]) {
+				++lineEnd;
+			}
+			size_t nextLine = lineEnd;
+			while (nextLine < blockLen && (raw[nextLine] == L'\r' || raw[nextLine] == L'\n')) {
+				raw[nextLine++] = L'\0'; // terminate the value in place
 			}
-			size_t colonIdx = line.find_first_of(L':');
-			if (colonIdx == std::wstring::npos) { // not a key/value pair, probably response line
-				this->_responseHeaders[L""] = line; // empty key
-			} else {
-				std::wstring kk = line.substr(0, colonIdx);
-				std::wstring vv = line.substr(colonIdx + 1, line.length() - (colonIdx + 1));
-				this->_responseHeaders[str::trim(kk)] = str::trim(vv);
+
+			if (lineEnd > i) { // skip blank lines
+				size_t colonIdx = i;
+				while (colonIdx < lineEnd && raw[colonIdx] != L':') ++colonIdx;
+
+				size_t nameOff = i, valOff = 0;
+				if (colonIdx == lineEnd) { // no colon, probably the status line
+					valOff = i;
+					nameOff = lineEnd; // points at a null: empty name
+				} else {
+					size_t nameEnd = colonIdx;
+					while (nameEnd > i && iswspace(raw[nameEnd - 1])) --nameEnd;
+					raw[nameEnd] = L'\0'; // covers the colon or trailing space
+					if (nameEnd == colonIdx) raw[colonIdx] = L'\0';
+
+					valOff = colonIdx + 1;
+					while (valOff < lineEnd && iswspace(raw[valOff])) ++valOff;
+					size_t valEnd = lineEnd;
+					while (valEnd > valOff && iswspace(raw[valEnd - 1])) --valEnd;
+					raw[valEnd] = L'\0';
+				}
+				this->_headerIndex.push_back(
+					{_hash_header_name(&raw[nameOff]), nameOff, valOff});
 			}
+			i = nextLine;
+		}
+
+		this->_headerHashSorted.resize(this->_headerIndex.size());
+		for (size_t k = 0; k < this->_headerIndex.size(); ++k) {
+			this->_headerHashSorted[k] = k;
 		}
+		std::sort(this->_headerHashSorted.begin(), this->_headerHashSorted.end(),
+			[this](size_t a, size_t b) noexcept -> bool {
+				return this->_headerIndex[a].hash < this->_headerIndex[b].hash;
+			});
 
 		// Retrieve content length, if informed by server.
-		const std::wstring* contLen = this->_responseHeaders.get_if_exists(L"Content-Length");
-		if (contLen && str::is_uint(*contLen)) { // yes, server informed content length
-			this->_contentLength = std::stoul(*contLen);
+		const wchar_t* contLen = this->header(L"Content-Length");
+		if (contLen && str::is_uint(contLen)) { // yes, server informed content length
+			this->_contentLength = std::stoul(contLen);
 		}
 	}
 
@@ -218,15 +615,43 @@ private:
 		return count;
 	}
 
+	bool _has_sink() const noexcept {
+		return this->_sinkFile != nullptr || static_cast<bool>(this->_sinkCallback);
+	}
+
 	void _receive_bytes(UINT nBytesToRead) {
 		DWORD readCount = 0; // not used
-		this->data.resize(this->data.size() + nBytesToRead); // make room
 
-		if (!WinHttpReadData(this->_hRequest,
-			static_cast<void*>(&this->data[this->data.size() - nBytesToRead]), // append to buffer
-			nBytesToRead, &readCount) )
-		{
-			this->_abort_and_throw(GetLastError(), "WinHttpReadData failed");
+		if (this->_has_sink()) { // stream through the reusable chunk buffer, nothing accumulates
+			if (nBytesToRead > this->_chunkBuf.capacity()) {
+				WINLAMB_COUNT_ALLOC(DOWNLOAD, nBytesToRead); // a warm buffer reallocates nothing
+			}
+			this->_chunkBuf.resize(nBytesToRead); // capacity is kept between chunks
+
+			if (!WinHttpReadData(this->_hRequest,
+				static_cast<void*>(&this->_chunkBuf[0]), nBytesToRead, &readCount))
+			{
+				this->_abort_and_throw(GetLastError(), "WinHttpReadData failed");
+			}
+
+			if (this->_sinkFile) {
+				this->_sinkFile->write(&this->_chunkBuf[0], nBytesToRead);
+			}
+			if (this->_sinkCallback) {
+				this->_sinkCallback(&this->_chunkBuf[0], nBytesToRead);
+			}
+		} else {
+			if (this->data.size() + nBytesToRead > this->data.capacity()) {
+				WINLAMB_COUNT_ALLOC(DOWNLOAD, this->data.size() + nBytesToRead); // content-length reserve absorbs these
+			}
+			this->data.resize(this->data.size() + nBytesToRead); // make room
+
+			if (!WinHttpReadData(this->_hRequest,
+				static_cast<void*>(&this->data[this->data.size() - nBytesToRead]), // append to buffer
+				nBytesToRead, &readCount) )
+			{
+				this->_abort_and_throw(GetLastError(), "WinHttpReadData failed");
+			}
 		}
 
 		this->_totalGot += nBytesToRead; // update total downloaded count
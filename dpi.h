@@ -0,0 +1,93 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <Windows.h>
+
+#ifndef WM_DPICHANGED
+#define WM_DPICHANGED 0x02E0 // absent from pre-8.1 SDK headers
+#endif
+
+namespace wl {
+namespace _wli {
+
+// DPI of the monitor hosting the window. GetDpiForWindow exists only from
+// Win10 1607 on, so it's resolved dynamically once; before that the system
+// DPI is the best available answer.
+inline UINT dpi_of_window(HWND hWnd) noexcept {
+	using get_dpi_for_window_t = UINT (WINAPI*)(HWND);
+	static get_dpi_for_window_t pGetDpiForWindow =
+		reinterpret_cast<get_dpi_for_window_t>(
+			GetProcAddress(GetModuleHandleW(L"user32.dll"), "GetDpiForWindow"));
+
+	if (pGetDpiForWindow) {
+		return pGetDpiForWindow(hWnd);
+	}
+	HDC hdc = GetDC(nullptr);
+	UINT dpiVal = hdc ? GetDeviceCaps(hdc, LOGPIXELSX) : 96;
+	if (hdc) ReleaseDC(nullptr, hdc);
+	return dpiVal;
+}
+
+}//namespace _wli
+
+// Caches the DPI scale of one window. The value is queried once at attach()
+// and refreshed only by on_dpi_changed(), so layout and font code reads a
+// plain integer instead of re-querying metrics on every arrangement.
+class dpi_context final {
+private:
+	UINT _dpi = BASE;
+
+public:
+	// Design-time DPI every scale is relative to; coordinates in resource
+	// scripts and LOGFONT descriptions are authored at this density.
+	static const UINT BASE = 96;
+
+	UINT dpi() const noexcept { return this->_dpi; }
+
+	// Queries the monitor DPI of the window; call right after creation.
+	dpi_context& attach(HWND hWnd) noexcept {
+		this->_dpi = _wli::dpi_of_window(hWnd);
+		return *this;
+	}
+
+	// Refreshes the cache from WM_DPICHANGED's wParam — the only moment the
+	// monitor scale can change, so everything between two of these messages
+	// is served from the cached value.
+	dpi_context& on_dpi_changed(WPARAM wp) noexcept {
+		this->_dpi = HIWORD(wp);
+		return *this;
+	}
+
+	// Scales a 96-dpi design-time value to the cached monitor DPI.
+	int scale(int v) const noexcept {
+		return MulDiv(v, static_cast<int>(this->_dpi), static_cast<int>(BASE));
+	}
+
+	SIZE scale(SIZE sz) const noexcept {
+		return {this->scale(static_cast<int>(sz.cx)), this->scale(static_cast<int>(sz.cy))};
+	}
+
+	POINT scale(POINT pt) const noexcept {
+		return {this->scale(static_cast<int>(pt.x)), this->scale(static_cast<int>(pt.y))};
+	}
+
+	RECT scale(RECT rc) const noexcept {
+		return {this->scale(static_cast<int>(rc.left)), this->scale(static_cast<int>(rc.top)),
+			this->scale(static_cast<int>(rc.right)), this->scale(static_cast<int>(rc.bottom))};
+	}
+
+	// Scales a 96-dpi LOGFONT description. Pairs with font::create(), which
+	// dedups through the process-wide font cache, so each distinct
+	// (description, DPI) is materialized by CreateFontIndirect only once.
+	LOGFONT scale(LOGFONT lf) const noexcept {
+		lf.lfHeight = this->scale(static_cast<int>(lf.lfHeight));
+		return lf;
+	}
+};
+
+}//namespace wl
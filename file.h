@@ -6,9 +6,12 @@
  */
 
 #pragma once
+#include <algorithm>
+#include <functional>
 #include <string>
 #include <system_error>
 #include <vector>
+#include "big_buffer.h"
 #include "datetime.h"
 #include <Shellapi.h>
 
@@ -20,6 +23,77 @@ public:
 	// File access type.
 	enum class access { READONLY, READWRITE };
 
+	// One in-flight overlapped operation, issued by read_async/write_async.
+	// Not movable: the kernel holds the address of the OVERLAPPED until completion.
+	class async_op final {
+		friend class file;
+
+	private:
+		OVERLAPPED                  _ov{};
+		HANDLE                      _hFile = nullptr;
+		std::function<void(size_t)> _completionCallback; // receives bytes transferred
+		bool                        _pending = false;
+
+	public:
+		~async_op() {
+			if (this->_pending) {
+				DWORD transferred = 0; // drain, the kernel still owns our OVERLAPPED
+				GetOverlappedResult(this->_hFile, &this->_ov, &transferred, TRUE);
+			}
+			if (this->_ov.hEvent) CloseHandle(this->_ov.hEvent);
+		}
+
+		async_op() = default;
+		async_op(const async_op&) = delete;
+		async_op& operator=(const async_op&) = delete; // non-copyable, non-movable
+
+		bool is_pending() const noexcept {
+			return this->_pending;
+		}
+
+		// Waitable event handle, signaled when the operation completes.
+		HANDLE hevent() const noexcept {
+			return this->_ov.hEvent;
+		}
+
+		// Blocks until the operation finishes; runs the completion lambda once,
+		// and returns the number of bytes transferred.
+		size_t wait() {
+			return this->_finish(TRUE);
+		}
+
+		// Returns true if the operation has finished, without blocking; upon
+		// completion, runs the completion lambda once.
+		bool poll() {
+			if (!this->_pending) return true;
+			DWORD transferred = 0;
+			if (!GetOverlappedResult(this->_hFile, &this->_ov, &transferred, FALSE)) {
+				if (GetLastError() == ERROR_IO_INCOMPLETE) return false; // still running
+				throw std::system_error(GetLastError(), std::system_category(),
+					"GetOverlappedResult failed");
+			}
+			this->_complete(transferred);
+			return true;
+		}
+
+	private:
+		size_t _finish(BOOL doWait) {
+			if (!this->_pending) return 0;
+			DWORD transferred = 0;
+			if (!GetOverlappedResult(this->_hFile, &this->_ov, &transferred, doWait)) {
+				throw std::system_error(GetLastError(), std::system_category(),
+					"GetOverlappedResult failed");
+			}
+			this->_complete(transferred);
+			return transferred;
+		}
+
+		void _complete(DWORD transferred) {
+			this->_pending = false;
+			if (this->_completionCallback) this->_completionCallback(transferred);
+		}
+	};
+
 	// Date information of a file.
 	struct dates final {
 		datetime creation;
@@ -31,6 +105,7 @@ private:
 	HANDLE _hFile = nullptr;
 	access _access = access::READONLY;
 	size_t _sz = -1;
+	bool   _isOverlapped = false;
 
 public:
 	~file() {
@@ -45,6 +120,7 @@ public:
 		std::swap(this->_hFile, other._hFile);
 		std::swap(this->_access, other._access);
 		std::swap(this->_sz, other._sz);
+		std::swap(this->_isOverlapped, other._isOverlapped);
 		return *this;
 	}
 
@@ -65,6 +141,7 @@ public:
 			this->_hFile = nullptr;
 			this->_access = access::READONLY;
 			this->_sz = -1; // http://stackoverflow.com/a/19483690
+			this->_isOverlapped = false;
 		}
 		return *this;
 	}
@@ -79,7 +156,7 @@ public:
 
 private:
 	file& _raw_open(const std::wstring& filePath, DWORD desiredAccess,
-		DWORD shareMode, DWORD creationDisposition)
+		DWORD shareMode, DWORD creationDisposition, DWORD flagsAndAttrs = 0)
 	{
 		if (filePath.empty()) {
 			throw std::invalid_argument("No file path specified.");
@@ -89,7 +166,7 @@ private:
 		bool isReadWrite = (desiredAccess & GENERIC_WRITE) != 0;
 
 		this->_hFile = CreateFileW(filePath.c_str(), desiredAccess, shareMode,
-			nullptr, creationDisposition, 0, nullptr);
+			nullptr, creationDisposition, flagsAndAttrs, nullptr);
 		if (this->_hFile == INVALID_HANDLE_VALUE) {
 			this->_hFile = nullptr;
 			throw std::system_error(GetLastError(), std::system_category(),
@@ -100,6 +177,7 @@ private:
 
 		this->_access = isReadWrite ?
 			access::READWRITE : access::READONLY; // keep for future checks
+		this->_isOverlapped = (flagsAndAttrs & FILE_FLAG_OVERLAPPED) != 0;
 		return *this;
 	}
 
@@ -120,6 +198,24 @@ public:
 		return this->open_existing(filePath.c_str(), accessType);
 	}
 
+	// Opens an existing file for overlapped (asynchronous) I/O; operations are
+	// then issued with read_async/write_async instead of read/write.
+	file& open_existing_overlapped(const wchar_t* filePath, access accessType) {
+		if (!util::exists(filePath)) {
+			throw std::invalid_argument("File doesn't exist.");
+		}
+		return this->_raw_open(filePath,
+			GENERIC_READ | (accessType == access::READWRITE ? GENERIC_WRITE : 0),
+			(accessType == access::READWRITE) ? 0 : FILE_SHARE_READ,
+			OPEN_EXISTING, FILE_FLAG_OVERLAPPED);
+	}
+
+	// Opens an existing file for overlapped (asynchronous) I/O; operations are
+	// then issued with read_async/write_async instead of read/write.
+	file& open_existing_overlapped(const std::wstring& filePath, access accessType) {
+		return this->open_existing_overlapped(filePath.c_str(), accessType);
+	}
+
 	// Opens a file as read/write, creates if it doesn't exist.
 	file& open_or_create(const wchar_t* filePath) {
 		return this->_raw_open(filePath, GENERIC_READ | GENERIC_WRITE, 0, OPEN_ALWAYS);
@@ -183,6 +279,18 @@ public:
 		return *this;
 	}
 
+	// Calls SetFilePointer to set internal pointer to the given offset from begin of the file.
+	file& seek_to(size_t offset) {
+		this->_check_file_opened();
+		LARGE_INTEGER li{};
+		li.QuadPart = static_cast<LONGLONG>(offset);
+		if (!SetFilePointerEx(this->_hFile, li, nullptr, FILE_BEGIN)) {
+			throw std::system_error(GetLastError(), std::system_category(),
+				"SetFilePointerEx failed to seek the file");
+		}
+		return *this;
+	}
+
 	// Reads all file content at once into a buffer.
 	file& read_to_buffer(std::vector<BYTE>& buf) {
 		this->_check_file_opened();
@@ -195,6 +303,31 @@ public:
 		return *this;
 	}
 
+	// Reads all file content at once into a big_buffer — VirtualAlloc-backed
+	// pages, large where the lock-memory privilege allows — intended for
+	// gigabyte-class files that are scanned afterwards. Reads loop in slices,
+	// so files past the 4GB ReadFile limit come through whole; pass a NUMA
+	// node to keep the pages local to the thread that will scan them.
+	file& read_to_buffer(big_buffer& buf, int numaNode = -1) {
+		this->_check_file_opened();
+		buf.alloc(this->size(), numaNode);
+
+		size_t offset = 0;
+		while (offset < buf.size()) {
+			DWORD toRead = static_cast<DWORD>(
+				(std::min)(buf.size() - offset, static_cast<size_t>(1) << 30)); // 1GB slices
+			DWORD bytesRead = 0;
+			if (!ReadFile(this->_hFile, buf.data() + offset, toRead, &bytesRead, nullptr) ||
+				!bytesRead)
+			{
+				throw std::system_error(GetLastError(), std::system_category(),
+					"ReadFile failed");
+			}
+			offset += bytesRead;
+		}
+		return *this;
+	}
+
 	// Retrieves all file content at once.
 	std::vector<BYTE> read() {
 		std::vector<BYTE> buf;
@@ -202,6 +335,68 @@ public:
 		return buf;
 	}
 
+	// Streams the file in fixed-size chunks to the callback, which receives the
+	// chunk data, its length and its offset; peak memory stays at two chunks no
+	// matter the file size. On files opened with open_existing_overlapped, the
+	// next chunk is read ahead while the callback processes the current one, so
+	// I/O and compute overlap. Return false from the callback to stop early.
+	file& read_chunks(size_t chunkSize,
+		std::function<bool(const BYTE* pData, size_t sz, size_t offset)> callback)
+	{
+		this->_check_file_opened();
+		if (!chunkSize) {
+			throw std::invalid_argument("Chunk size can't be zero.");
+		}
+
+		size_t totalSz = this->size();
+		if (!totalSz) return *this;
+
+		if (!this->_isOverlapped) { // plain synchronous loop, single buffer
+			this->rewind();
+			std::vector<BYTE> buf((std::min)(chunkSize, totalSz));
+			size_t offset = 0;
+			while (offset < totalSz) {
+				DWORD toRead = static_cast<DWORD>((std::min)(chunkSize, totalSz - offset));
+				DWORD bytesRead = 0;
+				if (!ReadFile(this->_hFile, &buf[0], toRead, &bytesRead, nullptr)) {
+					throw std::system_error(GetLastError(), std::system_category(),
+						"ReadFile failed while reading chunk");
+				}
+				if (!bytesRead || !callback(&buf[0], bytesRead, offset)) break;
+				offset += bytesRead;
+			}
+			return *this;
+		}
+
+		// Double-buffered read-ahead over overlapped I/O.
+		std::vector<BYTE> bufs[2];
+		bufs[0].resize((std::min)(chunkSize, totalSz));
+		bufs[1].resize((std::min)(chunkSize, totalSz));
+		async_op ops[2];
+
+		size_t cur = 0, offset = 0;
+		this->read_async(ops[cur], &bufs[cur][0],
+			(std::min)(chunkSize, totalSz), 0);
+
+		while (offset < totalSz) {
+			size_t bytesRead = ops[cur].wait(); // current chunk lands
+			if (!bytesRead) break;
+
+			size_t nextOffset = offset + bytesRead;
+			if (nextOffset < totalSz) { // kick off the read-ahead before processing
+				this->read_async(ops[1 - cur], &bufs[1 - cur][0],
+					(std::min)(chunkSize, totalSz - nextOffset), nextOffset);
+			}
+
+			if (!callback(&bufs[cur][0], bytesRead, offset)) {
+				break; // a pending read-ahead is drained by the async_op destructor
+			}
+			offset = nextOffset;
+			cur = 1 - cur;
+		}
+		return *this;
+	}
+
 	// Writes content to file, wrapper to WriteFile.
 	file& write(const BYTE* pData, size_t sz) {
 		this->_check_file_opened();
@@ -222,6 +417,64 @@ public:
 		return this->write(&data[0], data.size());
 	}
 
+	// Starts an asynchronous read at the given offset; the file must have been
+	// opened with open_existing_overlapped, the buffer and the async_op must
+	// outlive the operation. The completion lambda, if any, runs inside
+	// async_op::wait or async_op::poll with the number of bytes transferred.
+	file& read_async(async_op& op, BYTE* pBuf, size_t numBytes, size_t offset,
+		std::function<void(size_t bytesTransferred)> onComplete = nullptr)
+	{
+		this->_prepare_async_op(op, offset, std::move(onComplete));
+		if (!ReadFile(this->_hFile, pBuf, static_cast<DWORD>(numBytes), nullptr, &op._ov) &&
+			GetLastError() != ERROR_IO_PENDING)
+		{
+			throw std::system_error(GetLastError(), std::system_category(),
+				"ReadFile failed to start overlapped read");
+		}
+		op._pending = true;
+		return *this;
+	}
+
+	// Starts an asynchronous write at the given offset; same rules as read_async.
+	file& write_async(async_op& op, const BYTE* pData, size_t numBytes, size_t offset,
+		std::function<void(size_t bytesTransferred)> onComplete = nullptr)
+	{
+		this->_check_file_read_only();
+		this->_prepare_async_op(op, offset, std::move(onComplete));
+		if (!WriteFile(this->_hFile, pData, static_cast<DWORD>(numBytes), nullptr, &op._ov) &&
+			GetLastError() != ERROR_IO_PENDING)
+		{
+			throw std::system_error(GetLastError(), std::system_category(),
+				"WriteFile failed to start overlapped write");
+		}
+		op._pending = true;
+		this->_sz = -1; // size cache is now stale
+		return *this;
+	}
+
+private:
+	void _prepare_async_op(async_op& op, size_t offset,
+		std::function<void(size_t)> onComplete)
+	{
+		this->_check_file_opened();
+		if (!this->_isOverlapped) {
+			throw std::logic_error("File was not opened for overlapped I/O.");
+		} else if (op._pending) {
+			throw std::logic_error("This async_op is already in flight.");
+		}
+
+		if (!op._ov.hEvent) { // event is created once, reused across operations
+			op._ov.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+		}
+		ResetEvent(op._ov.hEvent);
+		op._ov.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+		op._ov.OffsetHigh = static_cast<DWORD>(static_cast<ULONGLONG>(offset) >> 32);
+		op._hFile = this->_hFile;
+		op._completionCallback = std::move(onComplete);
+	}
+
+public:
+
 	// Gets creation, last access and last write dates, wrapper to GetFileTime.
 	dates get_dates() const {
 		this->_check_file_opened();
@@ -0,0 +1,261 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <cwctype>
+#include <deque>
+#include <utility>
+#include "file_mapped.h"
+#include "file_writer.h"
+#include "internals/thread_pool.h"
+
+namespace wl {
+
+// Incremental workspace file indexer. The crawl advances in bounded time
+// slices meant to run in message-loop idle gaps, so the pump is never blocked;
+// the finished index is persisted to a sidecar file and reloaded on the next
+// run, giving warm search results seconds after launch while the fresh crawl
+// revalidates in the background. Typical wiring:
+//   indexer.load(L"C:\\workspace", L"C:\\workspace\\.wl-index");
+//   wndMain.add_idle_callback([&]() { return indexer.advance(10); });
+class file_indexer final {
+public:
+	// One indexed file.
+	struct entry final {
+		std::wstring path;
+		ULONGLONG    size = 0;
+		ULONGLONG    lastWriteTicks = 0; // FILETIME as a 64-bit value
+	};
+
+private:
+	static const UINT32 _MAGIC = 0x58494C57; // "WLIX", guards against stale formats
+
+	std::wstring             _rootDir;
+	std::wstring             _indexFilePath;
+	std::vector<entry>       _entries;     // what search() sees; swapped on crawl end
+	std::vector<entry>       _fresh;       // being rebuilt by the current crawl
+	std::deque<std::wstring> _pendingDirs; // crawl frontier
+	HANDLE                   _hFind = INVALID_HANDLE_VALUE; // mid-directory state across slices
+	std::wstring             _curDir;
+	WIN32_FIND_DATAW         _fd{};
+	bool                     _crawlDone = false;
+
+public:
+	~file_indexer() {
+		if (this->_hFind != INVALID_HANDLE_VALUE) {
+			FindClose(this->_hFind);
+		}
+	}
+
+	file_indexer() = default;
+	file_indexer(file_indexer&& other) noexcept { this->operator=(std::move(other)); } // movable only
+
+	file_indexer& operator=(file_indexer&& other) noexcept {
+		if (this->_hFind != INVALID_HANDLE_VALUE) {
+			FindClose(this->_hFind); // would leak when overwritten below
+			this->_hFind = INVALID_HANDLE_VALUE;
+		}
+		std::swap(this->_rootDir, other._rootDir);
+		std::swap(this->_indexFilePath, other._indexFilePath);
+		std::swap(this->_entries, other._entries);
+		std::swap(this->_fresh, other._fresh);
+		std::swap(this->_pendingDirs, other._pendingDirs);
+		std::swap(this->_hFind, other._hFind); // source is left invalid, so only one FindClose ever runs
+		std::swap(this->_curDir, other._curDir);
+		std::swap(this->_fd, other._fd);
+		std::swap(this->_crawlDone, other._crawlDone);
+		return *this;
+	}
+
+	// Loads the persisted index, if any, so search() answers right away, and
+	// stages a fresh crawl of the root; drive it with advance() from an idle
+	// callback. A missing or stale index file just means a cold start.
+	file_indexer& load(const std::wstring& rootDir, const std::wstring& indexFilePath) {
+		this->_rootDir = rootDir;
+		this->_indexFilePath = indexFilePath;
+
+		try {
+			file_mapped fm;
+			fm.open(indexFilePath, file::access::READONLY);
+			this->_deserialize(fm.p_mem(), fm.size()); // mapped straight in, no read copy
+		} catch (...) {
+			this->_entries.clear(); // first run, or the file is unreadable; crawl cold
+		}
+
+		return this->restart_crawl();
+	}
+
+	// Discards crawl progress and starts over from the root; the current index
+	// keeps serving searches until the new crawl completes.
+	file_indexer& restart_crawl() {
+		if (this->_hFind != INVALID_HANDLE_VALUE) {
+			FindClose(this->_hFind);
+			this->_hFind = INVALID_HANDLE_VALUE;
+		}
+		this->_fresh.clear();
+		this->_pendingDirs.clear();
+		this->_pendingDirs.emplace_back(this->_rootDir);
+		this->_crawlDone = false;
+		return *this;
+	}
+
+	// Advances the crawl for at most sliceMs milliseconds. Returns true while
+	// there is more to do — exactly the keep-me-registered contract of
+	// add_idle_callback, so the indexer can be wired in directly. When the
+	// crawl finishes, the new index replaces the old one and is persisted on a
+	// pool worker.
+	bool advance(DWORD sliceMs) {
+		if (this->_crawlDone) return false;
+		ULONGLONG deadline = GetTickCount64() + (sliceMs ? sliceMs : 1);
+
+		do {
+			if (this->_hFind == INVALID_HANDLE_VALUE) {
+				if (this->_pendingDirs.empty()) {
+					this->_finish_crawl();
+					return false;
+				}
+				this->_curDir = std::move(this->_pendingDirs.front());
+				this->_pendingDirs.pop_front();
+				this->_hFind = FindFirstFileW((this->_curDir + L"\\*").c_str(), &this->_fd);
+				if (this->_hFind == INVALID_HANDLE_VALUE) continue; // gone or access denied; skip
+				this->_take_found();
+			} else if (FindNextFileW(this->_hFind, &this->_fd)) {
+				this->_take_found();
+			} else { // directory exhausted
+				FindClose(this->_hFind);
+				this->_hFind = INVALID_HANDLE_VALUE;
+			}
+		} while (GetTickCount64() < deadline);
+
+		return true; // more work; call again on the next idle gap
+	}
+
+	// True once a full crawl has completed in this run; search() works before
+	// that too, over the index persisted by the previous run.
+	bool crawl_done() const noexcept {
+		return this->_crawlDone;
+	}
+
+	// All indexed files, in crawl order.
+	const std::vector<entry>& entries() const noexcept {
+		return this->_entries;
+	}
+
+	// Case-insensitive substring search over the indexed paths.
+	std::vector<const entry*> search(const std::wstring& what) const {
+		std::vector<const entry*> ret;
+		if (what.empty()) return ret;
+
+		std::wstring needle = what;
+		for (wchar_t& ch : needle) ch = std::towlower(ch);
+
+		std::wstring hay; // reused across entries
+		for (const entry& e : this->_entries) {
+			hay = e.path;
+			for (wchar_t& ch : hay) ch = std::towlower(ch);
+			if (hay.find(needle) != std::wstring::npos) {
+				ret.emplace_back(&e);
+			}
+		}
+		return ret;
+	}
+
+private:
+	void _take_found() {
+		if (this->_fd.cFileName[0] == L'.' &&
+			(!this->_fd.cFileName[1] ||
+				(this->_fd.cFileName[1] == L'.' && !this->_fd.cFileName[2]))) return; // . and ..
+
+		if (this->_fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+			if (!(this->_fd.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)) { // junction cycles
+				this->_pendingDirs.emplace_back(this->_curDir + L"\\" + this->_fd.cFileName);
+			}
+			return;
+		}
+
+		entry e;
+		e.path = this->_curDir + L"\\" + this->_fd.cFileName;
+		e.size = (static_cast<ULONGLONG>(this->_fd.nFileSizeHigh) << 32) | this->_fd.nFileSizeLow;
+		e.lastWriteTicks = (static_cast<ULONGLONG>(this->_fd.ftLastWriteTime.dwHighDateTime) << 32) |
+			this->_fd.ftLastWriteTime.dwLowDateTime;
+		this->_fresh.emplace_back(std::move(e));
+	}
+
+	void _finish_crawl() {
+		this->_entries = std::move(this->_fresh);
+		this->_fresh.clear();
+		this->_crawlDone = true;
+
+		// Serialization and the disk write go to a pool worker; the UI thread
+		// only pays for copying the records out.
+		std::vector<entry> snapshot = this->_entries;
+		std::wstring destPath = this->_indexFilePath;
+		_wli::thread_pool::instance().submit([snapshot, destPath]() noexcept {
+			try {
+				file_writer fout;
+				fout.open(destPath);
+				_serialize(snapshot, fout);
+				fout.close();
+			} catch (...) {
+				// failing to persist only costs a cold start next run
+			}
+		});
+	}
+
+	static void _serialize(const std::vector<entry>& entries, file_writer& fout) {
+		UINT32 header[2] = {_MAGIC, static_cast<UINT32>(entries.size())};
+		fout.write(reinterpret_cast<const BYTE*>(header), sizeof(header));
+
+		for (const entry& e : entries) {
+			UINT32 pathLen = static_cast<UINT32>(e.path.length());
+			fout.write(reinterpret_cast<const BYTE*>(&pathLen), sizeof(pathLen));
+			fout.write(reinterpret_cast<const BYTE*>(e.path.c_str()), pathLen * sizeof(wchar_t));
+			fout.write(reinterpret_cast<const BYTE*>(&e.size), sizeof(e.size));
+			fout.write(reinterpret_cast<const BYTE*>(&e.lastWriteTicks), sizeof(e.lastWriteTicks));
+		}
+	}
+
+	void _deserialize(const BYTE* pData, size_t sz) {
+		this->_entries.clear();
+		size_t off = 0;
+
+		UINT32 magic = 0, count = 0;
+		if (!_read_raw(pData, sz, off, &magic, sizeof(magic)) || magic != _MAGIC ||
+			!_read_raw(pData, sz, off, &count, sizeof(count))) return;
+
+		this->_entries.reserve(count);
+		for (UINT32 i = 0; i < count; ++i) {
+			UINT32 pathLen = 0;
+			if (!_read_raw(pData, sz, off, &pathLen, sizeof(pathLen)) ||
+				off + pathLen * sizeof(wchar_t) > sz)
+			{
+				this->_entries.clear(); // truncated mid-entry; treat as cold start
+				return;
+			}
+
+			entry e;
+			e.path.assign(reinterpret_cast<const wchar_t*>(pData + off), pathLen);
+			off += pathLen * sizeof(wchar_t);
+			if (!_read_raw(pData, sz, off, &e.size, sizeof(e.size)) ||
+				!_read_raw(pData, sz, off, &e.lastWriteTicks, sizeof(e.lastWriteTicks)))
+			{
+				this->_entries.clear();
+				return;
+			}
+			this->_entries.emplace_back(std::move(e));
+		}
+	}
+
+	static bool _read_raw(const BYTE* pData, size_t sz, size_t& off, void* dest, size_t numBytes) noexcept {
+		if (off + numBytes > sz) return false;
+		memcpy(dest, pData + off, numBytes);
+		off += numBytes;
+		return true;
+	}
+};
+
+}//namespace wl
@@ -6,6 +6,7 @@
  */
 
 #pragma once
+#include <cwchar>
 #include "file_mapped.h"
 #include "insert_order_map.h"
 #include "str.h"
@@ -26,28 +27,42 @@ public:
 	}
 
 	file_ini& load_from_file(const wchar_t* filePath) {
+		// The mapped file is decoded once into a single buffer; everything below
+		// walks that buffer in place with offset/length spans, so no line vector
+		// and no per-line temporary strings are ever allocated. The only strings
+		// materialized are the names and values actually stored in the maps.
 		std::wstring content = str::to_wstring(file_mapped::util::read(filePath));
-		std::vector<std::wstring> lines = str::split_lines(content);
+		size_t contentLen = content.length();
 		insert_order_map<std::wstring, std::wstring>* curSection = nullptr; // section-less keys will be ignored
-		std::wstring tmpName, tmpValue; // temporary buffers
-
-		for (std::wstring& line : lines) {
-			if (str::trim(line).empty()) { // skip blank lines
-				continue;
-			} else if (line[0] == L'[' && line.back() == L']') { // begin of section found
-				tmpName.clear();
-				tmpName.insert(0, &line[1], line.length() - 2); // extract section name
-				curSection = &this->sections[str::trim(tmpName)]; // if inexistent, will be inserted
-			} else if (curSection && line[0] != L';' && line[0] != L'#') { // lines starting with ; or # will be ignored
-				size_t idxEq = line.find_first_of(L'=');
-				if (idxEq != std::wstring::npos) {
-					tmpName.clear();
-					tmpName.insert(0, &line[0], idxEq); // extract key name
-					tmpValue.clear();
-					tmpValue.insert(0, &line[idxEq + 1], line.length() - (idxEq + 1)); // extract value
-					(*curSection)[tmpName] = tmpValue;
+		std::wstring tmpName; // reused across iterations
+
+		size_t lineStart = 0;
+		while (lineStart < contentLen) {
+			size_t lineEnd = content.find_first_of(L"\r\n", lineStart);
+			if (lineEnd == std::wstring::npos) lineEnd = contentLen; // last line
+
+			size_t iFirst = lineStart, iPastLast = lineEnd; // bounds of trimmed line span
+			while (iFirst < iPastLast && std::iswspace(content[iFirst])) ++iFirst;
+			while (iPastLast > iFirst && std::iswspace(content[iPastLast - 1])) --iPastLast;
+
+			if (iFirst == iPastLast) { // skip blank lines
+				// nothing
+			} else if (content[iFirst] == L'[' && content[iPastLast - 1] == L']') { // begin of section found
+				size_t iName = iFirst + 1, iPastName = iPastLast - 1; // trim section name span
+				while (iName < iPastName && std::iswspace(content[iName])) ++iName;
+				while (iPastName > iName && std::iswspace(content[iPastName - 1])) --iPastName;
+				tmpName.assign(content, iName, iPastName - iName);
+				curSection = &this->sections[tmpName]; // if inexistent, will be inserted
+			} else if (curSection && content[iFirst] != L';' && content[iFirst] != L'#') { // lines starting with ; or # will be ignored
+				size_t idxEq = content.find_first_of(L'=', iFirst);
+				if (idxEq != std::wstring::npos && idxEq < iPastLast) {
+					tmpName.assign(content, iFirst, idxEq - iFirst); // extract key name
+					(*curSection)[tmpName].assign(content, idxEq + 1, iPastLast - (idxEq + 1)); // value straight into the map
 				}
 			}
+
+			lineStart = content.find_first_not_of(L"\r\n", lineEnd); // skip line break, any style
+			if (lineStart == std::wstring::npos) break;
 		}
 
 		return *this;
@@ -61,6 +76,144 @@ public:
 	file_ini& load_from_file(const std::wstring& filePath)     { return this->load_from_file(filePath.c_str()); }
 	void      save_to_file(const std::wstring& filePath) const { this->save_to_file(filePath.c_str()); }
 
+	// Writes the companion binary image of the current sections: a versioned
+	// blob holding a record area — counts plus offset/length spans — and one
+	// string table with every name and value. load_binary() walks the records
+	// with no tokenization at all, which is what makes it fast; the text INI
+	// stays the human-editable source, see load_from_file_cached().
+	void save_binary(const wchar_t* binPath) const {
+		using sectionT = insert_order_map<std::wstring, insert_order_map<std::wstring, std::wstring>>::entry;
+		using entryT = insert_order_map<std::wstring, std::wstring>::entry;
+
+		std::vector<UINT32> records;
+		std::wstring table;
+		auto addStr = [&](const std::wstring& s) -> void {
+			records.push_back(static_cast<UINT32>(table.length())); // offset in wchars
+			records.push_back(static_cast<UINT32>(s.length()));
+			table.append(s);
+		};
+
+		for (const sectionT& sectionEntry : this->sections) {
+			addStr(sectionEntry.key);
+			records.push_back(static_cast<UINT32>(sectionEntry.value.size())); // key count
+			for (const entryT& keyEntry : sectionEntry.value) {
+				addStr(keyEntry.key);
+				addStr(keyEntry.value);
+			}
+		}
+
+		UINT32 header[5] = {
+			_BIN_MAGIC, _BIN_VERSION,
+			static_cast<UINT32>(this->sections.size()),
+			static_cast<UINT32>(sizeof(header) + records.size() * sizeof(UINT32)), // string table offset, bytes
+			static_cast<UINT32>(table.length()) // string table length, wchars
+		};
+
+		std::vector<BYTE> blob;
+		blob.reserve(sizeof(header) + records.size() * sizeof(UINT32) +
+			table.length() * sizeof(wchar_t));
+		auto append = [&](const void* pData, size_t szBytes) -> void {
+			const BYTE* p = reinterpret_cast<const BYTE*>(pData);
+			blob.insert(blob.end(), p, p + szBytes);
+		};
+		append(header, sizeof(header));
+		if (!records.empty()) append(&records[0], records.size() * sizeof(UINT32));
+		if (!table.empty())   append(table.c_str(), table.length() * sizeof(wchar_t));
+
+		file::util::write(binPath, blob);
+	}
+
+	// Loads the sections from a blob written by save_binary(), straight from
+	// the mapped file: no character is inspected, the record spans say where
+	// every name and value sits in the string table. Returns false when the
+	// blob is missing, truncated or from another version — sections are left
+	// empty then — so the caller can fall back to the text INI.
+	bool load_binary(const wchar_t* binPath) {
+		try {
+			file_mapped fin;
+			fin.open(binPath, file::access::READONLY);
+			const BYTE* pBase = fin.p_mem();
+			size_t szBytes = fin.size();
+
+			auto u32At = [&](size_t byteOff, UINT32& v) noexcept -> bool {
+				if (byteOff + sizeof(UINT32) > szBytes) return false;
+				CopyMemory(&v, pBase + byteOff, sizeof(UINT32));
+				return true;
+			};
+
+			UINT32 magic = 0, version = 0, numSections = 0, tableOff = 0, tableLen = 0;
+			if (!u32At(0, magic) || magic != _BIN_MAGIC ||
+				!u32At(4, version) || version != _BIN_VERSION ||
+				!u32At(8, numSections) || !u32At(12, tableOff) || !u32At(16, tableLen) ||
+				tableOff + static_cast<size_t>(tableLen) * sizeof(wchar_t) > szBytes)
+			{
+				return false;
+			}
+			const wchar_t* table = reinterpret_cast<const wchar_t*>(pBase + tableOff);
+
+			auto strAt = [&](size_t& byteOff, std::wstring& dest) noexcept -> bool {
+				UINT32 off = 0, len = 0;
+				if (!u32At(byteOff, off) || !u32At(byteOff + 4, len) ||
+					static_cast<size_t>(off) + len > tableLen)
+				{
+					return false;
+				}
+				byteOff += 8;
+				dest.assign(table + off, len);
+				return true;
+			};
+
+			this->sections.clear();
+			size_t off = 20; // past the header
+			std::wstring tmpName, tmpVal; // reused across records
+			for (UINT32 s = 0; s < numSections; ++s) {
+				if (!strAt(off, tmpName)) { this->sections.clear(); return false; }
+				insert_order_map<std::wstring, std::wstring>& curSection = this->sections[tmpName];
+
+				UINT32 numKeys = 0;
+				if (!u32At(off, numKeys)) { this->sections.clear(); return false; }
+				off += 4;
+				curSection.reserve(numKeys);
+				for (UINT32 k = 0; k < numKeys; ++k) {
+					if (!strAt(off, tmpName) || !strAt(off, tmpVal)) {
+						this->sections.clear();
+						return false;
+					}
+					curSection[tmpName] = tmpVal;
+				}
+			}
+		} catch (...) {
+			return false; // unreadable or unmappable, caller falls back to text
+		}
+		return true;
+	}
+
+	// Loads settings preferring the binary companion: when it exists and is
+	// not older than the text INI it's loaded with zero parsing; otherwise the
+	// text file is parsed as usual and the companion rewritten for the next
+	// launch. The text INI remains the human-editable source of truth — after
+	// a hand edit, its newer timestamp makes this re-parse and refresh the blob.
+	file_ini& load_from_file_cached(const wchar_t* iniPath, const wchar_t* binPath) {
+		if (_is_at_least_as_new(binPath, iniPath) && this->load_binary(binPath)) {
+			return *this;
+		}
+		this->load_from_file(iniPath);
+		try {
+			this->save_binary(binPath);
+		} catch (...) {
+			// The companion is just an accelerator; failing to write it can't
+			// turn a successful load into an error.
+		}
+		return *this;
+	}
+
+	void save_binary(const std::wstring& binPath) const { this->save_binary(binPath.c_str()); }
+	bool load_binary(const std::wstring& binPath)       { return this->load_binary(binPath.c_str()); }
+
+	file_ini& load_from_file_cached(const std::wstring& iniPath, const std::wstring& binPath) {
+		return this->load_from_file_cached(iniPath.c_str(), binPath.c_str());
+	}
+
 	// Returns the INI contents as a string, ready to be written to a file.
 	std::wstring serialize() const {
 		std::wstring out;
@@ -85,6 +238,87 @@ public:
 		return out;
 	}
 
+	// Typed getters: the parsed value is cached per key, and the cache entry
+	// remembers the raw string it was parsed from — a read where the string is
+	// unchanged costs a compare, not a parse, and any write through the public
+	// maps is picked up on the next read. Missing keys return the default.
+	int get_int(const std::wstring& sectionName, const std::wstring& keyName, int defVal = 0) {
+		const _typed_val* cached = this->_get_typed(sectionName, keyName);
+		return cached ? static_cast<int>(cached->intVal) : defVal;
+	}
+
+	long long get_int64(const std::wstring& sectionName, const std::wstring& keyName, long long defVal = 0) {
+		const _typed_val* cached = this->_get_typed(sectionName, keyName);
+		return cached ? cached->intVal : defVal;
+	}
+
+	double get_double(const std::wstring& sectionName, const std::wstring& keyName, double defVal = 0) {
+		const _typed_val* cached = this->_get_typed(sectionName, keyName);
+		return cached ? cached->dblVal : defVal;
+	}
+
+	// True for "true", "yes", "on" and any non-zero number, case-insensitive.
+	bool get_bool(const std::wstring& sectionName, const std::wstring& keyName, bool defVal = false) {
+		const _typed_val* cached = this->_get_typed(sectionName, keyName);
+		return cached ? cached->boolVal : defVal;
+	}
+
+	// Snapshots keys of one section into the fields of a caller struct, one
+	// lookup pass per key; hot loops then read plain struct fields instead of
+	// parsing strings. Usage:
+	//   ini.bind_section(L"render")
+	//      .to_int(L"fps", cfg.fps, 60)
+	//      .to_bool(L"vsync", cfg.vsync, true);
+	class section_binder final {
+		friend class file_ini;
+
+	private:
+		const insert_order_map<std::wstring, std::wstring>* _section; // null if absent
+
+		explicit section_binder(const insert_order_map<std::wstring, std::wstring>* section) noexcept :
+			_section{section} { }
+
+	public:
+		section_binder& to_int(const std::wstring& keyName, int& dest, int defVal = 0) {
+			const std::wstring* raw = this->_raw(keyName);
+			dest = raw ? static_cast<int>(_parse_int(*raw)) : defVal;
+			return *this;
+		}
+
+		section_binder& to_int64(const std::wstring& keyName, long long& dest, long long defVal = 0) {
+			const std::wstring* raw = this->_raw(keyName);
+			dest = raw ? _parse_int(*raw) : defVal;
+			return *this;
+		}
+
+		section_binder& to_double(const std::wstring& keyName, double& dest, double defVal = 0) {
+			const std::wstring* raw = this->_raw(keyName);
+			dest = raw ? _parse_double(*raw) : defVal;
+			return *this;
+		}
+
+		section_binder& to_bool(const std::wstring& keyName, bool& dest, bool defVal = false) {
+			const std::wstring* raw = this->_raw(keyName);
+			dest = raw ? _parse_bool(*raw) : defVal;
+			return *this;
+		}
+
+		section_binder& to_str(const std::wstring& keyName, std::wstring& dest, const wchar_t* defVal = L"") {
+			const std::wstring* raw = this->_raw(keyName);
+			dest = raw ? *raw : defVal;
+			return *this;
+		}
+
+	private:
+		const std::wstring* _raw(const std::wstring& keyName) const noexcept {
+			return this->_section ? this->_section->get_if_exists(keyName) : nullptr;
+		}
+	};
+
+	section_binder bind_section(const std::wstring& sectionName) const noexcept {
+		return section_binder{this->sections.get_if_exists(sectionName)};
+	}
+
 	// Checks INI file structure against "[section1]keyA,keyB,keyC[section2]keyX,keyY".
 	bool structure_is(const std::wstring& structure) const {
 		using strvecT = std::vector<std::wstring>;
@@ -99,6 +333,65 @@ public:
 	}
 
 private:
+	static const UINT32 _BIN_MAGIC = 0x42494C57;   // "WLIB", tags save_binary() blobs
+	static const UINT32 _BIN_VERSION = 1;          // bumped whenever the layout changes
+
+	// True when the first file exists and its last write is not older than the
+	// second's; attribute queries only, neither file is opened.
+	static bool _is_at_least_as_new(const wchar_t* path, const wchar_t* thanPath) noexcept {
+		WIN32_FILE_ATTRIBUTE_DATA fad{}, fadThan{};
+		if (!GetFileAttributesExW(path, GetFileExInfoStandard, &fad)) return false;
+		if (!GetFileAttributesExW(thanPath, GetFileExInfoStandard, &fadThan)) return true; // no text file at all
+		return CompareFileTime(&fad.ftLastWriteTime, &fadThan.ftLastWriteTime) >= 0;
+	}
+
+	// One parsed value plus the raw string it came from; the raw copy is the
+	// staleness check, so writes through the public maps need no notification.
+	struct _typed_val final {
+		std::wstring raw;
+		long long    intVal = 0;
+		double       dblVal = 0;
+		bool         boolVal = false;
+	};
+
+	insert_order_map<std::wstring, _typed_val> _typedCache; // keyed by "section\nkey"
+	std::wstring _typedCacheKeyBuf; // reused across lookups
+
+	static long long _parse_int(const std::wstring& s) noexcept {
+		return wcstoll(s.c_str(), nullptr, 0); // base 0 also accepts hex and octal
+	}
+
+	static double _parse_double(const std::wstring& s) noexcept {
+		return wcstod(s.c_str(), nullptr);
+	}
+
+	static bool _parse_bool(const std::wstring& s) noexcept {
+		return !lstrcmpiW(s.c_str(), L"true") ||
+			!lstrcmpiW(s.c_str(), L"yes") ||
+			!lstrcmpiW(s.c_str(), L"on") ||
+			_parse_int(s) != 0;
+	}
+
+	const _typed_val* _get_typed(const std::wstring& sectionName, const std::wstring& keyName) {
+		const insert_order_map<std::wstring, std::wstring>* curSection =
+			this->sections.get_if_exists(sectionName);
+		if (!curSection) return nullptr;
+		const std::wstring* raw = curSection->get_if_exists(keyName);
+		if (!raw) return nullptr;
+
+		this->_typedCacheKeyBuf.assign(sectionName)
+			.append(1, L'\n').append(keyName); // \n can't appear in INI names
+		_typed_val& cached = this->_typedCache[this->_typedCacheKeyBuf];
+
+		if (cached.raw != *raw) { // first read, or the value changed since
+			cached.raw = *raw;
+			cached.intVal = _parse_int(*raw);
+			cached.dblVal = _parse_double(*raw);
+			cached.boolVal = _parse_bool(*raw);
+		}
+		return &cached;
+	}
+
 	insert_order_map<std::wstring, std::vector<std::wstring>> _parse_structure(const std::wstring& structure) const {
 		using strvecT = std::vector<std::wstring>;
 		insert_order_map<std::wstring, strvecT> parsed;
@@ -6,16 +6,53 @@
  */
 
 #pragma once
+#include <memory>
 #include "file.h"
 
 namespace wl {
 
 // Wrapper to a memory-mapped file.
 class file_mapped final {
+public:
+	// A window over a part of the file, mapped on demand by map_range. The
+	// underlying mapping is shared and unmapped when the last view over it dies.
+	class view final {
+		friend class file_mapped;
+
+	private:
+		std::shared_ptr<void> _baseMem; // page-aligned mapping, deleter unmaps
+		BYTE*                 _pData = nullptr;
+		size_t                _sz = 0;
+
+		view(std::shared_ptr<void> baseMem, BYTE* pData, size_t sz) noexcept :
+			_baseMem{std::move(baseMem)}, _pData{pData}, _sz{sz} { }
+
+	public:
+		view() = default;
+		view(view&&) = default;
+		view& operator=(view&&) = default; // movable only
+
+		BYTE*  p_mem() const noexcept      { return this->_pData; }
+		BYTE*  p_past_mem() const noexcept { return this->_pData + this->_sz; }
+		size_t size() const noexcept       { return this->_sz; }
+	};
+
 private:
+	// One recently mapped window, kept warm for reuse by map_range.
+	struct _cached_window final {
+		size_t                alignedOffset = 0;
+		size_t                mappedLen = 0;
+		std::shared_ptr<void> baseMem;
+		size_t                lastUse = 0; // LRU tick
+	};
+
 	file   _file;
 	HANDLE _hMap = nullptr;
 	void*  _pMem = nullptr;
+	size_t _windowGranularity = 0; // preferred window size, 0 = exact ranges
+	std::vector<_cached_window> _windowCache;
+	size_t _windowCacheCap = 4;
+	size_t _windowUseTick = 0;
 
 public:
 	~file_mapped() {
@@ -30,6 +67,10 @@ public:
 		std::swap(this->_file, other._file);
 		std::swap(this->_hMap, other._hMap);
 		std::swap(this->_pMem, other._pMem);
+		std::swap(this->_windowGranularity, other._windowGranularity);
+		std::swap(this->_windowCache, other._windowCache);
+		std::swap(this->_windowCacheCap, other._windowCacheCap);
+		std::swap(this->_windowUseTick, other._windowUseTick);
 		return *this;
 	}
 
@@ -39,6 +80,7 @@ public:
 	BYTE*        p_past_mem() noexcept        { return p_mem() + this->size(); }
 
 	file_mapped& close() noexcept {
+		this->_windowCache.clear(); // live views keep their own shared mappings
 		if (this->_pMem) {
 			UnmapViewOfFile(this->_pMem);
 			this->_pMem = nullptr;
@@ -83,6 +125,150 @@ public:
 		return *this;
 	}
 
+	// Creates the file (overwriting any previous content) with the given size
+	// and maps it read-write, so a large output is built by filling the pages in
+	// place — the data travels through the page cache with no user-space copy.
+	// Call finish() with the final written length when done; a plain close()
+	// leaves the file at its full initial size.
+	file_mapped& create(const std::wstring& filePath, size_t initialSize) {
+		this->close();
+		if (!initialSize) {
+			throw std::invalid_argument("Can't create a mapping of zero bytes.");
+		}
+
+		this->_file.open_or_create(filePath);
+		this->_file.set_new_size(initialSize);
+
+		auto tooBad = [this](DWORD err, const char* msg) -> void {
+			this->close();
+			throw std::system_error(err, std::system_category(), msg);
+		};
+
+		this->_hMap = CreateFileMappingW(this->_file.hfile(), nullptr,
+			PAGE_READWRITE, 0, 0, nullptr);
+		if (!this->_hMap) {
+			tooBad(GetLastError(), "CreateFileMapping failed to create writable mapping");
+		}
+
+		this->_pMem = MapViewOfFile(this->_hMap, FILE_MAP_WRITE, 0, 0, 0);
+		if (!this->_pMem) {
+			tooBad(GetLastError(), "MapViewOfFile failed to create writable mapping");
+		}
+
+		return *this;
+	}
+
+	// Ends an in-place construction started with create: unmaps the pages,
+	// truncates the file to the bytes actually written, and closes it.
+	file_mapped& finish(size_t finalLength) {
+		this->_check_file_mapped();
+
+		this->_windowCache.clear();
+		UnmapViewOfFile(this->_pMem);
+		this->_pMem = nullptr;
+		CloseHandle(this->_hMap);
+		this->_hMap = nullptr;
+
+		this->_file.set_new_size(finalLength); // the mapping rounded it up to whole pages
+		this->_file.close();
+		return *this;
+	}
+
+	// Opens the file and creates the mapping object, but doesn't map any bytes:
+	// windows over the content are then mapped on demand with map_range, so huge
+	// files never occupy more address space than the views actually in use.
+	file_mapped& open_windowed(const std::wstring& filePath, file::access accessType) {
+		this->close();
+		this->_file.open_existing(filePath, accessType);
+
+		this->_hMap = CreateFileMappingW(this->_file.hfile(), nullptr,
+			(accessType == file::access::READWRITE) ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+		if (!this->_hMap) {
+			DWORD err = GetLastError();
+			this->close();
+			throw std::system_error(err, std::system_category(),
+				"CreateFileMapping failed to create windowed mapping");
+		}
+		return *this;
+	}
+
+	// Sets the preferred size of each window mapped by map_range; bigger windows
+	// mean fewer remaps on sequential scans. Zero maps exact ranges only.
+	file_mapped& set_window_granularity(size_t numBytes) noexcept {
+		this->_windowGranularity = numBytes;
+		return *this;
+	}
+
+	// Sets how many recently mapped windows are kept warm for reuse.
+	file_mapped& set_window_cache_size(size_t numWindows) noexcept {
+		this->_windowCacheCap = numWindows;
+		return *this;
+	}
+
+	// Maps only the given range of the file, returning a movable view over it.
+	// Recently mapped windows are kept in a small LRU cache, so a sequential
+	// scan touches a bounded working set instead of the whole file.
+	view map_range(size_t offset, size_t length) {
+		if (!this->_hMap || !this->_file.hfile()) {
+			throw std::logic_error("File has not been mapped.");
+		} else if (offset + length > this->size()) {
+			throw std::invalid_argument("Range is beyond end of file.");
+		}
+
+		// Views must start at an allocation-granularity boundary.
+		static size_t allocGran = 0;
+		if (!allocGran) {
+			SYSTEM_INFO si{};
+			GetNativeSystemInfo(&si);
+			allocGran = si.dwAllocationGranularity;
+		}
+
+		size_t alignedOffset = offset - (offset % allocGran);
+		size_t mappedLen = (offset - alignedOffset) + length;
+		if (mappedLen < this->_windowGranularity) mappedLen = this->_windowGranularity;
+		if (alignedOffset + mappedLen > this->size()) mappedLen = this->size() - alignedOffset;
+
+		// Serve from a warm window, if one covers the range.
+		for (_cached_window& cw : this->_windowCache) {
+			if (cw.alignedOffset <= alignedOffset &&
+				cw.alignedOffset + cw.mappedLen >= offset + length)
+			{
+				cw.lastUse = ++this->_windowUseTick;
+				return {cw.baseMem,
+					reinterpret_cast<BYTE*>(cw.baseMem.get()) + (offset - cw.alignedOffset),
+					length};
+			}
+		}
+
+		void* pBase = MapViewOfFile(this->_hMap,
+			(this->access_type() == file::access::READWRITE) ? FILE_MAP_WRITE : FILE_MAP_READ,
+			static_cast<DWORD>(static_cast<ULONGLONG>(alignedOffset) >> 32),
+			static_cast<DWORD>(alignedOffset & 0xFFFFFFFF),
+			mappedLen);
+		if (!pBase) {
+			throw std::system_error(GetLastError(), std::system_category(),
+				"MapViewOfFile failed to map range");
+		}
+		std::shared_ptr<void> baseMem{pBase,
+			[](void* p) noexcept { UnmapViewOfFile(p); }};
+
+		if (this->_windowCacheCap) {
+			if (this->_windowCache.size() >= this->_windowCacheCap) { // evict least recently used
+				size_t iOldest = 0;
+				for (size_t i = 1; i < this->_windowCache.size(); ++i) {
+					if (this->_windowCache[i].lastUse < this->_windowCache[iOldest].lastUse) {
+						iOldest = i;
+					}
+				}
+				this->_windowCache.erase(this->_windowCache.begin() + iOldest);
+			}
+			this->_windowCache.push_back({alignedOffset, mappedLen, baseMem, ++this->_windowUseTick});
+		}
+
+		return {std::move(baseMem),
+			reinterpret_cast<BYTE*>(pBase) + (offset - alignedOffset), length};
+	}
+
 private:
 	void _check_file_mapped() const {
 		if (!this->_hMap || !this->_pMem || !this->_file.hfile()) {
@@ -0,0 +1,163 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include "file.h"
+
+namespace wl {
+
+// Buffered writer on top of wl::file. Small writes are coalesced into an
+// in-memory buffer and reach the disk as one WriteFile per buffer-full,
+// instead of one syscall per call; writes larger than the buffer bypass it.
+// Flushes explicitly, on close and on destruction; write_through is the
+// escape hatch for durability points.
+class file_writer final {
+private:
+	static const size_t _DEFAULT_BUF_SZ = 1024 * 1024; // 1 MB
+
+	file              _file;
+	std::vector<BYTE> _buf;
+	size_t            _bufUsed = 0;
+	size_t            _written = 0; // logical bytes written so far
+	bool              _preallocated = false;
+
+public:
+	~file_writer() {
+		try {
+			this->close(); // also flushes
+		} catch (...) {
+			// a destructor can't propagate; call close() yourself to see errors
+		}
+	}
+
+	file_writer() = default;
+	file_writer(file_writer&& other) noexcept { this->operator=(std::move(other)); }
+
+	file_writer& operator=(file_writer&& other) noexcept {
+		std::swap(this->_file, other._file);
+		std::swap(this->_buf, other._buf);
+		std::swap(this->_bufUsed, other._bufUsed);
+		std::swap(this->_written, other._written);
+		std::swap(this->_preallocated, other._preallocated);
+		return *this;
+	}
+
+	// Opens the file as read/write, creating it if it doesn't exist, and
+	// truncating any previous content.
+	file_writer& open(const wchar_t* filePath, size_t bufferSize = _DEFAULT_BUF_SZ) {
+		this->close();
+		this->_file.open_or_create(filePath)
+			.set_new_size(0); // start clean
+		this->_buf.resize(bufferSize ? bufferSize : _DEFAULT_BUF_SZ);
+		return *this;
+	}
+
+	file_writer& open(const std::wstring& filePath, size_t bufferSize = _DEFAULT_BUF_SZ) {
+		return this->open(filePath.c_str(), bufferSize);
+	}
+
+	// Number of bytes sitting in the buffer, not yet on disk.
+	size_t buffered() const noexcept {
+		return this->_bufUsed;
+	}
+
+	// Total logical bytes written so far, buffered or not.
+	size_t written() const noexcept {
+		return this->_written;
+	}
+
+	// Grows the file upfront to the estimated final size, so sequential writes
+	// don't pay repeated extensions; the file is trimmed back to the bytes
+	// actually written when closed.
+	file_writer& preallocate(size_t estimatedBytes) {
+		if (estimatedBytes > this->_written) {
+			this->flush(); // the buffer tail must land before the pointer moves
+			this->_file.set_new_size(estimatedBytes)
+				.seek_to(this->_written); // set_new_size rewinds; resume where we were
+			this->_preallocated = true;
+		}
+		return *this;
+	}
+
+	// Appends bytes; they land on disk when the buffer fills, on flush, or on
+	// close. A block larger than the buffer is written directly, skipping the copy.
+	file_writer& write(const BYTE* pData, size_t sz) {
+		this->_check_writer_opened();
+		if (sz >= this->_buf.size()) { // too big to ever coalesce
+			this->flush();
+			this->_file.write(pData, sz);
+			this->_written += sz;
+			return *this;
+		}
+
+		if (this->_bufUsed + sz > this->_buf.size()) {
+			this->flush();
+		}
+		CopyMemory(&this->_buf[this->_bufUsed], pData, sz);
+		this->_bufUsed += sz;
+		this->_written += sz;
+		return *this;
+	}
+
+	file_writer& write(const std::vector<BYTE>& data) {
+		return this->write(&data[0], data.size());
+	}
+
+	// Writes any pending buffered bytes to disk.
+	file_writer& flush() {
+		if (this->_bufUsed) {
+			this->_file.write(&this->_buf[0], this->_bufUsed);
+			this->_bufUsed = 0;
+		}
+		return *this;
+	}
+
+	// Durability point: flushes the buffer, writes the given bytes, and forces
+	// everything through the OS cache onto the device with FlushFileBuffers.
+	// Far more expensive than write; use at transaction boundaries only.
+	file_writer& write_through(const BYTE* pData, size_t sz) {
+		this->_check_writer_opened();
+		this->flush();
+		if (sz) {
+			this->_file.write(pData, sz);
+			this->_written += sz;
+		}
+		if (!FlushFileBuffers(this->_file.hfile())) {
+			throw std::system_error(GetLastError(), std::system_category(),
+				"FlushFileBuffers failed");
+		}
+		return *this;
+	}
+
+	file_writer& write_through(const std::vector<BYTE>& data) {
+		return this->write_through(&data[0], data.size());
+	}
+
+	// Flushes, trims any unused preallocated tail, and closes the file.
+	file_writer& close() {
+		if (this->_file.hfile()) {
+			this->flush();
+			if (this->_preallocated && this->_file.size() != this->_written) {
+				this->_file.set_new_size(this->_written);
+			}
+			this->_file.close();
+		}
+		this->_bufUsed = 0;
+		this->_written = 0;
+		this->_preallocated = false;
+		return *this;
+	}
+
+private:
+	void _check_writer_opened() const {
+		if (!this->_file.hfile()) {
+			throw std::logic_error("File writer has not been opened.");
+		}
+	}
+};
+
+}//namespace wl
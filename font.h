@@ -8,8 +8,10 @@
 #pragma once
 #include <system_error>
 #include <VersionHelpers.h>
+#include "dpi.h"
 #include "wnd.h"
 #include "internals/enable_bitmask_operators.h"
+#include "internals/font_cache.h"
 
 namespace wl {
 
@@ -17,6 +19,7 @@ namespace wl {
 class font final {
 private:
 	HFONT _hFont = nullptr;
+	bool  _shared = false; // handle owned by the process-wide font_cache?
 
 public:
 	// Can be combined with bitmask operators.
@@ -34,8 +37,9 @@ public:
 
 	font() = default;
 
-	font(font&& other) noexcept : _hFont{other._hFont} {
+	font(font&& other) noexcept : _hFont{other._hFont}, _shared{other._shared} {
 		other._hFont = nullptr;
+		other._shared = false;
 	}
 
 	HFONT hfont() const noexcept {
@@ -45,44 +49,49 @@ public:
 	font& operator=(font&& other) noexcept {
 		this->destroy();
 		std::swap(this->_hFont, other._hFont);
+		std::swap(this->_shared, other._shared);
 		return *this;
 	}
 
 	font& destroy() noexcept {
 		if (this->_hFont) {
-			DeleteObject(this->_hFont);
+			if (this->_shared) {
+				_wli::font_cache::instance().release(this->_hFont); // deleted on last owner
+			} else {
+				DeleteObject(this->_hFont);
+			}
 			this->_hFont = nullptr;
+			this->_shared = false;
 		}
 		return *this;
 	}
 
+	// Creation goes through the process-wide font cache: identical descriptions
+	// across all windows share one refcounted HFONT, and CreateFontIndirect
+	// runs only the first time each font is asked for.
 	font& create(const LOGFONT& lf) {
 		this->destroy();
-		this->_hFont = CreateFontIndirectW(&lf);
-		if (!this->_hFont) {
-			throw std::system_error(GetLastError(), std::system_category(),
-				"CreateFontIndirect failed");
-		}
+		this->_hFont = _wli::font_cache::instance().acquire(lf);
+		this->_shared = true;
 		return *this;
 	}
 
 	font& create(const wchar_t* fontName, BYTE size, deco style = deco::NONE) {
-		this->destroy();
-		LOGFONT lf{};
-		lstrcpyW(lf.lfFaceName, fontName);
-		lf.lfHeight = -(size + 3);
-
-		auto hasDeco = [=](deco yourDeco) noexcept -> BOOL {
-			return (static_cast<BYTE>(style) &
-				static_cast<BYTE>(yourDeco)) != 0 ? TRUE : FALSE;
-		};
+		return this->create(_build_logfont(fontName, size, style));
+	}
 
-		lf.lfWeight    = hasDeco(deco::BOLD) ? FW_BOLD : FW_DONTCARE;
-		lf.lfItalic    = hasDeco(deco::ITALIC);
-		lf.lfUnderline = hasDeco(deco::UNDERLINE);
-		lf.lfStrikeOut = hasDeco(deco::STRIKEOUT);
+	// Creates the font scaled from its 96-dpi design description to the given
+	// DPI context. The scaled LOGFONT goes through the same font cache, so a
+	// monitor hop materializes each distinct (description, DPI) pair once —
+	// every further control on that monitor reuses the cached HFONT.
+	font& create_scaled(const LOGFONT& lf, const dpi_context& dpiCtx) {
+		return this->create(dpiCtx.scale(lf));
+	}
 
-		return this->create(lf);
+	font& create_scaled(const wchar_t* fontName, BYTE size, const dpi_context& dpiCtx,
+		deco style = deco::NONE)
+	{
+		return this->create(dpiCtx.scale(_build_logfont(fontName, size, style)));
 	}
 
 	// Sets the font on the given control.
@@ -109,6 +118,24 @@ public:
 		return this->create(ncm.lfMenuFont); // Tahoma/Segoe
 	}
 
+private:
+	static LOGFONT _build_logfont(const wchar_t* fontName, BYTE size, deco style) noexcept {
+		LOGFONT lf{};
+		lstrcpyW(lf.lfFaceName, fontName);
+		lf.lfHeight = -(size + 3);
+
+		auto hasDeco = [=](deco yourDeco) noexcept -> BOOL {
+			return (static_cast<BYTE>(style) &
+				static_cast<BYTE>(yourDeco)) != 0 ? TRUE : FALSE;
+		};
+
+		lf.lfWeight    = hasDeco(deco::BOLD) ? FW_BOLD : FW_DONTCARE;
+		lf.lfItalic    = hasDeco(deco::ITALIC);
+		lf.lfUnderline = hasDeco(deco::UNDERLINE);
+		lf.lfStrikeOut = hasDeco(deco::STRIKEOUT);
+		return lf;
+	}
+
 public:
 	class util final {
 	private:
@@ -7,8 +7,10 @@
 
 #pragma once
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "internals/gdi_objects.h"
+#include "internals/latency_tracer.h"
 #include "wnd.h"
 
 namespace wl {
@@ -16,6 +18,67 @@ namespace wl {
 // Wrappers to GDI objects.
 namespace gdi {
 
+// Process-wide cache of text measurements, keyed by (font, string), so strings
+// measured on every WM_PAINT enter GDI only once. Intended to be used from the
+// UI thread; call invalidate() when an HFONT is destroyed or replaced, so its
+// stale sizes don't outlive it.
+class text_extent_cache final {
+private:
+	struct _key final {
+		HFONT        hFont;
+		std::wstring text;
+
+		bool operator==(const _key& other) const noexcept {
+			return this->hFont == other.hFont && this->text == other.text;
+		}
+	};
+	struct _key_hash final {
+		size_t operator()(const _key& k) const noexcept {
+			return std::hash<std::wstring>{}(k.text) ^
+				(std::hash<void*>{}(k.hFont) << 1);
+		}
+	};
+
+	std::unordered_map<_key, SIZE, _key_hash> _sizes;
+
+public:
+	static text_extent_cache& instance() noexcept {
+		static text_extent_cache obj; // thread-safe in C++11
+		return obj;
+	}
+
+	// Returns the box size of the text under the font currently selected into the
+	// device context, measuring with GetTextExtentPoint32() only on a cache miss.
+	SIZE measure(HDC hDC, const std::wstring& text) {
+		_key key{reinterpret_cast<HFONT>(GetCurrentObject(hDC, OBJ_FONT)), text};
+
+		std::unordered_map<_key, SIZE, _key_hash>::const_iterator it = this->_sizes.find(key);
+		if (it != this->_sizes.cend()) {
+			return it->second; // warm hit, no GDI call at all
+		}
+
+		SIZE sz{};
+		GetTextExtentPoint32W(hDC, text.c_str(), static_cast<int>(text.length()), &sz);
+		this->_sizes.emplace(std::move(key), sz);
+		return sz;
+	}
+
+	// Discards the cached measurements of the given font.
+	void invalidate(HFONT hFont) noexcept {
+		for (std::unordered_map<_key, SIZE, _key_hash>::iterator it = this->_sizes.begin();
+			it != this->_sizes.end(); )
+		{
+			it = (it->first.hFont == hFont) ? this->_sizes.erase(it) : std::next(it);
+		}
+	}
+
+	// Discards every cached measurement.
+	void clear() noexcept {
+		this->_sizes.clear();
+	}
+};
+
+
 // Wrapper to device context, BeginPaint/EndPaint must be called manually.
 class dc {
 protected:
@@ -180,6 +243,23 @@ public:
 			(numChars == std::wstring::npos) ? text.length() : numChars);
 	}
 
+	// Gets box size like get_text_extent(), but consults the process-wide
+	// text_extent_cache first, so steady-state repaints that measure the same
+	// strings over and over skip the GDI call entirely.
+	SIZE get_text_extent_cached(const std::wstring& text) const {
+		return text_extent_cache::instance().measure(this->_hDC, text);
+	}
+
+	// Writes the string centered in the given rectangle, using the cached
+	// measurement to compute the origin.
+	dc& text_out_centered(const RECT& rc, const std::wstring& text) {
+		SIZE sz = this->get_text_extent_cached(text);
+		return this->text_out(
+			rc.left + ((rc.right - rc.left) - sz.cx) / 2,
+			rc.top + ((rc.bottom - rc.top) - sz.cy) / 2,
+			text);
+	}
+
 	// Fills a rectangle by using the specified brush. This function includes the left and top
 	// borders, but excludes the right and bottom borders of the rectangle.
 	dc& fill_rect(int left, int top, int right, int bottom, HBRUSH hBrush) noexcept {
@@ -258,12 +338,16 @@ private:
 
 public:
 	~dc_painter() {
-		EndPaint(this->_hWnd, &this->_ps);
+		EndPaint(this->_hWnd, &this->_ps); // derived buffered blits have happened by now
+		_wli::latency_tracer::instance().record(
+			_wli::latency_tracer::event_kind::PAINT_END, this->_hWnd, 0);
 	}
 
 	explicit dc_painter(HWND hWnd) noexcept :
 		dc(BeginPaint(hWnd, &_ps)), _hWnd(hWnd)
 	{
+		_wli::latency_tracer::instance().record(
+			_wli::latency_tracer::event_kind::PAINT_BEGIN, hWnd, 0);
 		RECT rcClient{};
 		GetClientRect(hWnd, &rcClient); // cache width & height
 		this->_sz.cx = rcClient.right;
@@ -288,6 +372,19 @@ public:
 		return this->_sz;
 	}
 
+	// Returns the rectangle actually invalidated, straight from the PAINTSTRUCT;
+	// everything outside it is clipped away by GDI anyway, so skip drawing it.
+	const RECT& invalid_rect() const noexcept {
+		return this->_ps.rcPaint;
+	}
+
+	// Tells if the given rectangle intersects the invalidated area; false means
+	// drawing it would be entirely clipped, so the handler can skip the work.
+	bool is_invalidated(const RECT& rc) const noexcept {
+		RECT rcDummy{};
+		return IntersectRect(&rcDummy, &rc, &this->_ps.rcPaint) != 0;
+	}
+
 	// Gets the color of the current background brush.
 	COLORREF get_bk_brush_color() const noexcept {
 		ULONG_PTR hbrBg = GetClassLongPtrW(this->_hWnd, GCLP_HBRBACKGROUND);
@@ -337,5 +434,176 @@ public:
 		dc_painter_buffered(w->hwnd()) { }
 };
 
+
+// Persistent double-buffer storage for a custom-drawn window: owns a memory DC
+// and a compatible bitmap, reallocated only when the client area outgrows them,
+// surviving across WM_PAINT cycles. Keep one as a member of your control and
+// hand it to dc_buffered on every paint.
+class back_buffer final {
+private:
+	HDC     _hMemDC = nullptr;
+	HBITMAP _hBmp = nullptr, _hBmpOld = nullptr;
+	SIZE    _allocSz{};
+
+public:
+	~back_buffer() {
+		this->release();
+	}
+
+	back_buffer() = default;
+	back_buffer(back_buffer&& other) noexcept { this->operator=(std::move(other)); }
+
+	back_buffer& operator=(back_buffer&& other) noexcept {
+		this->release();
+		std::swap(this->_hMemDC, other._hMemDC);
+		std::swap(this->_hBmp, other._hBmp);
+		std::swap(this->_hBmpOld, other._hBmpOld);
+		std::swap(this->_allocSz, other._allocSz);
+		return *this;
+	}
+
+	// Frees the memory DC and the bitmap; they're lazily recreated on the next paint.
+	back_buffer& release() noexcept {
+		if (this->_hMemDC) {
+			if (this->_hBmp) {
+				SelectObject(this->_hMemDC, this->_hBmpOld);
+				DeleteObject(this->_hBmp);
+				this->_hBmp = this->_hBmpOld = nullptr;
+			}
+			DeleteDC(this->_hMemDC);
+			this->_hMemDC = nullptr;
+			this->_allocSz = {};
+		}
+		return *this;
+	}
+
+	// Returns the memory DC with a bitmap at least as big as the given size,
+	// allocating GDI objects only on first use or growth.
+	HDC ensure(HDC hScreenDC, const SIZE& neededSz) noexcept {
+		if (!this->_hMemDC) {
+			this->_hMemDC = CreateCompatibleDC(hScreenDC);
+		}
+		if (!this->_hBmp ||
+			this->_allocSz.cx < neededSz.cx || this->_allocSz.cy < neededSz.cy)
+		{
+			if (this->_hBmp) {
+				SelectObject(this->_hMemDC, this->_hBmpOld);
+				DeleteObject(this->_hBmp);
+			}
+			this->_hBmp = CreateCompatibleBitmap(hScreenDC, neededSz.cx, neededSz.cy);
+			this->_hBmpOld = reinterpret_cast<HBITMAP>(
+				SelectObject(this->_hMemDC, this->_hBmp));
+			this->_allocSz = neededSz;
+		}
+		return this->_hMemDC;
+	}
+};
+
+
+// Accumulates the dirty sub-rectangles of a custom-drawn control, invalidating
+// only them — a one-cell change in a grid repaints just that cell. Keep one as
+// a member; call mark() whenever a piece changes, and drain() from the WM_PAINT
+// handler to redraw exactly the dirty parts that intersect the invalid area.
+class dirty_region final {
+private:
+	static const size_t _MAX_RECTS = 16; // past this, collapse to the bounding box
+
+	HWND              _hWnd = nullptr;
+	std::vector<RECT> _rects;
+
+public:
+	dirty_region& attach(HWND hWnd) noexcept {
+		this->_hWnd = hWnd;
+		return *this;
+	}
+
+	dirty_region& attach(const wnd* w) noexcept {
+		return this->attach(w->hwnd());
+	}
+
+	bool empty() const noexcept {
+		return this->_rects.empty();
+	}
+
+	// Marks the rectangle dirty and invalidates just it, not the whole client
+	// area; overlapping marks are merged.
+	dirty_region& mark(const RECT& rc) noexcept {
+		RECT rcMerged{};
+		for (RECT& existing : this->_rects) {
+			if (IntersectRect(&rcMerged, &existing, &rc)) { // overlaps, grow in place
+				UnionRect(&existing, &existing, &rc);
+				InvalidateRect(this->_hWnd, &rc, FALSE);
+				return *this;
+			}
+		}
+
+		if (this->_rects.size() >= _MAX_RECTS) { // too fragmented, fold everything
+			RECT rcAll = rc;
+			for (const RECT& existing : this->_rects) {
+				UnionRect(&rcAll, &rcAll, &existing);
+			}
+			this->_rects.clear();
+			this->_rects.emplace_back(rcAll);
+		} else {
+			this->_rects.emplace_back(rc);
+		}
+		InvalidateRect(this->_hWnd, &rc, FALSE);
+		return *this;
+	}
+
+	// Marks the whole client area dirty.
+	dirty_region& mark_all() noexcept {
+		RECT rcClient{};
+		GetClientRect(this->_hWnd, &rcClient);
+		this->_rects.clear();
+		this->_rects.emplace_back(rcClient);
+		InvalidateRect(this->_hWnd, nullptr, FALSE);
+		return *this;
+	}
+
+	// Calls the lambda once per dirty rectangle clipped against the area being
+	// repainted, then forgets the drawn ones. A rectangle fully outside the
+	// invalid area is kept — it's still invalidated OS-side, so the WM_PAINT
+	// that covers it will drain it then.
+	template<typename callbackT>
+	void drain(const dc_painter& painter, callbackT&& drawFunc) {
+		RECT rcClipped{};
+		size_t keptCount = 0;
+		for (size_t i = 0; i < this->_rects.size(); ++i) {
+			if (IntersectRect(&rcClipped, &this->_rects[i], &painter.invalid_rect())) {
+				drawFunc(rcClipped); // draw only this sub-rectangle
+			} else {
+				this->_rects[keptCount++] = this->_rects[i]; // not this paint's business
+			}
+		}
+		this->_rects.resize(keptCount);
+	}
+};
+
+
+// Wrapper to device context, BeginPaint/EndPaint automatically called, painting
+// into a caller-owned back_buffer which is blitted to the screen on destruction.
+// Unlike dc_painter_buffered, no GDI object is created or destroyed per paint.
+// In order to make the double-buffer work, you must return zero on WM_ERASEBKGND.
+class dc_buffered final : public dc_painter {
+public:
+	~dc_buffered() {
+		BitBlt(this->ps().hdc, 0, 0, this->size().cx, this->size().cy,
+			this->_hDC, 0, 0, SRCCOPY); // then dc_painter calls EndPaint
+	}
+
+	dc_buffered(HWND hWnd, back_buffer& buffer) noexcept :
+		dc_painter(hWnd)
+	{
+		this->_hDC = buffer.ensure(this->ps().hdc, this->size()); // overwrite our painting HDC
+		RECT rcClient{0, 0, this->size().cx, this->size().cy};
+		FillRect(this->_hDC, &rcClient,
+			reinterpret_cast<HBRUSH>(GetClassLongPtrW(this->hwnd(), GCLP_HBRBACKGROUND)) );
+	}
+
+	dc_buffered(const wnd* w, back_buffer& buffer) noexcept :
+		dc_buffered(w->hwnd(), buffer) { }
+};
+
 }//namespace gdi
 }//namespace wl
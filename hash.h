@@ -0,0 +1,258 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include "file.h"
+#include <bcrypt.h>
+#pragma comment(lib, "Bcrypt.lib")
+#if defined(_M_IX86) || defined(_M_X64)
+	#include <intrin.h>    // __cpuid
+	#include <nmmintrin.h> // SSE4.2 crc32 instruction
+#endif
+
+namespace wl {
+
+// Checksum and hash engines with a streaming interface: feed update() from
+// file_mapped views, file::read_chunks callbacks or download sinks, then call
+// finish once. One-call helpers stream whole files with double-buffered reads,
+// so hashing overlaps the disk instead of waiting on it.
+namespace hash {
+
+// Streaming CRC32-C (Castagnoli polynomial): the hardware crc32 instruction
+// where the CPU reports SSE4.2, a lookup table otherwise. Note this is the
+// iSCSI/ext4 polynomial, not the zip/zlib one — the two aren't comparable.
+class crc32c final {
+private:
+	UINT32 _state = 0xFFFFFFFF;
+
+public:
+	crc32c& update(const BYTE* pData, size_t sz) noexcept {
+		size_t i = 0;
+#if defined(_M_X64)
+		if (_has_sse42()) {
+			UINT64 st = this->_state;
+			for (; i + 8 <= sz; i += 8) {
+				UINT64 chunk;
+				memcpy(&chunk, pData + i, 8); // alignment-safe load
+				st = _mm_crc32_u64(st, chunk);
+			}
+			this->_state = static_cast<UINT32>(st);
+			for (; i < sz; ++i) {
+				this->_state = _mm_crc32_u8(this->_state, pData[i]);
+			}
+			return *this;
+		}
+#elif defined(_M_IX86)
+		if (_has_sse42()) {
+			for (; i + 4 <= sz; i += 4) {
+				UINT32 chunk;
+				memcpy(&chunk, pData + i, 4);
+				this->_state = _mm_crc32_u32(this->_state, chunk);
+			}
+			for (; i < sz; ++i) {
+				this->_state = _mm_crc32_u8(this->_state, pData[i]);
+			}
+			return *this;
+		}
+#endif
+		const UINT32* table = _sw_table();
+		for (; i < sz; ++i) {
+			this->_state = table[(this->_state ^ pData[i]) & 0xFF] ^ (this->_state >> 8);
+		}
+		return *this;
+	}
+
+	crc32c& update(const std::vector<BYTE>& data) noexcept {
+		return this->update(data.empty() ? nullptr : &data[0], data.size());
+	}
+
+	// Returns the checksum of everything fed so far; the engine can keep going.
+	UINT32 value() const noexcept {
+		return ~this->_state;
+	}
+
+	crc32c& reset() noexcept {
+		this->_state = 0xFFFFFFFF;
+		return *this;
+	}
+
+	// One-shot checksum of a memory block.
+	static UINT32 of(const BYTE* pData, size_t sz) noexcept {
+		return crc32c{}.update(pData, sz).value();
+	}
+
+	static UINT32 of(const std::vector<BYTE>& data) noexcept {
+		return crc32c{}.update(data).value();
+	}
+
+private:
+	static bool _has_sse42() noexcept {
+#if defined(_M_IX86) || defined(_M_X64)
+		static const bool has = []() noexcept -> bool {
+			int regs[4]{};
+			__cpuid(regs, 1);
+			return (regs[2] & (1 << 20)) != 0; // ECX bit 20 = SSE4.2
+		}();
+		return has;
+#else
+		return false;
+#endif
+	}
+
+	// 256-entry Castagnoli table, built once; only the non-SSE4.2 path uses it.
+	static const UINT32* _sw_table() noexcept {
+		static const struct _table final {
+			UINT32 entries[256];
+			_table() noexcept {
+				for (UINT32 n = 0; n < 256; ++n) {
+					UINT32 c = n;
+					for (int k = 0; k < 8; ++k) {
+						c = (c & 1) ? (0x82F63B78 ^ (c >> 1)) : (c >> 1);
+					}
+					this->entries[n] = c;
+				}
+			}
+		} table;
+		return table.entries;
+	}
+};
+
+
+// Streaming SHA-256 over CNG: update() any number of times, finish() once.
+// The algorithm provider is opened per engine and the hash object is placed in
+// a member buffer, so a long-lived engine re-used across files costs no
+// further provider round trips — finish() leaves it ready for the next stream.
+class sha256 final {
+private:
+	BCRYPT_ALG_HANDLE  _hAlg = nullptr;
+	BCRYPT_HASH_HANDLE _hHash = nullptr;
+	std::vector<BYTE>  _hashObj; // CNG-owned working state lives here
+
+public:
+	~sha256() {
+		if (this->_hHash) BCryptDestroyHash(this->_hHash);
+		if (this->_hAlg) BCryptCloseAlgorithmProvider(this->_hAlg, 0);
+	}
+
+	sha256() {
+		NTSTATUS st = BCryptOpenAlgorithmProvider(&this->_hAlg,
+			BCRYPT_SHA256_ALGORITHM, nullptr, 0);
+		if (st < 0) {
+			throw std::system_error(st, std::system_category(),
+				"BCryptOpenAlgorithmProvider failed for SHA-256");
+		}
+
+		DWORD objLen = 0, cbGot = 0;
+		BCryptGetProperty(this->_hAlg, BCRYPT_OBJECT_LENGTH,
+			reinterpret_cast<BYTE*>(&objLen), sizeof(objLen), &cbGot, 0);
+		this->_hashObj.resize(objLen);
+		this->_create_hash();
+	}
+
+	sha256(sha256&& other) noexcept { this->operator=(std::move(other)); }
+
+	sha256& operator=(sha256&& other) noexcept {
+		std::swap(this->_hAlg, other._hAlg);
+		std::swap(this->_hHash, other._hHash);
+		std::swap(this->_hashObj, other._hashObj);
+		return *this;
+	}
+
+	sha256& update(const BYTE* pData, size_t sz) {
+		NTSTATUS st = BCryptHashData(this->_hHash,
+			const_cast<BYTE*>(pData), static_cast<ULONG>(sz), 0);
+		if (st < 0) {
+			throw std::system_error(st, std::system_category(),
+				"BCryptHashData failed");
+		}
+		return *this;
+	}
+
+	sha256& update(const std::vector<BYTE>& data) {
+		return this->update(data.empty() ? nullptr : &data[0], data.size());
+	}
+
+	// Returns the 32-byte digest and resets the engine for the next run.
+	std::vector<BYTE> finish() {
+		std::vector<BYTE> digest(32);
+		NTSTATUS st = BCryptFinishHash(this->_hHash, &digest[0],
+			static_cast<ULONG>(digest.size()), 0);
+		if (st < 0) {
+			throw std::system_error(st, std::system_category(),
+				"BCryptFinishHash failed");
+		}
+		BCryptDestroyHash(this->_hHash);
+		this->_hHash = nullptr;
+		this->_create_hash(); // ready for the next stream
+		return digest;
+	}
+
+	// Returns the digest as a lowercase hex string and resets the engine.
+	std::wstring finish_hex() {
+		return to_hex(this->finish());
+	}
+
+	// Renders a digest as lowercase hex.
+	static std::wstring to_hex(const std::vector<BYTE>& digest) {
+		static const wchar_t nibbles[] = L"0123456789abcdef";
+		std::wstring ret;
+		ret.reserve(digest.size() * 2);
+		for (BYTE b : digest) {
+			ret += nibbles[b >> 4];
+			ret += nibbles[b & 0x0F];
+		}
+		return ret;
+	}
+
+private:
+	void _create_hash() {
+		NTSTATUS st = BCryptCreateHash(this->_hAlg, &this->_hHash,
+			this->_hashObj.empty() ? nullptr : &this->_hashObj[0],
+			static_cast<ULONG>(this->_hashObj.size()), nullptr, 0, 0);
+		if (st < 0) {
+			throw std::system_error(st, std::system_category(),
+				"BCryptCreateHash failed");
+		}
+	}
+};
+
+
+// Hashes a whole file with SHA-256, streaming it through read_chunks on an
+// overlapped handle: the next chunk is read while the current one is hashed,
+// so the digest arrives at disk speed with two chunk buffers of memory.
+inline std::vector<BYTE> sha256_of_file(const std::wstring& filePath,
+	size_t chunkSize = 1024 * 1024)
+{
+	file fin;
+	fin.open_existing_overlapped(filePath, file::access::READONLY);
+	sha256 engine;
+	fin.read_chunks(chunkSize,
+		[&engine](const BYTE* pData, size_t sz, size_t) -> bool {
+			engine.update(pData, sz);
+			return true;
+		});
+	return engine.finish();
+}
+
+// Checksums a whole file with CRC32-C, same overlapped streaming as
+// sha256_of_file.
+inline UINT32 crc32c_of_file(const std::wstring& filePath,
+	size_t chunkSize = 1024 * 1024)
+{
+	file fin;
+	fin.open_existing_overlapped(filePath, file::access::READONLY);
+	crc32c engine;
+	fin.read_chunks(chunkSize,
+		[&engine](const BYTE* pData, size_t sz, size_t) -> bool {
+			engine.update(pData, sz);
+			return true;
+		});
+	return engine.value();
+}
+
+}//namespace hash
+}//namespace wl
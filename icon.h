@@ -6,12 +6,143 @@
  */
 
 #pragma once
+#include <mutex>
+#include <string>
+#include <vector>
 #include <Windows.h>
 #include <CommCtrl.h>
 #include <commoncontrols.h> // IID_IImageList
 #include "com.h"
 
 namespace wl {
+namespace _wli {
+
+// Process-wide cache of the icons Windows Explorer uses for file types, keyed
+// by (extension, SHIL resolution). SHGetFileInfo runs once per distinct key;
+// every further request is a map hit. The cache owns the master handles for
+// the process lifetime; callers wanting ownership must CopyIcon them.
+class shell_icon_cache final {
+private:
+	struct _entry final {
+		std::wstring ext; // lowercased, without the dot
+		int          shilRes = 0;
+		HICON        hIcon = nullptr;
+	};
+
+	std::vector<_entry> _entries; // file managers use a few dozen types, linear scan is fine
+	std::mutex          _mtx;
+
+public:
+	static shell_icon_cache& instance() noexcept {
+		static shell_icon_cache obj; // thread-safe in C++11
+		return obj;
+	}
+
+	// Returns the shared icon of the file type, loading it from the shell only
+	// on the first request. Pass an empty extension for the generic file icon.
+	// Don't destroy the returned handle, it belongs to the cache.
+	HICON get_or_load(const wchar_t* fileExtension, int shilRes) {
+		std::wstring ext = fileExtension;
+		if (!ext.empty() && ext[0] == L'.') ext.erase(0, 1);
+		CharLowerBuffW(&ext[0], static_cast<DWORD>(ext.length()));
+
+		std::lock_guard<std::mutex> lock{this->_mtx};
+
+		for (const _entry& e : this->_entries) {
+			if (e.shilRes == shilRes && e.ext == ext) {
+				return e.hIcon; // warm hit, no shell call
+			}
+		}
+
+		HICON hIcon = _load_from_shell(ext, shilRes);
+		this->_entries.push_back({std::move(ext), shilRes, hIcon});
+		return hIcon;
+	}
+
+private:
+	static HICON _load_from_shell(const std::wstring& ext, int shilRes) {
+		std::wstring spec = ext.empty() ? L"*" : (L"*." + ext);
+
+		com::lib comLib{com::lib::init::NOW};
+		SHFILEINFO shfi{};
+
+		if (shilRes == SHIL_SMALL || shilRes == SHIL_LARGE) { // http://stackoverflow.com/a/28015423
+			DWORD_PTR gfiOk = SHGetFileInfoW(spec.c_str(), FILE_ATTRIBUTE_NORMAL, &shfi, sizeof(shfi),
+				SHGFI_USEFILEATTRIBUTES | SHGFI_ICON |
+				(shilRes == SHIL_SMALL ? SHGFI_SMALLICON : SHGFI_LARGEICON));
+			if (!gfiOk) {
+				throw std::system_error(GetLastError(), std::system_category(),
+					"SHGetFileInfo failed when trying to load icon from shell");
+			}
+			return shfi.hIcon;
+		}
+
+		IImageList* pImgList = nullptr; // http://stackoverflow.com/a/30496252
+		com::check_hr(
+			SHGetImageList(shilRes, IID_IImageList, reinterpret_cast<void**>(&pImgList)),
+			"SHGetImageList failed when trying to load icon from shell");
+
+		DWORD_PTR gfiOk = SHGetFileInfoW(spec.c_str(), FILE_ATTRIBUTE_NORMAL, &shfi, sizeof(shfi),
+			SHGFI_USEFILEATTRIBUTES | SHGFI_SYSICONINDEX);
+		if (!gfiOk) {
+			throw std::system_error(GetLastError(), std::system_category(),
+				"SHGetFileInfo failed when trying to load system's image list");
+		}
+		return ImageList_GetIcon(reinterpret_cast<HIMAGELIST>(pImgList),
+			shfi.iIcon, ILD_NORMAL);
+	}
+};
+
+// Process-wide cache of icons decoded from module resources, keyed by
+// (module, resource id, resolution). Each distinct glyph is decoded by
+// LoadImage once; every image list adding the same resource icon at the same
+// size copies from one master handle. The cache owns the handles for the
+// process lifetime; don't destroy what get_or_load() returns.
+class icon_res_cache final {
+private:
+	struct _entry final {
+		HINSTANCE hInst = nullptr;
+		int       iconId = 0;
+		SIZE      resolution{};
+		HICON     hIcon = nullptr;
+	};
+
+	std::vector<_entry> _entries; // toolbars reference a few hundred glyphs at most, linear scan is fine
+	std::mutex          _mtx;
+
+public:
+	static icon_res_cache& instance() noexcept {
+		static icon_res_cache obj; // thread-safe in C++11
+		return obj;
+	}
+
+	// Returns the shared icon, decoding the resource only on the first request
+	// for this (module, id, size) triple.
+	HICON get_or_load(int iconId, SIZE resolution, HINSTANCE hInst = nullptr) {
+		if (!hInst) hInst = GetModuleHandleW(nullptr);
+		std::lock_guard<std::mutex> lock{this->_mtx};
+
+		for (const _entry& e : this->_entries) {
+			if (e.hInst == hInst && e.iconId == iconId &&
+				e.resolution.cx == resolution.cx && e.resolution.cy == resolution.cy)
+			{
+				return e.hIcon; // warm hit, no decode
+			}
+		}
+
+		HICON hIcon = static_cast<HICON>(LoadImageW(hInst, MAKEINTRESOURCEW(iconId),
+			IMAGE_ICON, static_cast<int>(resolution.cx), static_cast<int>(resolution.cy),
+			LR_DEFAULTCOLOR));
+		if (!hIcon) {
+			throw std::system_error(GetLastError(), std::system_category(),
+				"LoadImage failed when trying to load icon resource into cache");
+		}
+		this->_entries.push_back({hInst, iconId, resolution, hIcon});
+		return hIcon;
+	}
+};
+
+}//namespace _wli
 
 // Wrapper to HICON handle.
 class icon final {
@@ -70,41 +201,15 @@ public:
 	}
 
 	// Loads the icon used by Windows Explorer to represent the given file type.
+	// Served from the process-wide shell icon cache: only the first request per
+	// (extension, resolution) actually hits the shell.
 	icon& load_from_shell(const wchar_t* fileExtension, res resolution) {
 		this->destroy();
-		wchar_t extens[16]{}; // arbitrary length
-		lstrcpyW(extens, (fileExtension[0] == L'.') ? L"*" : L"*."); // prepend dot if it doesn't have
-		lstrcatW(extens, fileExtension);
-
-		com::lib comLib{com::lib::init::NOW};
-		SHFILEINFO shfi{};
-
-		if (resolution == res::SMALL16 || resolution == res::LARGE32) { // http://stackoverflow.com/a/28015423
-			DWORD_PTR gfiOk = SHGetFileInfoW(extens, FILE_ATTRIBUTE_NORMAL, &shfi, sizeof(shfi),
-				SHGFI_USEFILEATTRIBUTES | SHGFI_ICON |
-				(resolution == res::SMALL16 ? SHGFI_SMALLICON : SHGFI_LARGEICON));
-			if (!gfiOk) {
-				throw std::system_error(GetLastError(), std::system_category(),
-					"SHGetFileInfo failed when trying to load icon from shell");
-			}
-			this->_hIcon = shfi.hIcon;
-		} else if (resolution != res::OTHER) {
-			IImageList* pImgList = nullptr; // http://stackoverflow.com/a/30496252
-			com::check_hr(
-				SHGetImageList(static_cast<int>(resolution),
-					IID_IImageList, reinterpret_cast<void**>(&pImgList)),
-				"SHGetImageList failed when trying to load icon from shell");
-
-			DWORD_PTR gfiOk = SHGetFileInfoW(extens, FILE_ATTRIBUTE_NORMAL, &shfi, sizeof(shfi),
-				SHGFI_USEFILEATTRIBUTES | SHGFI_SYSICONINDEX);
-			if (!gfiOk) {
-				throw std::system_error(GetLastError(), std::system_category(),
-					"SHGetFileInfo failed when trying to load system's image list");
-			}
-			this->_hIcon = ImageList_GetIcon(reinterpret_cast<HIMAGELIST>(pImgList),
-				shfi.iIcon, ILD_NORMAL);
+		if (resolution != res::OTHER) {
+			HICON hShared = _wli::shell_icon_cache::instance().get_or_load(
+				fileExtension, static_cast<int>(resolution));
+			this->_hIcon = CopyIcon(hShared); // cheap; keeps this instance owning its handle
 		}
-
 		return *this;
 	}
 
@@ -6,6 +6,7 @@
  */
 
 #pragma once
+#include <utility>
 #include "icon.h"
 
 namespace wl {
@@ -15,6 +16,10 @@ class image_list final {
 private:
 	HIMAGELIST _hImgList = nullptr;
 
+	// Slots filled through load_shared_from_resource(), so a glyph repeated
+	// across toolbar buttons occupies one image list entry instead of many.
+	std::vector<std::pair<HICON, int>> _sharedSlots;
+
 public:
 	~image_list() {
 		// Image lists are destroyed automatically in some cases,
@@ -25,7 +30,8 @@ public:
 	}
 
 	image_list() = default;
-	image_list(image_list&& other) noexcept : _hImgList{other._hImgList} { other._hImgList = nullptr; }
+	image_list(image_list&& other) noexcept :
+		_hImgList{other._hImgList}, _sharedSlots{std::move(other._sharedSlots)} { other._hImgList = nullptr; }
 
 	// Returns the handle to the image list.
 	HIMAGELIST himagelist() const noexcept {
@@ -35,6 +41,7 @@ public:
 	image_list& operator=(image_list&& other) noexcept {
 		this->destroy();
 		std::swap(this->_hImgList, other._hImgList);
+		this->_sharedSlots.swap(other._sharedSlots);
 		return *this;
 	}
 
@@ -43,6 +50,7 @@ public:
 			ImageList_Destroy(this->_hImgList);
 			this->_hImgList = nullptr;
 		}
+		this->_sharedSlots.clear();
 		return *this;
 	}
 
@@ -74,11 +82,12 @@ public:
 		return this->load(ico.hicon());
 	}
 
-	// Loads an icon from resource into the image list.
+	// Loads an icon from resource into the image list. Decoding goes through the
+	// process-wide resource icon cache, so the same icon loaded into several
+	// lists is decoded once; the entry appended here is still this list's own.
 	image_list& load_from_resource(int iconId, HINSTANCE hInst = nullptr) {
-		icon tmpIco;
-		tmpIco.load_from_resource(iconId, this->resolution(), hInst);
-		return this->load(tmpIco);
+		return this->load(
+			_wli::icon_res_cache::instance().get_or_load(iconId, this->resolution(), hInst));
 	}
 
 	// Loads an icon from resource into the image list.
@@ -101,6 +110,67 @@ public:
 			reinterpret_cast<HINSTANCE>(GetWindowLongPtrW(hParent, GWLP_HINSTANCE)));
 	}
 
+	// Like load_from_resource(), but deduplicated: if this icon is already in
+	// the list through a previous shared load, its existing index is returned
+	// and no new entry is appended. Repeated glyphs across a large toolbar set
+	// then cost one entry each instead of one per button. Returns the index
+	// the glyph occupies in this list.
+	size_t load_shared_from_resource(int iconId, HINSTANCE hInst = nullptr) {
+		if (!this->_hImgList) {
+			throw std::logic_error("Can't add icon before create image list.");
+		}
+		HICON hShared = _wli::icon_res_cache::instance().get_or_load(
+			iconId, this->resolution(), hInst);
+
+		for (const std::pair<HICON, int>& slot : this->_sharedSlots) {
+			if (slot.first == hShared) {
+				return static_cast<size_t>(slot.second); // glyph already present
+			}
+		}
+		int newIndex = ImageList_AddIcon(this->_hImgList, hShared);
+		this->_sharedSlots.emplace_back(hShared, newIndex);
+		return static_cast<size_t>(newIndex);
+	}
+
+	// Like load_shared_from_resource(), but resolving the module from a window.
+	size_t load_shared_from_resource(int iconId, HWND hParent) {
+		return this->load_shared_from_resource(iconId,
+			reinterpret_cast<HINSTANCE>(GetWindowLongPtrW(hParent, GWLP_HINSTANCE)));
+	}
+
+	// Adds every cell of a horizontal strip bitmap in one ImageList_Add call;
+	// the image count is the strip width divided by the cell width set at
+	// create(). One decoded bitmap replaces one icon load per glyph, which is
+	// the cheap way to populate a large toolbar set at startup.
+	image_list& load_strip(HBITMAP hbmStrip) {
+		if (!this->_hImgList) {
+			throw std::logic_error("Can't add strip before create image list.");
+		}
+		if (ImageList_Add(this->_hImgList, hbmStrip, nullptr) == -1) {
+			throw std::system_error(GetLastError(), std::system_category(),
+				"ImageList_Add failed when trying to add strip bitmap");
+		}
+		return *this;
+	}
+
+	// Loads a strip bitmap from resource and adds all its cells at once.
+	// Pass a mask color to have that color rendered transparent.
+	image_list& load_strip_from_resource(int bitmapId, HINSTANCE hInst = nullptr) {
+		HBITMAP hbm = this->_load_strip_bitmap(bitmapId, hInst);
+		ImageList_Add(this->_hImgList, hbm, nullptr);
+		DeleteObject(hbm);
+		return *this;
+	}
+
+	// Loads a strip bitmap from resource and adds all its cells at once,
+	// rendering the given color transparent.
+	image_list& load_strip_from_resource(int bitmapId, COLORREF maskColor, HINSTANCE hInst = nullptr) {
+		HBITMAP hbm = this->_load_strip_bitmap(bitmapId, hInst);
+		ImageList_AddMasked(this->_hImgList, hbm, maskColor);
+		DeleteObject(hbm);
+		return *this;
+	}
+
 	// Loads the icon used by Windows Explorer to represent the given file type.
 	image_list& load_from_shell(const wchar_t* fileExtension) {
 		icon::res iRes = icon::util::resolve_resolution_type(this->resolution());
@@ -134,6 +204,21 @@ public:
 	size_t size() const noexcept {
 		return this->_hImgList ? ImageList_GetImageCount(this->_hImgList) : 0;
 	}
+
+private:
+	HBITMAP _load_strip_bitmap(int bitmapId, HINSTANCE hInst) {
+		if (!this->_hImgList) {
+			throw std::logic_error("Can't add strip before create image list.");
+		}
+		HBITMAP hbm = static_cast<HBITMAP>(LoadImageW(
+			hInst ? hInst : GetModuleHandleW(nullptr), MAKEINTRESOURCEW(bitmapId),
+			IMAGE_BITMAP, 0, 0, LR_CREATEDIBSECTION)); // DIB keeps 32bpp strips intact
+		if (!hbm) {
+			throw std::system_error(GetLastError(), std::system_category(),
+				"LoadImage failed when trying to load strip bitmap resource");
+		}
+		return hbm;
+	}
 };
 
 }//namespace wl
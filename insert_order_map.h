@@ -6,7 +6,10 @@
  */
 
 #pragma once
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
+#include "wstr_view.h"
 
 namespace wl {
 
@@ -26,19 +29,38 @@ public:
 private:
 	std::vector<entry> _entries;
 
+	// Hash index over _entries, built lazily on the first lookup and invalidated
+	// whenever the entries vector is structurally modified. Iteration still walks
+	// _entries, so the insertion order visible to serialization is unchanged.
+	mutable std::unordered_map<keyT, size_t> _index;
+	mutable bool                             _indexDirty = true;
+
 public:
 	insert_order_map() = default;
-	insert_order_map(insert_order_map&& other) noexcept : _entries{std::move(other._entries)} { }
 	insert_order_map(std::initializer_list<entry> entries) : _entries{entries} { }
 
+	insert_order_map(insert_order_map&& other) noexcept : _entries{std::move(other._entries)} {
+		other._index.clear(); // its positions describe entries that just moved away
+		other._indexDirty = true;
+	}
+
 	size_t            size() const noexcept      { return this->_entries.size(); }
 	bool              empty() const noexcept     { return this->_entries.empty(); }
-	insert_order_map& clear() noexcept           { this->_entries.clear(); return *this; }
 	insert_order_map& reserve(size_t numEntries) { this->_entries.reserve(numEntries); return *this; }
 
+	insert_order_map& clear() noexcept {
+		this->_entries.clear();
+		this->_index.clear();
+		this->_indexDirty = true;
+		return *this;
+	}
+
 	insert_order_map& operator=(insert_order_map&& other) noexcept {
-		this->empty();
 		this->_entries.swap(other._entries);
+		this->_index.clear();
+		this->_indexDirty = true; // rebuilt on next lookup
+		other._index.clear(); // the swap left it holding our old entries
+		other._indexDirty = true;
 		return *this;
 	}
 
@@ -54,6 +76,9 @@ public:
 		typename std::vector<entry>::iterator ite = this->_find(key);
 		if (ite == this->_entries.end()) {
 			this->_entries.emplace_back(key); // inexistent, so add
+			if (!this->_indexDirty) { // keep the index valid incrementally, appends don't shift positions
+				this->_index.emplace(key, this->_entries.size() - 1);
+			}
 			return this->_entries.back().value;
 		}
 		return ite->value;
@@ -79,31 +104,65 @@ public:
 		return this->_find(key) != this->_entries.cend();
 	}
 
+	// Slice lookups for wstring-keyed maps: the hash index can only probe with
+	// its own key type, so the view is staged through a per-thread key whose
+	// capacity is reused — probing with slices of a parsed buffer stops
+	// allocating once warm, instead of building a fresh wstring per lookup.
+	template<typename T = keyT,
+		typename = typename std::enable_if<std::is_same<T, std::wstring>::value>::type>
+	const valueT* get_if_exists(wstr_view key) const noexcept {
+		thread_local std::wstring probe;
+		probe.assign(key.data(), key.length());
+		return this->get_if_exists(probe);
+	}
+
+	template<typename T = keyT,
+		typename = typename std::enable_if<std::is_same<T, std::wstring>::value>::type>
+	valueT* get_if_exists(wstr_view key) noexcept {
+		thread_local std::wstring probe;
+		probe.assign(key.data(), key.length());
+		return this->get_if_exists(probe);
+	}
+
+	template<typename T = keyT,
+		typename = typename std::enable_if<std::is_same<T, std::wstring>::value>::type>
+	bool has(wstr_view key) const noexcept {
+		thread_local std::wstring probe;
+		probe.assign(key.data(), key.length());
+		return this->has(probe);
+	}
+
 	insert_order_map& remove(const keyT& key) {
 		typename std::vector<entry>::iterator ite = this->_find(key);
 		if (ite != this->_entries.end()) { // won't fail if inexistent
 			this->_entries.erase(ite);
+			this->_indexDirty = true; // positions after the erased entry shifted
 		}
 		return *this;
 	}
 
 private:
 	typename std::vector<entry>::const_iterator _find(const keyT& key) const noexcept {
-		for (typename std::vector<entry>::const_iterator ite = this->_entries.cbegin();
-			ite != this->_entries.cend(); ++ite)
-		{
-			if (ite->key == key) return ite;
-		}
-		return this->_entries.cend();
+		if (this->_indexDirty) this->_rebuild_index();
+		typename std::unordered_map<keyT, size_t>::const_iterator idx = this->_index.find(key);
+		return idx == this->_index.cend() ?
+			this->_entries.cend() : this->_entries.cbegin() + idx->second;
 	}
 
 	typename std::vector<entry>::iterator _find(const keyT& key) noexcept {
-		for (typename std::vector<entry>::iterator ite = this->_entries.begin();
-			ite != this->_entries.end(); ++ite)
-		{
-			if (ite->key == key) return ite;
+		if (this->_indexDirty) this->_rebuild_index();
+		typename std::unordered_map<keyT, size_t>::const_iterator idx = this->_index.find(key);
+		return idx == this->_index.cend() ?
+			this->_entries.end() : this->_entries.begin() + idx->second;
+	}
+
+	void _rebuild_index() const noexcept {
+		this->_index.clear();
+		this->_index.reserve(this->_entries.size());
+		for (size_t i = 0; i < this->_entries.size(); ++i) {
+			this->_index.emplace(this->_entries[i].key, i); // 1st occurrence wins, same as the old linear scan
 		}
-		return this->_entries.end();
+		this->_indexDirty = false;
 	}
 
 private:
@@ -0,0 +1,106 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#ifdef WINLAMB_PROFILE_ALLOC // opt-in; without the define only the no-op macro below exists
+
+#include <atomic>
+#include <cwchar>
+#include <string>
+#include <Windows.h>
+
+namespace wl {
+namespace _wli {
+
+// Counts the library's internal allocations per subsystem, so heap traffic
+// can be attributed to specific headers and fixes verified with numbers.
+// Only compiled when WINLAMB_PROFILE_ALLOC is defined; instrumented call
+// sites go through the WINLAMB_COUNT_ALLOC macro, which vanishes otherwise.
+// Counters are relaxed atomics — totals, not a happens-before tool.
+class alloc_profiler final {
+public:
+	enum class subsystem : int {
+		STORE,    // handler registration and dispatch indexes
+		STR,      // string formatting and conversions
+		LISTVIEW, // cell text fetch buffers
+		DOWNLOAD, // response body growth
+		OTHER,
+		_COUNT
+	};
+
+private:
+	struct _slot final {
+		std::atomic<long long> count{0};
+		std::atomic<long long> bytes{0};
+	};
+
+	_slot _slots[static_cast<int>(subsystem::_COUNT)];
+
+	alloc_profiler() = default;
+
+public:
+	alloc_profiler(const alloc_profiler&) = delete;
+	alloc_profiler& operator=(const alloc_profiler&) = delete; // non-copyable, non-movable
+
+	static alloc_profiler& instance() noexcept {
+		static alloc_profiler obj; // thread-safe in C++11
+		return obj;
+	}
+
+	void record(subsystem sub, size_t numBytes) noexcept {
+		_slot& s = this->_slots[static_cast<int>(sub)];
+		s.count.fetch_add(1, std::memory_order_relaxed);
+		s.bytes.fetch_add(static_cast<long long>(numBytes), std::memory_order_relaxed);
+	}
+
+	long long count_of(subsystem sub) const noexcept {
+		return this->_slots[static_cast<int>(sub)].count.load(std::memory_order_relaxed);
+	}
+
+	long long bytes_of(subsystem sub) const noexcept {
+		return this->_slots[static_cast<int>(sub)].bytes.load(std::memory_order_relaxed);
+	}
+
+	void reset() noexcept {
+		for (_slot& s : this->_slots) {
+			s.count.store(0, std::memory_order_relaxed);
+			s.bytes.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	// Returns the per-subsystem totals as a printable table, ready for
+	// OutputDebugString or a log file. Formats into a local buffer instead of
+	// going through str_priv, so dumping doesn't bump the str counter itself.
+	std::wstring dump() const {
+		static const wchar_t* names[] = {L"store", L"str", L"listview", L"download", L"other"};
+
+		std::wstring ret = L"subsystem      allocs        bytes\n";
+		for (int i = 0; i < static_cast<int>(subsystem::_COUNT); ++i) {
+			wchar_t line[64]{};
+			std::swprintf(line, 64, L"%-10s %10lld %12lld\n",
+				names[i], this->count_of(static_cast<subsystem>(i)),
+				this->bytes_of(static_cast<subsystem>(i)));
+			ret.append(line);
+		}
+		return ret;
+	}
+};
+
+}//namespace _wli
+}//namespace wl
+
+// Tags one internal allocation at the call site; compiled out entirely when
+// WINLAMB_PROFILE_ALLOC is not defined.
+#define WINLAMB_COUNT_ALLOC(subsysTag, numBytes) \
+	(wl::_wli::alloc_profiler::instance().record( \
+		wl::_wli::alloc_profiler::subsystem::subsysTag, (numBytes)))
+
+#else
+
+#define WINLAMB_COUNT_ALLOC(subsysTag, numBytes) ((void)0)
+
+#endif//WINLAMB_PROFILE_ALLOC
@@ -6,13 +6,73 @@
  */
 
 #pragma once
+#include <mutex>
+#include <vector>
 #include "base_msg.h"
 #include "base_scroll.h"
+#include "startup_profiler.h"
 #include "../font.h"
 
 namespace wl {
 namespace _wli {
 
+// Process-wide cache of locked dialog template resources, keyed by module and
+// resource id. The template is found, loaded and locked once; subsequent
+// instances of the same dialog go through the indirect creation APIs with the
+// cached in-memory template, skipping the resource lookup on every open.
+// Resource pointers stay valid for the module's lifetime, so entries are
+// never evicted.
+class dlgtemplate_cache final {
+private:
+	struct _entry final {
+		HINSTANCE          hInst = nullptr;
+		int                dialogId = 0;
+		const DLGTEMPLATE* pTemplate = nullptr;
+	};
+
+	std::vector<_entry> _entries;
+	std::mutex          _entriesMutex;
+
+	dlgtemplate_cache() = default;
+
+public:
+	dlgtemplate_cache(const dlgtemplate_cache&) = delete;
+	dlgtemplate_cache& operator=(const dlgtemplate_cache&) = delete;
+
+	static dlgtemplate_cache& instance() {
+		static dlgtemplate_cache obj; // thread-safe in C++11
+		return obj;
+	}
+
+	const DLGTEMPLATE* get(HINSTANCE hInst, int dialogId) {
+		std::lock_guard<std::mutex> lock(this->_entriesMutex);
+		for (const _entry& e : this->_entries) { // a handful of dialog ids, linear is fine
+			if (e.hInst == hInst && e.dialogId == dialogId) {
+				return e.pTemplate;
+			}
+		}
+
+		HRSRC hRes = FindResourceW(hInst, MAKEINTRESOURCEW(dialogId), RT_DIALOG);
+		if (!hRes) {
+			throw std::system_error(GetLastError(), std::system_category(),
+				"FindResource failed for dialog template");
+		}
+		HGLOBAL hGlob = LoadResource(hInst, hRes);
+		if (!hGlob) {
+			throw std::system_error(GetLastError(), std::system_category(),
+				"LoadResource failed for dialog template");
+		}
+		const DLGTEMPLATE* pTemplate = reinterpret_cast<const DLGTEMPLATE*>(LockResource(hGlob));
+		if (!pTemplate) {
+			throw std::system_error(GetLastError(), std::system_category(),
+				"LockResource failed for dialog template");
+		}
+
+		this->_entries.push_back({hInst, dialogId, pTemplate});
+		return pTemplate;
+	}
+};
+
 // Common ground to all dialog windows.
 class base_dialog final {
 public:
@@ -35,29 +95,35 @@ public:
 	base_dialog(HWND& hWnd, base_msg<INT_PTR>& baseMsg) noexcept :
 		_hWnd(hWnd), _baseMsg(baseMsg) { }
 
-	// Wrapper to CreateDialogParam.
+	// Wrapper to CreateDialogIndirectParam, over the cached resource template.
 	HWND create_dialog_param(const setup_vars& setup, HWND hParent) {
 		this->_basic_initial_checks(setup);
-		return CreateDialogParamW(
-			hParent ?
-				reinterpret_cast<HINSTANCE>(GetWindowLongPtrW(hParent, GWLP_HINSTANCE)) :
-				GetModuleHandle(nullptr),
-			MAKEINTRESOURCEW(setup.dialogId), hParent, _dialog_proc,
-			reinterpret_cast<LPARAM>(this));
+		// The dialog resource id identifies the window class; instances beyond
+		// the first reuse the dispatch index built by the first one.
+		this->_baseMsg.adopt_class_layout(static_cast<size_t>(setup.dialogId));
+		HINSTANCE hInst = _creation_hinst(hParent);
+		return CreateDialogIndirectParamW(hInst,
+			dlgtemplate_cache::instance().get(hInst, setup.dialogId),
+			hParent, _dialog_proc, reinterpret_cast<LPARAM>(this));
 	}
 
-	// Wrapper to DialogBoxParam.
+	// Wrapper to DialogBoxIndirectParam, over the cached resource template.
 	INT_PTR dialog_box_param(const setup_vars& setup, HWND hParent) {
 		this->_basic_initial_checks(setup);
-		return DialogBoxParamW(
-			hParent ?
-				reinterpret_cast<HINSTANCE>(GetWindowLongPtrW(hParent, GWLP_HINSTANCE)) :
-				GetModuleHandle(nullptr),
-			MAKEINTRESOURCEW(setup.dialogId), hParent, _dialog_proc,
-			reinterpret_cast<LPARAM>(this));
+		this->_baseMsg.adopt_class_layout(static_cast<size_t>(setup.dialogId));
+		HINSTANCE hInst = _creation_hinst(hParent);
+		return DialogBoxIndirectParamW(hInst,
+			dlgtemplate_cache::instance().get(hInst, setup.dialogId),
+			hParent, _dialog_proc, reinterpret_cast<LPARAM>(this));
 	}
 
 private:
+	static HINSTANCE _creation_hinst(HWND hParent) noexcept {
+		return hParent ?
+			reinterpret_cast<HINSTANCE>(GetWindowLongPtrW(hParent, GWLP_HINSTANCE)) :
+			GetModuleHandle(nullptr);
+	}
+
 	void _basic_initial_checks(const setup_vars& setup) const {
 		if (this->_hWnd) {
 			throw std::logic_error("Tried to create dialog twice.");
@@ -76,6 +142,10 @@ private:
 			SetWindowLongPtrW(hDlg, DWLP_USER, reinterpret_cast<LONG_PTR>(pSelf));
 			font::util::set_ui_on_children(hDlg); // if user creates controls manually, font must be set manually on them
 			pSelf->_hWnd = hDlg; // store HWND
+			startup_profiler::instance().mark(L"first-window-created");
+		} else if (msg == WM_PAINT) {
+			startup_profiler::instance().mark(L"first-paint"); // no-op after the first
+			pSelf = reinterpret_cast<base_dialog*>(GetWindowLongPtrW(hDlg, DWLP_USER));
 		} else {
 			pSelf = reinterpret_cast<base_dialog*>(GetWindowLongPtrW(hDlg, DWLP_USER));
 		}
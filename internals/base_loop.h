@@ -1,65 +1,339 @@
-/**
- * Part of WinLamb - Win32 API Lambda Library
- * https://github.com/rodrigocfd/winlamb
- * Copyright 2017-present Rodrigo Cesar de Freitas Dias
- * This library is released under the MIT License
- */
-
-#pragma once
-#include <system_error>
-#include <vector>
-#include <Windows.h>
-
-namespace wl {
-namespace _wli {
-
-// Wraps the main program loop.
-class base_loop final {
-private:
-	std::vector<HWND> _modelessChildren;
-
-public:
-	int run_loop(HWND hWnd, HACCEL hAccel = nullptr) const {
-		MSG msg{};
-		BOOL ret = FALSE;
-		while ((ret = GetMessageW(&msg, nullptr, 0, 0)) != 0) {
-			if (ret == -1) {
-				throw std::system_error(GetLastError(), std::system_category(),
-					"GetMessage failed");
-			}
-			if (this->_is_modeless_msg(&msg) || // http://www.winprog.org/tutorial/modeless_dialogs.html
-				(hAccel && TranslateAcceleratorW(hWnd, hAccel, &msg)) ||
-				IsDialogMessageW(hWnd, &msg) ) continue;
-			TranslateMessage(&msg);
-			DispatchMessageW(&msg);
-		}
-		return static_cast<int>(msg.wParam); // this can be used as program return value
-	}
-
-	void add_modeless(HWND hWnd) {
-		this->_modelessChildren.emplace_back(hWnd);
-	}
-
-	void remove_modeless(HWND hWnd) {
-		for (std::vector<HWND>::iterator it = this->_modelessChildren.begin();
-			it != this->_modelessChildren.end(); ++it)
-		{
-			if (*it == hWnd) {
-				this->_modelessChildren.erase(it);
-				break;
-			}
-		}
-	}
-
-private:
-	bool _is_modeless_msg(MSG* pMsg) const noexcept {
-		for (const HWND hModl : this->_modelessChildren) {
-			if (!hModl || !IsWindow(hModl)) continue; // skip invalid HWND
-			if (IsDialogMessageW(hModl, pMsg)) return true;
-		}
-		return false;
-	}
-};
-
-}//namespace _wli
-}//namespace wl
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <system_error>
+#include <vector>
+#include <Windows.h>
+#include "latency_tracer.h"
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002 // absent from older SDKs
+#endif
+
+namespace wl {
+namespace _wli {
+
+// Wraps the main program loop.
+class base_loop final {
+public:
+	// One hotkey of the accelerator registry. Modifiers take the classic
+	// accelerator table flags (FCONTROL, FSHIFT, FALT); FVIRTKEY is implied,
+	// the key is always a virtual-key code.
+	struct accel final {
+		BYTE modifiers = 0;
+		WORD vkey = 0;
+		WORD cmdId = 0;
+	};
+
+private:
+	struct _accel_layer final {
+		HWND                      hTarget = nullptr; // null = global layer
+		std::function<bool(WORD)> dispatch;
+	};
+	struct _accel_entry final {
+		UINT   sortKey = 0; // (vkey << 8) | modifier flags
+		WORD   cmdId = 0;
+		size_t layerIdx = 0;
+	};
+
+	std::vector<HWND> _modelessChildren;
+	std::vector<_accel_layer> _accelLayers;  // grow-only, entry indexes stay stable
+	std::vector<_accel_entry> _accelEntries; // all layers merged, sorted on demand
+	bool _accelsSorted = true;
+	std::vector<std::function<bool()>> _idleCallbacks; // run in queue gaps; false unregisters
+	std::deque<std::function<void()>>  _idleTasks;     // one-shot, one per queue gap
+	bool _dialogNavigation = true; // run IsDialogMessage on the main window?
+
+	std::vector<std::function<bool(double)>> _frameCallbacks; // receive elapsed ms; false unregisters
+	HANDLE    _hFrameTimer = nullptr; // waitable, high-resolution where the OS offers it
+	UINT      _framePeriodMs = 15;    // ~60Hz
+	bool      _frameTimerArmed = false;
+	ULONGLONG _lastFrameTick = 0;
+
+public:
+	~base_loop() {
+		if (this->_hFrameTimer) {
+			CloseHandle(this->_hFrameTimer);
+		}
+	}
+
+	int run_loop(HWND hWnd, HACCEL hAccel = nullptr) {
+		MSG msg{};
+		BOOL ret = FALSE;
+		for (;;) {
+			// While there is idle work and the queue is empty, run it; the pump
+			// only blocks when nothing is left to do, so no timer wakeups are
+			// ever needed for background work.
+			while (this->_has_idle_work() &&
+				!PeekMessageW(&msg, nullptr, 0, 0, PM_NOREMOVE))
+			{
+				this->_run_idle_slice();
+			}
+
+			// With frame callbacks active and the window visible, block on the
+			// queue and the frame timer together: ticks arrive at waitable-timer
+			// resolution, not at SetTimer's, and with no message traffic at all.
+			// Minimized windows disarm the timer, so hidden animations cost zero.
+			if (!this->_frameCallbacks.empty() && !IsIconic(hWnd)) {
+				this->_arm_frame_timer();
+				DWORD waited = MsgWaitForMultipleObjectsEx(1, &this->_hFrameTimer,
+					INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+				if (waited == WAIT_OBJECT_0) { // frame tick, and no input pending
+					this->_run_frame_slice();
+					continue;
+				}
+				while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) { // drain, then wait again
+					if (msg.message == WM_QUIT) {
+						return static_cast<int>(msg.wParam);
+					}
+					this->_route_msg(hWnd, hAccel, msg);
+				}
+				continue;
+			}
+			this->_disarm_frame_timer();
+
+			if ((ret = GetMessageW(&msg, nullptr, 0, 0)) == 0) break;
+			if (ret == -1) {
+				throw std::system_error(GetLastError(), std::system_category(),
+					"GetMessage failed");
+			}
+			this->_route_msg(hWnd, hAccel, msg);
+		}
+		return static_cast<int>(msg.wParam); // this can be used as program return value
+	}
+
+	// Registers a lambda to run whenever the message queue goes empty; returning
+	// true keeps it registered for the next gap, false unregisters it.
+	void add_idle_callback(std::function<bool()> callback) {
+		this->_idleCallbacks.emplace_back(std::move(callback));
+	}
+
+	// Queues a one-shot task to run at low priority, one per message-queue gap.
+	void post_idle_task(std::function<void()> task) {
+		this->_idleTasks.emplace_back(std::move(task));
+	}
+
+	// Registers a per-frame lambda, driven by a high-resolution waitable timer
+	// woven into the pump — no SetTimer granularity, no queue traffic. Receives
+	// the milliseconds elapsed since the previous frame; returning true keeps it
+	// registered, false unregisters it. Paused while the window is minimized.
+	void add_frame_callback(std::function<bool(double)> callback) {
+		this->_frameCallbacks.emplace_back(std::move(callback));
+	}
+
+	// Sets the frame period; 15ms (roughly 60Hz) if never called.
+	void set_frame_period(UINT ms) noexcept {
+		this->_framePeriodMs = ms ? ms : 1;
+		this->_frameTimerArmed = false; // re-arm with the new period on next pass
+	}
+
+	// Enables or disables the per-message IsDialogMessage call on the main
+	// window; windows that don't host dialog navigation (Tab/arrow traversal
+	// over child controls) can disable it to shave work off input floods.
+	void set_dialog_navigation(bool enable) noexcept {
+		this->_dialogNavigation = enable;
+	}
+
+	// Registers a layer of hotkeys routed straight to the dispatch callback,
+	// with no WM_COMMAND round trip. A null target makes the layer global;
+	// otherwise it is active while the target window or one of its children
+	// holds the focus, shadowing the global layer on key clashes. All layers
+	// are merged into one sorted lookup, so adding one never rebuilds a table.
+	void add_accels(HWND hTarget, std::function<bool(WORD)> dispatch,
+		const accel* accels, size_t numAccels)
+	{
+		this->_accelLayers.push_back({hTarget, std::move(dispatch)});
+		size_t layerIdx = this->_accelLayers.size() - 1;
+
+		for (size_t i = 0; i < numAccels; ++i) {
+			this->_accelEntries.push_back({
+				(static_cast<UINT>(accels[i].vkey) << 8) |
+					(accels[i].modifiers & (FCONTROL | FSHIFT | FALT)),
+				accels[i].cmdId, layerIdx});
+		}
+		this->_accelsSorted = false;
+	}
+
+	// Unregisters every hotkey layer of the given window.
+	void remove_accels(HWND hTarget) {
+		for (size_t iLayer = 0; iLayer < this->_accelLayers.size(); ++iLayer) {
+			if (this->_accelLayers[iLayer].hTarget != hTarget) continue;
+			this->_accelLayers[iLayer].dispatch = nullptr; // indexes must stay stable
+
+			for (size_t i = 0; i < this->_accelEntries.size(); ) {
+				if (this->_accelEntries[i].layerIdx == iLayer) {
+					this->_accelEntries.erase(this->_accelEntries.begin() + i);
+				} else {
+					++i;
+				}
+			}
+		}
+	}
+
+	void add_modeless(HWND hWnd) {
+		this->_modelessChildren.emplace_back(hWnd);
+	}
+
+	void remove_modeless(HWND hWnd) {
+		for (std::vector<HWND>::iterator it = this->_modelessChildren.begin();
+			it != this->_modelessChildren.end(); ++it)
+		{
+			if (*it == hWnd) {
+				this->_modelessChildren.erase(it);
+				break;
+			}
+		}
+	}
+
+private:
+	void _route_msg(HWND hWnd, HACCEL hAccel, MSG& msg) {
+		latency_tracer::instance().record( // dequeue timestamp, anchor of input-to-paint spans
+			latency_tracer::event_kind::MSG_DEQUEUED, msg.hwnd, msg.message);
+
+		// The registry goes first: one binary search over the merged layers,
+		// and a hit dispatches straight into the handler. The empty() check
+		// keeps the common zero-modeless case from touching _is_modeless_msg
+		// at all; IsDialogMessage on the main window can be opted out for
+		// windows that don't host dialog navigation.
+		if (this->_try_accel(msg)) return;
+		if ((!this->_modelessChildren.empty() && this->_is_modeless_msg(&msg)) || // http://www.winprog.org/tutorial/modeless_dialogs.html
+			(hAccel && TranslateAcceleratorW(hWnd, hAccel, &msg)) ||
+			(this->_dialogNavigation && IsDialogMessageW(hWnd, &msg)) ) return;
+		TranslateMessage(&msg);
+		DispatchMessageW(&msg);
+	}
+
+	bool _has_idle_work() const noexcept {
+		return !this->_idleCallbacks.empty() || !this->_idleTasks.empty();
+	}
+
+	// One round of idle work: each registered callback runs once, then one
+	// queued task; control goes back to the pump between slices so input is
+	// never starved by long backlogs.
+	void _run_idle_slice() {
+		for (size_t i = 0; i < this->_idleCallbacks.size(); ) {
+			if (this->_idleCallbacks[i]()) {
+				++i;
+			} else { // callback asked to be unregistered
+				this->_idleCallbacks.erase(this->_idleCallbacks.begin() + i);
+			}
+		}
+		if (!this->_idleTasks.empty()) {
+			std::function<void()> task = std::move(this->_idleTasks.front());
+			this->_idleTasks.pop_front();
+			task();
+		}
+	}
+
+	void _arm_frame_timer() {
+		if (this->_frameTimerArmed) return;
+
+		if (!this->_hFrameTimer) {
+			this->_hFrameTimer = CreateWaitableTimerExW(nullptr, nullptr,
+				CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+			if (!this->_hFrameTimer) { // OS predates high-resolution timers
+				this->_hFrameTimer = CreateWaitableTimerExW(nullptr, nullptr,
+					0, TIMER_ALL_ACCESS);
+			}
+			if (!this->_hFrameTimer) {
+				throw std::system_error(GetLastError(), std::system_category(),
+					"CreateWaitableTimerEx failed for the frame scheduler");
+			}
+		}
+
+		LARGE_INTEGER dueTime{};
+		dueTime.QuadPart = -1; // first tick as soon as possible
+		if (!SetWaitableTimer(this->_hFrameTimer, &dueTime,
+			static_cast<LONG>(this->_framePeriodMs), nullptr, nullptr, FALSE))
+		{
+			throw std::system_error(GetLastError(), std::system_category(),
+				"SetWaitableTimer failed for the frame scheduler");
+		}
+		this->_frameTimerArmed = true;
+		this->_lastFrameTick = GetTickCount64();
+	}
+
+	void _disarm_frame_timer() noexcept {
+		if (this->_frameTimerArmed) {
+			CancelWaitableTimer(this->_hFrameTimer);
+			this->_frameTimerArmed = false;
+		}
+	}
+
+	void _run_frame_slice() {
+		ULONGLONG now = GetTickCount64();
+		double elapsedMs = static_cast<double>(now - this->_lastFrameTick);
+		this->_lastFrameTick = now;
+
+		for (size_t i = 0; i < this->_frameCallbacks.size(); ) {
+			if (this->_frameCallbacks[i](elapsedMs)) {
+				++i;
+			} else { // callback asked to be unregistered
+				this->_frameCallbacks.erase(this->_frameCallbacks.begin() + i);
+			}
+		}
+	}
+
+	bool _try_accel(MSG& msg) {
+		if (this->_accelEntries.empty() ||
+			(msg.message != WM_KEYDOWN && msg.message != WM_SYSKEYDOWN)) return false;
+
+		if (!this->_accelsSorted) {
+			std::sort(this->_accelEntries.begin(), this->_accelEntries.end(),
+				[](const _accel_entry& a, const _accel_entry& b) noexcept -> bool {
+					return a.sortKey < b.sortKey;
+				});
+			this->_accelsSorted = true;
+		}
+
+		UINT sortKey = (static_cast<UINT>(LOWORD(msg.wParam)) << 8) |
+			(GetKeyState(VK_CONTROL) < 0 ? FCONTROL : 0) |
+			(GetKeyState(VK_SHIFT) < 0 ? FSHIFT : 0) |
+			(GetKeyState(VK_MENU) < 0 ? FALT : 0);
+
+		std::vector<_accel_entry>::const_iterator it = std::lower_bound(
+			this->_accelEntries.cbegin(), this->_accelEntries.cend(), sortKey,
+			[](const _accel_entry& e, UINT key) noexcept -> bool {
+				return e.sortKey < key;
+			});
+
+		HWND hFocus = GetFocus();
+		const _accel_entry* pGlobal = nullptr;
+
+		for (; it != this->_accelEntries.cend() && it->sortKey == sortKey; ++it) {
+			const _accel_layer& layer = this->_accelLayers[it->layerIdx];
+			if (!layer.dispatch) continue; // layer was unregistered
+			if (layer.hTarget) {
+				if (hFocus && (layer.hTarget == hFocus || IsChild(layer.hTarget, hFocus))) {
+					if (layer.dispatch(it->cmdId)) return true; // focused layer wins
+				}
+			} else if (!pGlobal) {
+				pGlobal = &*it; // remembered; a focused layer may still shadow it
+			}
+		}
+
+		if (pGlobal) {
+			return this->_accelLayers[pGlobal->layerIdx].dispatch(pGlobal->cmdId);
+		}
+		return false; // fall through to the classic HACCEL, if any
+	}
+
+	bool _is_modeless_msg(MSG* pMsg) const noexcept {
+		for (const HWND hModl : this->_modelessChildren) {
+			if (!hModl || !IsWindow(hModl)) continue; // skip invalid HWND
+			if (IsDialogMessageW(hModl, pMsg)) return true;
+		}
+		return false;
+	}
+};
+
+}//namespace _wli
+}//namespace wl
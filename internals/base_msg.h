@@ -1,81 +1,195 @@
-/**
- * Part of WinLamb - Win32 API Lambda Library
- * https://github.com/rodrigocfd/winlamb
- * Copyright 2017-present Rodrigo Cesar de Freitas Dias
- * This library is released under the MIT License
- */
-
-#pragma once
-#include "lippincott.h"
-#include "params_wm.h"
-#include "params_wmn.h"
-#include "store.h"
-
-namespace wl {
-namespace _wli {
-
-// Stores and processes window messages.
-template<typename retT>
-class base_msg final {
-private:
-	bool        _canAdd = true;
-	const HWND& _hWnd;
-
-public:
-	store<UINT, retT>                      msgs;
-	store<WORD, retT>                      cmds;
-	store<std::pair<UINT_PTR, UINT>, retT> ntfs; // idFrom, code
-
-	base_msg(const HWND& hWnd) noexcept :
-		_hWnd(hWnd) { }
-
-	// Returns the window handle.
-	HWND hwnd() const noexcept {
-		return this->_hWnd;
-	}
-
-	std::pair<bool, retT> process_msg(UINT msg, WPARAM wp, LPARAM lp) noexcept {
-		this->_canAdd = false; // lock, no further message handlers can be added
-		std::function<retT(params)>* pUserLambda = nullptr;
-
-		// WM_COMMAND and WM_NOTIFY messages could have been orthogonally inserted into
-		// store<> just like any other messages, however they'd be at the bottom of
-		// the linear search, while still having their own internal linear searches
-		// afterwards. Keeping them outside store<> eliminates the whole first search,
-		// which is replaced by the switch below.
-
-		switch (msg) {
-		case WM_COMMAND:
-			pUserLambda = this->cmds.find(LOWORD(wp));
-			break;
-		case WM_NOTIFY:
-			pUserLambda = this->ntfs.find({
-				reinterpret_cast<NMHDR*>(lp)->idFrom,
-				reinterpret_cast<NMHDR*>(lp)->code
-			});
-			break;
-		default:
-			pUserLambda = this->msgs.find(msg);
-		}
-
-		if (pUserLambda) {
-			try { // any exception from a message lambda which was not caught
-				return {true, (*pUserLambda)({msg, wp, lp})};
-			} catch (...) {
-				lippincott();
-				PostQuitMessage(-1);
-			}
-		}
-		return {false, -1}; // message not processed
-	}
-
-	void throw_if_cant_add() const {
-		if (!this->_canAdd) {
-			throw std::logic_error("Can't add a message handler after the loop started.\n"
-				"This would be an unsafe operation, therefore it's explicitly forbidden.");
-		}
-	}
-};
-
-}//namespace _wli
-}//namespace wl
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include "invalidate_batcher.h"
+#include "latency_tracer.h"
+#include "lippincott.h"
+#include "msg_arena.h"
+#include "msg_profiler.h"
+#include "params_wm.h"
+#include "params_wmn.h"
+#include "store.h"
+
+namespace wl {
+namespace _wli {
+
+// Stores and processes window messages.
+template<typename retT>
+class base_msg final {
+public:
+	// How a flood-prone message is throttled before its handler runs.
+	enum class coalesce {
+		LATEST_ONLY, // skip the handler when a fresher same message already waits in the queue
+		MAX_RATE     // run the handler at most once per interval, with a trailing replay
+	};
+
+private:
+	struct _coalesce_rule final {
+		UINT      msg = 0;
+		coalesce  policy = coalesce::LATEST_ONLY;
+		UINT      intervalMs = 0;    // MAX_RATE only
+		ULONGLONG lastRunTick = 0;
+		WPARAM    lastWp = 0;        // latest suppressed delivery, replayed by the timer
+		LPARAM    lastLp = 0;
+		bool      timerSet = false;
+	};
+
+	bool                        _canAdd = true;
+	const HWND&                 _hWnd;
+	std::vector<_coalesce_rule> _coalesceRules; // one or two entries, linear scan
+
+public:
+	store<UINT, retT>                      msgs;
+	store<WORD, retT>                      cmds;
+	store<std::pair<UINT_PTR, UINT>, retT> ntfs; // idFrom, code
+	msg_arena                              arena; // message-lifetime scratch for handlers
+#ifdef WINLAMB_PROFILE_MSGS
+	msg_profiler                           profiler; // per-window handler timings
+#endif
+
+	base_msg(const HWND& hWnd) noexcept :
+		_hWnd(hWnd) { }
+
+	// Returns the window handle.
+	HWND hwnd() const noexcept {
+		return this->_hWnd;
+	}
+
+	std::pair<bool, retT> process_msg(UINT msg, WPARAM wp, LPARAM lp) noexcept {
+		this->_canAdd = false; // lock, no further message handlers can be added
+		inline_func<retT(params)>* pUserLambda = nullptr;
+
+		// WM_COMMAND and WM_NOTIFY messages could have been orthogonally inserted into
+		// store<> just like any other messages, however they'd be at the bottom of
+		// the linear search, while still having their own internal linear searches
+		// afterwards. Keeping them outside store<> eliminates the whole first search,
+		// which is replaced by the switch below.
+
+		// Each store keeps a bitmap over its registered ids; high-traffic messages
+		// nobody registered (WM_MOUSEMOVE over a subclassed control, say) bail out
+		// on the bit test without ever touching the store lookup.
+
+		switch (msg) {
+		case WM_COMMAND: {
+			WORD cmdId = LOWORD(wp);
+			pUserLambda = this->cmds.can_match(cmdId) ?
+				this->cmds.find(cmdId) : nullptr;
+			break;
+		}
+		case WM_NOTIFY: {
+			std::pair<UINT_PTR, UINT> ntfId{
+				reinterpret_cast<NMHDR*>(lp)->idFrom,
+				reinterpret_cast<NMHDR*>(lp)->code
+			};
+			pUserLambda = this->ntfs.can_match(ntfId) ?
+				this->ntfs.find(ntfId) : nullptr;
+			break;
+		}
+		default:
+			pUserLambda = this->msgs.can_match(msg) ?
+				this->msgs.find(msg) : nullptr;
+		}
+
+		if (pUserLambda && msg != WM_COMMAND && msg != WM_NOTIFY) {
+			for (_coalesce_rule& rule : this->_coalesceRules) {
+				if (rule.msg != msg) continue;
+				if (!this->_should_run_now(rule, msg, wp, lp)) {
+					return {true, 0}; // suppressed; a queued or replayed delivery does the work
+				}
+				break;
+			}
+		}
+
+		if (pUserLambda) {
+			try { // any exception from a message lambda which was not caught
+#ifdef WINLAMB_PROFILE_MSGS
+				msg_profiler::scope timed{this->profiler, msg};
+#endif
+				msg_arena::dispatch_scope scratch{this->arena}; // reclaimed when the handler returns
+				invalidate_batcher::scope deferPaints; // wnd::invalidate calls coalesce until the handler returns
+				latency_tracer::span traced{latency_tracer::event_kind::HANDLER_ENTER,
+					latency_tracer::event_kind::HANDLER_EXIT, this->_hWnd, msg};
+				return {true, (*pUserLambda)({msg, wp, lp})};
+			} catch (...) {
+				lippincott();
+				PostQuitMessage(-1);
+			}
+		}
+		return {false, -1}; // message not processed
+	}
+
+	// Called after the constructor-time registrations of a window class are
+	// complete: the first instance under the key publishes its sorted dispatch
+	// indexes, clones adopt them and skip the per-instance sort — the lambdas
+	// themselves stay per-instance, they capture each window's this.
+	void adopt_class_layout(size_t classKey) {
+		this->msgs.adopt_or_publish_layout(classKey * 4);
+		this->cmds.adopt_or_publish_layout(classKey * 4 + 1);
+		this->ntfs.adopt_or_publish_layout(classKey * 4 + 2);
+	}
+
+	void throw_if_cant_add() const {
+		if (!this->_canAdd) {
+			throw std::logic_error("Can't add a message handler after the loop started.\n"
+				"This would be an unsafe operation, therefore it's explicitly forbidden.");
+		}
+	}
+
+	// Registers a throttling policy for a flood-prone message. Registered at
+	// construction time like the handlers, so the rule vector is immutable
+	// once messages flow — the replay timer can carry a pointer into it.
+	void set_coalescing(UINT msg, coalesce policy, UINT intervalMs = 0) {
+		this->throw_if_cant_add();
+		_coalesce_rule rule;
+		rule.msg = msg;
+		rule.policy = policy;
+		rule.intervalMs = intervalMs;
+		this->_coalesceRules.push_back(rule);
+	}
+
+private:
+	bool _should_run_now(_coalesce_rule& rule, UINT msg, WPARAM wp, LPARAM lp) noexcept {
+		if (rule.policy == coalesce::LATEST_ONLY) {
+			MSG queued{};
+			// A fresher delivery already sits in the queue; running the handler
+			// now would be redundant work that the next delivery redoes anyway.
+			return !PeekMessageW(&queued, this->_hWnd, msg, msg, PM_NOREMOVE);
+		}
+
+		ULONGLONG now = GetTickCount64();
+		ULONGLONG elapsed = now - rule.lastRunTick;
+		if (elapsed < rule.intervalMs) {
+			rule.lastWp = wp; // remember the latest suppressed delivery
+			rule.lastLp = lp;
+			if (!rule.timerSet) { // trailing edge: replay it once the interval expires
+				rule.timerSet = true;
+				SetTimer(this->_hWnd, reinterpret_cast<UINT_PTR>(&rule),
+					static_cast<UINT>(rule.intervalMs - elapsed), _trailing_replay_proc);
+			}
+			return false;
+		}
+
+		rule.lastRunTick = now;
+		if (rule.timerSet) { // this delivery supersedes the pending replay
+			KillTimer(this->_hWnd, reinterpret_cast<UINT_PTR>(&rule));
+			rule.timerSet = false;
+		}
+		return true;
+	}
+
+	static void CALLBACK _trailing_replay_proc(HWND hWnd, UINT, UINT_PTR idEvent, DWORD) noexcept {
+		_coalesce_rule* rule = reinterpret_cast<_coalesce_rule*>(idEvent); // timer id carries the rule
+		KillTimer(hWnd, idEvent);
+		rule->timerSet = false;
+		rule->lastRunTick = 0; // open the gate for the replayed delivery
+		PostMessageW(hWnd, rule->msg, rule->lastWp, rule->lastLp);
+	}
+};
+
+}//namespace _wli
+}//namespace wl
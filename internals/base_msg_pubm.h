@@ -1,66 +1,140 @@
-/**
- * Part of WinLamb - Win32 API Lambda Library
- * https://github.com/rodrigocfd/winlamb
- * Copyright 2017-present Rodrigo Cesar de Freitas Dias
- * This library is released under the MIT License
- */
-
-#pragma once
-#include "base_msg.h"
-
-namespace wl {
-namespace _wli {
-
-// Provides public methods for base_msg class.
-template<typename retT>
-class base_msg_pubm {
-private:
-	base_msg<retT>& _baseMsg;
-
-public:
-	base_msg_pubm(base_msg<retT>& baseMsg) noexcept :
-		_baseMsg(baseMsg) { }
-
-	// Assigns a lambda to handle a window message.
-	void on_message(UINT msg, std::function<retT(params)> func) {
-		this->_baseMsg.throw_if_cant_add();
-		this->_baseMsg.msgs.add(msg, std::move(func));
-	}
-	// Assigns a lambda to handle a window message.
-	void on_message(std::initializer_list<UINT> msgs, std::function<retT(params)> func) {
-		this->_baseMsg.throw_if_cant_add();
-		this->_baseMsg.msgs.add(msgs, std::move(func));
-	}
-
-	// Assigns a lambda to handle a WM_COMMAND message.
-	void on_command(WORD cmd, std::function<retT(params)> func) {
-		this->_baseMsg.throw_if_cant_add();
-		this->_baseMsg.cmds.add(cmd, std::move(func));
-	}
-	// Assigns a lambda to handle a WM_COMMAND message.
-	void on_command(std::initializer_list<WORD> cmds, std::function<retT(params)> func) {
-		this->_baseMsg.throw_if_cant_add();
-		this->_baseMsg.cmds.add(cmds, std::move(func));
-	}
-
-	// Assigns a lambda to handle a WM_NOTIFY message.
-	void on_notify(UINT_PTR idFrom, UINT code, std::function<retT(params)> func) {
-		this->_baseMsg.throw_if_cant_add();
-		this->_baseMsg.ntfs.add({idFrom, code}, std::move(func));
-	}
-	// Assigns a lambda to handle a WM_NOTIFY message.
-	void on_notify(std::pair<UINT_PTR, UINT> idFromAndCode, std::function<retT(params)> func) {
-		this->_baseMsg.throw_if_cant_add();
-		this->_baseMsg.ntfs.add(idFromAndCode, std::move(func));
-	}
-	// Assigns a lambda to handle a WM_NOTIFY message.
-	void on_notify(std::initializer_list<std::pair<UINT_PTR, UINT>> idFromAndCodes,
-		std::function<retT(params)> func)
-	{
-		this->_baseMsg.throw_if_cant_add();
-		this->_baseMsg.ntfs.add(idFromAndCodes, std::move(func));
-	}
-};
-
-}//namespace _wli
-}//namespace wl
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include "base_msg.h"
+
+namespace wl {
+namespace _wli {
+
+// Provides public methods for base_msg class.
+template<typename retT>
+class base_msg_pubm {
+private:
+	base_msg<retT>& _baseMsg;
+
+public:
+	base_msg_pubm(base_msg<retT>& baseMsg) noexcept :
+		_baseMsg(baseMsg) { }
+
+	// Returns the per-window arena for message-lifetime scratch: anything
+	// borrowed from it inside a handler is reclaimed, without heap traffic,
+	// when the handler returns.
+	_wli::msg_arena& msg_scratch() noexcept {
+		return this->_baseMsg.arena;
+	}
+
+	// Assigns a lambda to handle a window message.
+	void on_message(UINT msg, inline_func<retT(params)> func) {
+		this->_baseMsg.throw_if_cant_add();
+		this->_baseMsg.msgs.add(msg, std::move(func));
+	}
+	// Assigns a lambda to handle a window message whose id is known at compile
+	// time, e.g. on_message<WM_PAINT>(...). Misrouted registrations that the
+	// runtime overload only reveals in production — WM_COMMAND and WM_NOTIFY
+	// have their own channels and never reach the message store — become
+	// compile errors here. Handlers capture per-window state, so dispatch
+	// still runs over the per-instance sorted store.
+	template<UINT wmT>
+	void on_message(inline_func<retT(params)> func) {
+		static_assert(wmT != WM_COMMAND,
+			"WM_COMMAND never reaches the message store, use on_command().");
+		static_assert(wmT != WM_NOTIFY,
+			"WM_NOTIFY never reaches the message store, use on_notify().");
+		this->on_message(wmT, std::move(func));
+	}
+	// Assigns a lambda to handle a window message.
+	void on_message(std::initializer_list<UINT> msgs, inline_func<retT(params)> func) {
+		this->_baseMsg.throw_if_cant_add();
+		this->_baseMsg.msgs.add(msgs, std::move(func));
+	}
+
+	// Throttles a flood-prone message to latest-only: when a fresher delivery
+	// of the same message already waits in the queue, the handler is skipped —
+	// a hover handler flooded by WM_MOUSEMOVE then runs once per pump gap, on
+	// the newest coordinates, instead of a thousand times per second.
+	void coalesce_latest_only(UINT msg) {
+		this->_baseMsg.set_coalescing(msg, base_msg<retT>::coalesce::LATEST_ONLY);
+	}
+
+	// Throttles a flood-prone message to at most one handler run per interval.
+	// Suppressed deliveries aren't lost: the newest one is replayed by a timer
+	// when the interval expires, so the handler always ends on the final state.
+	void coalesce_max_rate(UINT msg, UINT intervalMs) {
+		this->_baseMsg.set_coalescing(msg, base_msg<retT>::coalesce::MAX_RATE, intervalMs);
+	}
+
+	// Assigns a lambda to handle a WM_COMMAND message.
+	void on_command(WORD cmd, inline_func<retT(params)> func) {
+		this->_baseMsg.throw_if_cant_add();
+		this->_baseMsg.cmds.add(cmd, std::move(func));
+	}
+	// Assigns a lambda to handle a WM_COMMAND message whose command id is known
+	// at compile time, e.g. on_command<IDOK>(...).
+	template<WORD cmdT>
+	void on_command(inline_func<retT(params)> func) {
+		this->on_command(cmdT, std::move(func));
+	}
+	// Assigns a lambda to handle a WM_COMMAND message.
+	void on_command(std::initializer_list<WORD> cmds, inline_func<retT(params)> func) {
+		this->_baseMsg.throw_if_cant_add();
+		this->_baseMsg.cmds.add(cmds, std::move(func));
+	}
+
+	// Invokes this window's on_command handler for the given id right away,
+	// skipping the WM_COMMAND queue round trip; returns false when no handler
+	// is registered. The accelerator registry routes hotkeys through here.
+	bool try_command(WORD cmdId) noexcept {
+		return this->_baseMsg.process_msg(WM_COMMAND, MAKEWPARAM(cmdId, 1), 0).first;
+	}
+
+	// Assigns a lambda to handle a WM_NOTIFY message.
+	void on_notify(UINT_PTR idFrom, UINT code, inline_func<retT(params)> func) {
+		this->_baseMsg.throw_if_cant_add();
+		this->_baseMsg.ntfs.add({idFrom, code}, std::move(func));
+	}
+	// Assigns a lambda to handle a WM_NOTIFY message whose source control id and
+	// notification code are known at compile time, e.g. on_notify<IDC_LIST, LVN_ITEMCHANGED>(...).
+	template<UINT_PTR idFromT, UINT codeT>
+	void on_notify(inline_func<retT(params)> func) {
+		this->on_notify(idFromT, codeT, std::move(func));
+	}
+	// Assigns a lambda to handle a WM_NOTIFY message.
+	void on_notify(std::pair<UINT_PTR, UINT> idFromAndCode, inline_func<retT(params)> func) {
+		this->_baseMsg.throw_if_cant_add();
+		this->_baseMsg.ntfs.add(idFromAndCode, std::move(func));
+	}
+	// Assigns a lambda to handle a WM_NOTIFY message.
+	void on_notify(std::initializer_list<std::pair<UINT_PTR, UINT>> idFromAndCodes,
+		inline_func<retT(params)> func)
+	{
+		this->_baseMsg.throw_if_cant_add();
+		this->_baseMsg.ntfs.add(idFromAndCodes, std::move(func));
+	}
+
+#ifdef WINLAMB_PROFILE_MSGS
+	// Assigns a lambda to be called with (message id, duration in microseconds)
+	// after each handler of this window runs. Compiled only when
+	// WINLAMB_PROFILE_MSGS is defined; release builds pay nothing.
+	void on_handler_timed(std::function<void(UINT, long long)> callback) {
+		this->_baseMsg.profiler.on_handler_timed(std::move(callback));
+	}
+
+	// Returns the aggregated per-message handler timings as a printable table.
+	std::wstring dump_msg_profile() const {
+		return this->_baseMsg.profiler.dump();
+	}
+
+	// Discards every aggregated handler timing sample.
+	void reset_msg_profile() noexcept {
+		this->_baseMsg.profiler.reset();
+	}
+#endif
+};
+
+}//namespace _wli
+}//namespace wl
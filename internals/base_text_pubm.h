@@ -7,6 +7,7 @@
 
 #pragma once
 #include <string>
+#include "../wstr_view.h"
 #include <Windows.h>
 
 namespace wl {
@@ -33,9 +34,26 @@ public:
 		return this->set_text(s.c_str());
 	}
 
+	// Wrapper to SetWindowText taking a slice: SetWindowText wants termination,
+	// so the view goes through a per-thread buffer whose capacity is reused —
+	// feeding substrings of a parsed buffer stops allocating once warm.
+	derivedT& set_text(wstr_view s) noexcept {
+		thread_local std::wstring buf;
+		return this->set_text(s.c_str_in(buf));
+	}
+
 	// Simple wrapper to GetWindowText.
 	std::wstring get_text() const {
 		std::wstring buf;
+		this->get_text_to(buf);
+		return buf;
+	}
+
+	// Wrapper to GetWindowText that writes into a caller-provided buffer, whose
+	// capacity is reused across calls; code that reads the same control on a
+	// timer avoids one allocation per read. Returns buf.
+	std::wstring& get_text_to(std::wstring& buf) const {
+		buf.clear();
 		int len = GetWindowTextLengthW(this->_hWnd);
 		if (len) {
 			buf.resize(len + 1, L'\0');
@@ -1,93 +1,201 @@
-/**
- * Part of WinLamb - Win32 API Lambda Library
- * https://github.com/rodrigocfd/winlamb
- * Copyright 2017-present Rodrigo Cesar de Freitas Dias
- * This library is released under the MIT License
- */
-
-#pragma once
-#include "base_msg.h"
-#include <process.h>
-
-namespace wl {
-namespace _wli {
-
-// Adds multithreading capabilities to the window.
-template<typename retT, retT RET_VAL>
-class base_thread final {
-private:
-	struct _callback_pack final {
-		std::function<void()> func;
-		HWND                  hWnd = nullptr;
-		std::exception_ptr    curExcept = nullptr;
-	};
-
-	static const UINT WM_THREAD_MESSAGE = WM_APP + 0x3FFF;
-
-	base_msg<retT>& _baseMsg;
-
-public:
-	base_thread(base_msg<retT>& baseMsg) :
-		_baseMsg(baseMsg)
-	{
-		baseMsg.msgs.add(WM_THREAD_MESSAGE, [this](params p) noexcept -> retT {
-			this->_process_thread_ui_msg(p);
-			return RET_VAL; // 0 for windows, TRUE for dialogs
-		});
-	}
-
-	// Runs code asynchronously in a new detached thread.
-	void run_thread_detached(std::function<void()> func) const noexcept {
-		// Analog to std::thread([](){ ... }).detach(), but exception-safe.
-		_callback_pack* pPack = new _callback_pack{std::move(func), this->_baseMsg.hwnd()};
-
-		uintptr_t hThread = _beginthreadex(nullptr, 0, [](void* ptr) noexcept -> unsigned int {
-			_callback_pack* pPack = reinterpret_cast<_callback_pack*>(ptr);
-			try {
-				pPack->func(); // invoke user callback
-			} catch (...) {
-				_callback_pack* pCrashed = new _callback_pack{[]{}, pPack->hWnd, std::current_exception()};
-				SendMessageW(pPack->hWnd, WM_THREAD_MESSAGE, 0, reinterpret_cast<LPARAM>(pCrashed));
-			}
-			delete pPack;
-			_endthreadex(0); // http://www.codeproject.com/Articles/7732/A-class-to-synchronise-thread-completions/
-			return 0;
-		}, pPack, 0, nullptr);
-
-		CloseHandle(reinterpret_cast<HANDLE>(hThread));
-	}
-
-	// Runs code synchronously in the UI thread.
-	void run_thread_ui(std::function<void()> func) const noexcept {
-		// This method is analog to SendMessage (synchronous), but intended to be called
-		// from another thread, so a callback function can, tunelled by wndproc, run in
-		// the original thread of the window, thus allowing GUI updates. This avoids the
-		// user to deal with a custom WM_ message.
-		_callback_pack* pPack = new _callback_pack{std::move(func), this->_baseMsg.hwnd()};
-		SendMessageW(this->_baseMsg.hwnd(), WM_THREAD_MESSAGE, 0, reinterpret_cast<LPARAM>(pPack));
-	}
-
-private:
-	void _process_thread_ui_msg(const params& p) const noexcept {
-		_callback_pack* pPack = reinterpret_cast<_callback_pack*>(p.lParam);
-		if (pPack->curExcept) { // catching an exception from run_thread_detached()
-			try {
-				std::rethrow_exception(pPack->curExcept);
-			} catch (...) {
-				lippincott();
-				PostQuitMessage(-1);
-			}
-		} else { // from run_thread_ui()
-			try {
-				pPack->func(); // invoke user callback
-			} catch (...) {
-				lippincott();
-				PostQuitMessage(-1);
-			}
-		}
-		delete pPack;
-	}
-};
-
-}//namespace _wli
-}//namespace wl
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <memory>
+#include <mutex>
+#include "base_msg.h"
+#include "mpsc_ui_queue.h"
+#include "thread_pool.h"
+#include "ui_marshal.h"
+#include <process.h>
+
+namespace wl {
+namespace _wli {
+
+// Adds multithreading capabilities to the window.
+template<typename retT, retT RET_VAL>
+class base_thread final {
+private:
+	// The callback pack and the message id live in ui_marshal, so other library
+	// internals can also target this channel.
+	using _callback_pack = ui_marshal::pack;
+
+	static const UINT WM_THREAD_MESSAGE = ui_marshal::WM_THREAD_MESSAGE;
+	static const WPARAM _WP_COALESCED = 1; // wParam tag of a coalesced UI update
+	static const WPARAM _WP_BATCHED = 2;   // wParam tag of a lock-free ring wake-up
+
+	// Heap-held so base_thread remains movable; shared with the worker threads.
+	struct _coalesce_slot final {
+		std::mutex            mtx;
+		std::function<void()> func;   // latest queued UI update, if any
+		bool                  posted = false; // is a WM_THREAD_MESSAGE already in flight?
+	};
+
+	base_msg<retT>&                 _baseMsg;
+	std::shared_ptr<_coalesce_slot> _coalesce = std::make_shared<_coalesce_slot>();
+	std::shared_ptr<mpsc_ui_queue>  _uiRing = std::make_shared<mpsc_ui_queue>(); // heap-held, keeps us movable
+
+public:
+	base_thread(base_msg<retT>& baseMsg) :
+		_baseMsg(baseMsg)
+	{
+		baseMsg.msgs.add(WM_THREAD_MESSAGE, [this](params p) noexcept -> retT {
+			this->_process_thread_ui_msg(p);
+			return RET_VAL; // 0 for windows, TRUE for dialogs
+		});
+	}
+
+	// Runs code asynchronously in a new detached thread.
+	void run_thread_detached(std::function<void()> func) const noexcept {
+		// Analog to std::thread([](){ ... }).detach(), but exception-safe.
+		_callback_pack* pPack = new _callback_pack{std::move(func), this->_baseMsg.hwnd()};
+
+		uintptr_t hThread = _beginthreadex(nullptr, 0, [](void* ptr) noexcept -> unsigned int {
+			_callback_pack* pPack = reinterpret_cast<_callback_pack*>(ptr);
+			try {
+				pPack->func(); // invoke user callback
+			} catch (...) {
+				_callback_pack* pCrashed = new _callback_pack{[]{}, pPack->hWnd, std::current_exception()};
+				SendMessageW(pPack->hWnd, WM_THREAD_MESSAGE, 0, reinterpret_cast<LPARAM>(pCrashed));
+			}
+			delete pPack;
+			_endthreadex(0); // http://www.codeproject.com/Articles/7732/A-class-to-synchronise-thread-completions/
+			return 0;
+		}, pPack, 0, nullptr);
+
+		CloseHandle(reinterpret_cast<HANDLE>(hThread));
+	}
+
+	// Runs code asynchronously in the shared thread pool.
+	void run_thread_pooled(std::function<void()> func) const noexcept {
+		// Same semantics as run_thread_detached, but the task is queued to a
+		// lazily started process-wide pool instead of spawning a new OS thread,
+		// which makes it suitable for many short-lived background tasks.
+		_callback_pack* pPack = new _callback_pack{std::move(func), this->_baseMsg.hwnd()};
+
+		thread_pool::instance().submit([pPack]() noexcept {
+			try {
+				pPack->func(); // invoke user callback
+			} catch (...) {
+				_callback_pack* pCrashed = new _callback_pack{[]{}, pPack->hWnd, std::current_exception()};
+				SendMessageW(pPack->hWnd, WM_THREAD_MESSAGE, 0, reinterpret_cast<LPARAM>(pCrashed));
+			}
+			delete pPack;
+		});
+	}
+
+	// Runs code synchronously in the UI thread.
+	void run_thread_ui(std::function<void()> func) const noexcept {
+		// This method is analog to SendMessage (synchronous), but intended to be called
+		// from another thread, so a callback function can, tunelled by wndproc, run in
+		// the original thread of the window, thus allowing GUI updates. This avoids the
+		// user to deal with a custom WM_ message.
+		ui_marshal::send(this->_baseMsg.hwnd(), std::move(func));
+	}
+
+	// Runs code asynchronously in the UI thread, fire-and-forget.
+	void post_thread_ui(std::function<void()> func) const noexcept {
+		// Analog to run_thread_ui, but with PostMessage semantics: the worker
+		// thread returns immediately instead of blocking until the UI thread
+		// gets around to running the callback.
+		ui_marshal::post(this->_baseMsg.hwnd(), std::move(func));
+	}
+
+	// Runs code asynchronously in the UI thread through a lock-free ring: bursts
+	// of many calls collapse into one posted wake-up per pump cycle, instead of
+	// one Win32 queue entry each, so heavy producers never hit the 10k message
+	// queue limit. Delivery keeps submission order.
+	void post_thread_ui_batched(std::function<void()> func) const noexcept {
+		bool needWake = false;
+		if (this->_uiRing->push(func, needWake)) {
+			if (needWake) {
+				PostMessageW(this->_baseMsg.hwnd(), WM_THREAD_MESSAGE, _WP_BATCHED, 0);
+			}
+		} else {
+			this->post_thread_ui(std::move(func)); // ring full; degrade to one post per call
+		}
+	}
+
+	// Runs code asynchronously in the UI thread, merging bursts: if a previous
+	// update is still queued, it is replaced by this one, so the UI thread runs
+	// at most one callback per message-loop iteration.
+	void post_thread_ui_coalesced(std::function<void()> func) const noexcept {
+		// Intended for progress reporting from workers, where only the most
+		// recent update matters and flooding the queue just delays painting.
+		bool shouldPost = false;
+		{
+			std::lock_guard<std::mutex> lock(this->_coalesce->mtx);
+			this->_coalesce->func = std::move(func); // latest update wins
+			if (!this->_coalesce->posted) {
+				this->_coalesce->posted = true;
+				shouldPost = true;
+			}
+		}
+		if (shouldPost) {
+			PostMessageW(this->_baseMsg.hwnd(), WM_THREAD_MESSAGE, _WP_COALESCED, 0);
+		}
+	}
+
+private:
+	void _process_thread_ui_msg(const params& p) const noexcept {
+		if (p.wParam == _WP_BATCHED) { // from post_thread_ui_batched()
+			HWND hWnd = this->_baseMsg.hwnd();
+			this->_uiRing->drain(
+				[](std::function<void()>& func) noexcept {
+					try {
+						func(); // invoke user callback
+					} catch (...) {
+						lippincott();
+						PostQuitMessage(-1);
+					}
+				},
+				[hWnd]() noexcept {
+					PostMessageW(hWnd, WM_THREAD_MESSAGE, _WP_BATCHED, 0);
+				});
+			return;
+		}
+
+		if (p.wParam == _WP_COALESCED) { // from post_thread_ui_coalesced()
+			std::function<void()> func;
+			{
+				std::lock_guard<std::mutex> lock(this->_coalesce->mtx);
+				func = std::move(this->_coalesce->func);
+				this->_coalesce->func = nullptr;
+				this->_coalesce->posted = false;
+			}
+			try {
+				if (func) func(); // invoke most recent user callback
+			} catch (...) {
+				lippincott();
+				PostQuitMessage(-1);
+			}
+			return;
+		}
+
+		_callback_pack* pPack = reinterpret_cast<_callback_pack*>(p.lParam);
+		if (pPack->curExcept) { // catching an exception from run_thread_detached()
+			try {
+				std::rethrow_exception(pPack->curExcept);
+			} catch (...) {
+				lippincott();
+				PostQuitMessage(-1);
+			}
+		} else { // from run_thread_ui()
+			try {
+				pPack->func(); // invoke user callback
+			} catch (...) {
+				lippincott();
+				PostQuitMessage(-1);
+			}
+		}
+		delete pPack;
+	}
+};
+
+}//namespace _wli
+}//namespace wl
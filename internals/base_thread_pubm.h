@@ -26,10 +26,32 @@ public:
 		return this->_baseThread.run_thread_detached(std::move(func));
 	}
 
+	// Runs code asynchronously in the shared thread pool.
+	void run_thread_pooled(std::function<void()> func) const noexcept {
+		return this->_baseThread.run_thread_pooled(std::move(func));
+	}
+
 	// Runs code synchronously in the UI thread.
 	void run_thread_ui(std::function<void()> func) const noexcept {
 		return this->_baseThread.run_thread_ui(std::move(func));
 	}
+
+	// Runs code asynchronously in the UI thread, fire-and-forget.
+	void post_thread_ui(std::function<void()> func) const noexcept {
+		return this->_baseThread.post_thread_ui(std::move(func));
+	}
+
+	// Runs code asynchronously in the UI thread, merging bursts: only the most
+	// recent queued update is run per message-loop iteration.
+	void post_thread_ui_coalesced(std::function<void()> func) const noexcept {
+		return this->_baseThread.post_thread_ui_coalesced(std::move(func));
+	}
+
+	// Runs code asynchronously in the UI thread through a lock-free ring, keeping
+	// every update but collapsing bursts into one posted wake-up per pump cycle.
+	void post_thread_ui_batched(std::function<void()> func) const noexcept {
+		return this->_baseThread.post_thread_ui_batched(std::move(func));
+	}
 };
 
 }//namespace _wli
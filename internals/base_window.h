@@ -6,11 +6,69 @@
  */
 
 #pragma once
+#include <mutex>
+#include <string>
+#include <vector>
 #include "base_msg.h"
+#include "startup_profiler.h"
 
 namespace wl {
 namespace _wli {
 
+// Process-wide cache of registered window class atoms, keyed by a hash of the
+// class name plus the owning HINSTANCE. Repeated instantiations of the same
+// window template skip rebuilding the WNDCLASSEX and the RegisterClassEx round
+// trip, going straight to CreateWindowEx with the cached atom.
+class wndclass_cache final {
+private:
+	struct _entry final {
+		HINSTANCE    hInst = nullptr;
+		size_t       nameHash = 0;
+		std::wstring className;
+		ATOM         atom = 0;
+	};
+
+	std::vector<_entry> _entries;
+	std::mutex          _entriesMutex;
+
+	wndclass_cache() = default;
+
+public:
+	static wndclass_cache& instance() {
+		static wndclass_cache obj; // thread-safe in C++11
+		return obj;
+	}
+
+	// Returns the cached atom for the class, or zero if not registered yet.
+	ATOM find(HINSTANCE hInst, const wchar_t* className) {
+		size_t nameHash = _hash_name(className);
+		std::lock_guard<std::mutex> lock(this->_entriesMutex);
+		for (const _entry& e : this->_entries) {
+			if (e.hInst == hInst && e.nameHash == nameHash &&
+				!lstrcmpW(e.className.c_str(), className))
+			{
+				return e.atom;
+			}
+		}
+		return 0;
+	}
+
+	// Remembers a freshly registered class; the atom outlives the window objects.
+	void store(HINSTANCE hInst, const wchar_t* className, ATOM atom) {
+		std::lock_guard<std::mutex> lock(this->_entriesMutex);
+		this->_entries.push_back({hInst, _hash_name(className), className, atom});
+	}
+
+private:
+	static size_t _hash_name(const wchar_t* className) noexcept {
+		size_t h = 2166136261u; // FNV-1a, cheap and good enough for a handful of names
+		for (const wchar_t* p = className; *p; ++p) {
+			h = (h ^ static_cast<size_t>(*p)) * 16777619u;
+		}
+		return h;
+	}
+};
+
 // Common ground to all non-dialog windows.
 class base_window final {
 public:
@@ -59,8 +117,13 @@ public:
 			hInst = reinterpret_cast<HINSTANCE>(GetWindowLongPtrW(hParent, GWLP_HINSTANCE));
 		}
 
-		WNDCLASSEXW wcx = this->_gen_wndclassex(setup.wndClassEx, hInst);
-		ATOM atom = this->_register_class(wcx, setup);
+		ATOM atom = wndclass_cache::instance().find(hInst, setup.wndClassEx.lpszClassName);
+		if (!atom) { // first window of this class in the process
+			WNDCLASSEXW wcx = _gen_wndclassex(setup.wndClassEx, hInst);
+			atom = _register_class(wcx);
+			wndclass_cache::instance().store(hInst, setup.wndClassEx.lpszClassName, atom);
+			startup_profiler::instance().mark(L"first-class-registered");
+		}
 
 		if (!CreateWindowExW(setup.exStyle,
 			reinterpret_cast<LPCWSTR>(static_cast<ULONG_PTR>(static_cast<WORD>(atom))), // from MAKEINTATOM macro
@@ -71,6 +134,25 @@ public:
 			throw std::system_error(GetLastError(), std::system_category(),
 				"CreateWindowEx failed");
 		}
+		startup_profiler::instance().mark(L"first-window-created");
+	}
+
+	// Registers the window class ahead of the first creation and seeds the
+	// cache, so first-window-open latency moves off the user-visible path;
+	// typically called in bulk at startup for the classes the app will need.
+	static void pre_register(const setup_vars& setup, HINSTANCE hInst) {
+		if (!setup.wndClassEx.lpszClassName) {
+			throw std::logic_error("No window class name given on this->setup.wndClassEx.lpszClassName.");
+		}
+		if (!hInst) {
+			throw std::invalid_argument("To pre-register a window class, HINSTANCE must be provided.");
+		}
+
+		if (!wndclass_cache::instance().find(hInst, setup.wndClassEx.lpszClassName)) {
+			WNDCLASSEXW wcx = _gen_wndclassex(setup.wndClassEx, hInst);
+			ATOM atom = _register_class(wcx);
+			wndclass_cache::instance().store(hInst, setup.wndClassEx.lpszClassName, atom);
+		}
 	}
 
 private:
@@ -83,7 +165,7 @@ private:
 		}
 	}
 
-	ATOM _register_class(WNDCLASSEXW& wcx, const setup_vars& setup) {
+	static ATOM _register_class(WNDCLASSEXW& wcx) {
 		ATOM atom = RegisterClassExW(&wcx);
 		if (!atom) {
 			DWORD errCode = GetLastError();
@@ -98,7 +180,7 @@ private:
 		return atom;
 	}
 
-	WNDCLASSEXW _gen_wndclassex(const wndclassex_less& wLess, HINSTANCE hInst) const noexcept {
+	static WNDCLASSEXW _gen_wndclassex(const wndclassex_less& wLess, HINSTANCE hInst) noexcept {
 		WNDCLASSEXW wcx{};
 		wcx.cbSize = sizeof(WNDCLASSEXW);
 		wcx.lpfnWndProc = _window_proc;
@@ -134,6 +216,10 @@ private:
 			}
 		};
 
+		if (msg == WM_PAINT) {
+			startup_profiler::instance().mark(L"first-paint"); // no-op after the first
+		}
+
 		if (pSelf) {
 			std::pair<bool, LRESULT> procRet = pSelf->_baseMsg.process_msg(msg, wp, lp); // catches all message exceptions internally
 			if (procRet.first) {
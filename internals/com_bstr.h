@@ -6,11 +6,81 @@
  */
 
 #pragma once
+#include <mutex>
 #include <string>
+#include <vector>
 #include <Windows.h>
 #include <OleAuto.h>
 
 namespace wl {
+namespace _wli {
+
+// Small free list of BSTR buffers, bucketed by exact character length. BSTRs
+// carry a length prefix, so a freed buffer of matching length can take new
+// content with a plain memcpy; MSXML-heavy paths that churn through hundreds
+// of thousands of same-shaped attribute strings stop round-tripping through
+// the COM allocator. Buffers that don't fit the pool fall back to SysAlloc/
+// SysFreeString as usual.
+class bstr_pool final {
+private:
+	struct _entry final {
+		UINT len;
+		BSTR bstrObj;
+	};
+
+	static const size_t _MAX_POOLED = 64;  // free buffers kept at most
+	static const UINT   _MAX_LEN = 1024;   // don't hoard big buffers
+
+	std::vector<_entry> _freeList;
+	std::mutex          _freeListMutex;
+
+	bstr_pool() = default;
+
+public:
+	static bstr_pool& instance() {
+		static bstr_pool obj; // thread-safe in C++11
+		return obj;
+	}
+
+	// Returns a BSTR holding a copy of s, reusing a pooled buffer if one of the
+	// exact length is free.
+	BSTR acquire(const wchar_t* s) noexcept {
+		if (!s) return nullptr;
+		UINT len = lstrlenW(s);
+
+		if (len <= _MAX_LEN) {
+			std::lock_guard<std::mutex> lock(this->_freeListMutex);
+			for (size_t i = 0; i < this->_freeList.size(); ++i) {
+				if (this->_freeList[i].len == len) {
+					BSTR reused = this->_freeList[i].bstrObj;
+					this->_freeList[i] = this->_freeList.back(); // swap-pop
+					this->_freeList.pop_back();
+					memcpy(reused, s, (len + 1) * sizeof(wchar_t)); // length prefix already right
+					return reused;
+				}
+			}
+		}
+		return SysAllocString(s);
+	}
+
+	// Takes ownership of a BSTR the caller is done with, stashing it for reuse
+	// or freeing it if the pool is full.
+	void release(BSTR bstrObj) noexcept {
+		if (!bstrObj) return;
+		UINT len = SysStringLen(bstrObj);
+
+		if (len <= _MAX_LEN) {
+			std::lock_guard<std::mutex> lock(this->_freeListMutex);
+			if (this->_freeList.size() < _MAX_POOLED) {
+				this->_freeList.push_back({len, bstrObj});
+				return;
+			}
+		}
+		SysFreeString(bstrObj);
+	}
+};
+
+}//namespace _wli
 
 // Wrappers to COM objects.
 namespace com {
@@ -27,7 +97,7 @@ public:
 
 	bstr() = default;
 	bstr(bstr&& other) noexcept          : _bstrObj{other._bstrObj} { other._bstrObj = nullptr; }
-	bstr(const wchar_t* s) noexcept      : _bstrObj{SysAllocString(s)} { }
+	bstr(const wchar_t* s) noexcept      : _bstrObj{_wli::bstr_pool::instance().acquire(s)} { }
 	bstr(const std::wstring& s) noexcept : bstr(s.c_str()) { }
 
 	operator const BSTR&() const noexcept  { return this->_bstrObj; }
@@ -42,7 +112,7 @@ public:
 	
 	bstr& operator=(const wchar_t* s) noexcept {
 		this->free();
-		this->_bstrObj = SysAllocString(s);
+		this->_bstrObj = _wli::bstr_pool::instance().acquire(s);
 		return *this;
 	}
 
@@ -52,7 +122,7 @@ public:
 
 	bstr& free() noexcept {
 		if (this->_bstrObj) {
-			SysFreeString(this->_bstrObj);
+			_wli::bstr_pool::instance().release(this->_bstrObj); // pooled for reuse
 			this->_bstrObj = nullptr;
 		}
 		return *this;
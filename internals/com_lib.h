@@ -6,6 +6,7 @@
  */
 
 #pragma once
+#include <cstdio>
 #include <system_error>
 #include <Windows.h>
 #include <objbase.h>
@@ -65,10 +66,21 @@ public:
 };
 
 
+// Cold failure path of check_hr(), deliberately out of line: the message is
+// formatted and the exception machinery instantiated only here, so the success
+// branch at every call site compiles down to one test and a call that the
+// compiler knows never returns — no string handling inlined into hot COM loops.
+[[noreturn]] __declspec(noinline) inline void throw_hr(HRESULT hr, const char* exceptionMsg) {
+	char fullMsg[160]{};
+	std::snprintf(fullMsg, sizeof(fullMsg), "%s (HRESULT 0x%08X)",
+		exceptionMsg, static_cast<unsigned int>(hr));
+	throw std::system_error(hr, std::system_category(), fullMsg);
+}
+
 // COM utility which calls FAILED() macro upon HRESULT; if failed, throws a system_error.
 inline void check_hr(HRESULT hr, const char* exceptionMsg) {
 	if (FAILED(hr)) {
-		throw std::system_error(hr, std::system_category(), exceptionMsg);
+		throw_hr(hr, exceptionMsg);
 	}
 }
 
@@ -80,6 +80,23 @@ public:
 			"QueryInterface failed");
 	}
 
+	// Non-throwing tier of co_create_instance(), for callers probing for
+	// optional components in a loop: hands the HRESULT back to branch on
+	// instead of paying an exception per expected failure.
+	HRESULT try_co_create_instance(REFCLSID clsid_something) noexcept {
+		if (this->_ptrObj) return E_UNEXPECTED; // already created
+		return CoCreateInstance(clsid_something, nullptr,
+			CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&this->_ptrObj));
+	}
+
+	// Non-throwing tier of query_interface(), for callers where an unsupported
+	// interface is an expected, recoverable outcome.
+	template<typename com_interfaceT>
+	HRESULT try_query_interface(com_interfaceT** targetComPtr) noexcept {
+		if (!this->_ptrObj) return E_POINTER; // not created yet
+		return this->_ptrObj->QueryInterface(IID_PPV_ARGS(targetComPtr));
+	}
+
 	ptr clone() noexcept {
 		_ptrObj->AddRef();
 		return ptr{_ptrObj};
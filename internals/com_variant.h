@@ -46,6 +46,15 @@ public:
 	}
 
 	variant& set_str(const wchar_t* s) noexcept {
+		if (this->_variantObj.vt == VT_BSTR && this->_variantObj.bstrVal) {
+			UINT curLen = SysStringLen(this->_variantObj.bstrVal);
+			if (curLen == static_cast<UINT>(lstrlenW(s))) { // same length, rewrite in place
+				memcpy(this->_variantObj.bstrVal, s, (curLen + 1) * sizeof(wchar_t));
+				return *this;
+			}
+			SysReAllocString(&this->_variantObj.bstrVal, s); // may still reuse the buffer
+			return *this;
+		}
 		this->clear();
 		this->_variantObj.vt = VT_BSTR;
 		this->_variantObj.bstrVal = SysAllocString(s);
@@ -0,0 +1,73 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <mutex>
+#include <string>
+#include <vector>
+#include <Windows.h>
+#include <winhttp.h>
+
+namespace wl {
+namespace _wli {
+
+// Process-wide cache of warm WinHTTP connection handles, keyed by session and
+// host:port. Reusing the hConnect lets WinHTTP keep the underlying TCP/TLS
+// connection alive, so repeated requests to one origin skip DNS and handshake.
+class download_connection_cache final {
+private:
+	struct _entry final {
+		HINTERNET     hSession;
+		std::wstring  host;
+		INTERNET_PORT port;
+		HINTERNET     hConnect;
+	};
+
+	std::vector<_entry> _entries;
+	std::mutex          _entriesMtx;
+
+	download_connection_cache() = default;
+
+public:
+	download_connection_cache(const download_connection_cache&) = delete;
+	download_connection_cache& operator=(const download_connection_cache&) = delete; // non-copyable, non-movable
+
+	~download_connection_cache() {
+		for (const _entry& e : this->_entries) {
+			WinHttpCloseHandle(e.hConnect);
+		}
+	}
+
+	static download_connection_cache& instance() {
+		static download_connection_cache obj; // thread-safe in C++11
+		return obj;
+	}
+
+	// Returns the cached connection handle to the origin, opening and caching a
+	// new one on the first request. The returned handle is shared: it must not
+	// be closed by the caller, the cache owns it for the process lifetime.
+	HINTERNET get_or_open(HINTERNET hSession, const std::wstring& host, INTERNET_PORT port) noexcept {
+		std::lock_guard<std::mutex> lock(this->_entriesMtx);
+
+		for (const _entry& e : this->_entries) {
+			if (e.hSession == hSession && e.port == port &&
+				!lstrcmpiW(e.host.c_str(), host.c_str()))
+			{
+				return e.hConnect; // warm connection found
+			}
+		}
+
+		HINTERNET hConnect = WinHttpConnect(hSession, host.c_str(), port, 0);
+		if (hConnect) {
+			this->_entries.push_back({hSession, host, port, hConnect});
+		}
+		return hConnect; // nullptr on failure, caller reports GetLastError
+	}
+};
+
+}//namespace _wli
+}//namespace wl
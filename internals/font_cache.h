@@ -0,0 +1,90 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <mutex>
+#include <system_error>
+#include <vector>
+#include <Windows.h>
+
+namespace wl {
+namespace _wli {
+
+// Process-wide deduplicating cache of HFONT handles, keyed by LOGFONT.
+// Windows asking for the same font share one refcounted handle, so dialog
+// startup stops paying one CreateFontIndirect per control group.
+class font_cache final {
+private:
+	struct _entry final {
+		LOGFONTW lf{};
+		HFONT    hFont = nullptr;
+		size_t   refCount = 0;
+	};
+
+	std::vector<_entry> _entries; // a process uses a handful of fonts, linear scan is fine
+	std::mutex          _mtx;
+
+public:
+	static font_cache& instance() noexcept {
+		static font_cache obj; // thread-safe in C++11
+		return obj;
+	}
+
+	// Returns a shared handle for the given description, creating the font only
+	// if no equivalent one is cached yet. Each acquire() must be paired with a
+	// release() of the returned handle.
+	HFONT acquire(const LOGFONTW& lf) {
+		LOGFONTW norm = _normalize(lf);
+		std::lock_guard<std::mutex> lock{this->_mtx};
+
+		for (_entry& e : this->_entries) {
+			if (!memcmp(&e.lf, &norm, sizeof(LOGFONTW))) {
+				++e.refCount;
+				return e.hFont; // already created, share it
+			}
+		}
+
+		HFONT hFont = CreateFontIndirectW(&norm);
+		if (!hFont) {
+			throw std::system_error(GetLastError(), std::system_category(),
+				"CreateFontIndirect failed");
+		}
+		this->_entries.push_back({norm, hFont, 1});
+		return hFont;
+	}
+
+	// Drops one reference to a handle returned by acquire(); the HFONT itself is
+	// deleted only when the last owner lets go.
+	void release(HFONT hFont) noexcept {
+		std::lock_guard<std::mutex> lock{this->_mtx};
+
+		for (std::vector<_entry>::iterator it = this->_entries.begin();
+			it != this->_entries.end(); ++it)
+		{
+			if (it->hFont == hFont) {
+				if (!--it->refCount) {
+					DeleteObject(it->hFont);
+					this->_entries.erase(it);
+				}
+				return;
+			}
+		}
+	}
+
+private:
+	// Copies the fields and zeroes both struct padding and the face name tail
+	// beyond the terminator, so equal descriptions compare equal bytewise.
+	static LOGFONTW _normalize(const LOGFONTW& lf) noexcept {
+		LOGFONTW ret{};
+		memcpy(&ret, &lf, offsetof(LOGFONTW, lfFaceName));
+		lstrcpynW(ret.lfFaceName, lf.lfFaceName, LF_FACESIZE);
+		return ret;
+	}
+};
+
+}//namespace _wli
+}//namespace wl
@@ -7,7 +7,13 @@
 
 #pragma once
 #include <array>
+#include <mutex>
+#include <vector>
 #include <Windows.h>
+#ifdef WINLAMB_DEBUG_GDI
+	#include <cwchar>
+	#include <string>
+#endif
 
 namespace wl {
 
@@ -106,5 +112,192 @@ public:
 	}
 };
 
+// Process-wide cache of pens and solid/hatch brushes, keyed by their creation
+// parameters. Repeated acquisitions of the same object — the common pattern in
+// NM_CUSTOMDRAW handlers creating identical brushes every paint — hit the
+// cache instead of CreatePen/CreateSolidBrush, and dropping the last handle
+// keeps the object cached for the next paint rather than deleting it, so
+// steady-state acquisition costs a lookup and never churns the GDI budget.
+// Use through pooled_pen/pooled_brush below.
+class pool final {
+private:
+	struct _entry final {
+		int      kind = 0; // 0 = solid brush, 1 = hatch brush, 2 = pen
+		int      style = 0;
+		int      width = 0;
+		COLORREF color = 0;
+		HGDIOBJ  h = nullptr;
+		size_t   refs = 0;
+	};
+
+	std::vector<_entry> _entries; // a handful of distinct objects; linear scans
+	std::mutex          _entriesMutex;
+
+	pool() = default;
+
+public:
+	pool(const pool&) = delete;
+	pool& operator=(const pool&) = delete;
+
+	static pool& instance() {
+		static pool obj; // thread-safe in C++11
+		return obj;
+	}
+
+	HBRUSH acquire_solid_brush(COLORREF color) {
+		return reinterpret_cast<HBRUSH>(this->_acquire(0, 0, 0, color,
+			[color]() noexcept -> HGDIOBJ { return CreateSolidBrush(color); }));
+	}
+
+	HBRUSH acquire_hatch_brush(int hatch, COLORREF color) {
+		return reinterpret_cast<HBRUSH>(this->_acquire(1, hatch, 0, color,
+			[hatch, color]() noexcept -> HGDIOBJ { return CreateHatchBrush(hatch, color); }));
+	}
+
+	HPEN acquire_pen(int style, int width, COLORREF color) {
+		return reinterpret_cast<HPEN>(this->_acquire(2, style, width, color,
+			[style, width, color]() noexcept -> HGDIOBJ { return CreatePen(style, width, color); }));
+	}
+
+	// Drops one reference; the object itself stays cached for reacquisition.
+	void release(HGDIOBJ h) noexcept {
+		std::lock_guard<std::mutex> lock(this->_entriesMutex);
+		for (_entry& e : this->_entries) {
+			if (e.h == h && e.refs) {
+				--e.refs;
+				return;
+			}
+		}
+	}
+
+	// Deletes every cached object nobody currently references; returns how many
+	// were freed. Call at low-memory points, or never — a few dozen cached
+	// objects are cheaper than recreating them per paint.
+	size_t purge_unused() {
+		std::lock_guard<std::mutex> lock(this->_entriesMutex);
+		size_t freed = 0;
+		for (size_t i = 0; i < this->_entries.size(); ) {
+			if (!this->_entries[i].refs) {
+				DeleteObject(this->_entries[i].h);
+				this->_entries.erase(this->_entries.begin() + i);
+				++freed;
+			} else {
+				++i;
+			}
+		}
+		return freed;
+	}
+
+	// Objects currently held by the pool, referenced or cached.
+	size_t live_count() {
+		std::lock_guard<std::mutex> lock(this->_entriesMutex);
+		return this->_entries.size();
+	}
+
+#ifdef WINLAMB_DEBUG_GDI
+	// Printable census of every pooled object and its reference count; a count
+	// that only ever grows points at an acquire without a matching handle
+	// destruction. Compiled only when WINLAMB_DEBUG_GDI is defined.
+	std::wstring dump_census() {
+		std::lock_guard<std::mutex> lock(this->_entriesMutex);
+		const wchar_t* kinds[] = {L"solid brush", L"hatch brush", L"pen"};
+		std::wstring ret;
+		wchar_t line[96]{};
+		for (const _entry& e : this->_entries) {
+			swprintf(line, ARRAYSIZE(line), L"%s color=%06X style=%d width=%d refs=%zu\r\n",
+				kinds[e.kind], static_cast<unsigned>(e.color), e.style, e.width, e.refs);
+			ret += line;
+		}
+		return ret;
+	}
+#endif
+
+private:
+	template<typename createT>
+	HGDIOBJ _acquire(int kind, int style, int width, COLORREF color, createT&& create) {
+		std::lock_guard<std::mutex> lock(this->_entriesMutex);
+		for (_entry& e : this->_entries) {
+			if (e.kind == kind && e.style == style && e.width == width && e.color == color) {
+				++e.refs;
+				return e.h; // cache hit, no GDI call at all
+			}
+		}
+		HGDIOBJ h = create();
+		this->_entries.push_back({kind, style, width, color, h, 1});
+		return h;
+	}
+};
+
+// Refcounted handle to a pooled pen; identical parameters across the process
+// share one HPEN, and creation is amortized away after the first acquisition.
+class pooled_pen final {
+private:
+	HPEN _hPen = nullptr;
+
+public:
+	~pooled_pen() {
+		this->release();
+	}
+
+	pooled_pen(pen::style styleType, int width, COLORREF color) :
+		_hPen(pool::instance().acquire_pen(static_cast<int>(styleType), width, color)) { }
+
+	pooled_pen(pooled_pen&& other) noexcept { std::swap(this->_hPen, other._hPen); }
+
+	pooled_pen& operator=(pooled_pen&& other) noexcept {
+		std::swap(this->_hPen, other._hPen);
+		return *this;
+	}
+
+	HPEN hpen() const noexcept {
+		return this->_hPen;
+	}
+
+	void release() noexcept {
+		if (this->_hPen) {
+			pool::instance().release(this->_hPen);
+			this->_hPen = nullptr;
+		}
+	}
+};
+
+// Refcounted handle to a pooled solid or hatch brush; see pooled_pen.
+class pooled_brush final {
+private:
+	HBRUSH _hBrush = nullptr;
+
+public:
+	~pooled_brush() {
+		this->release();
+	}
+
+	pooled_brush(COLORREF color) :
+		_hBrush(pool::instance().acquire_solid_brush(color)) { }
+
+	pooled_brush(std::array<BYTE, 3> rgbColor) :
+		_hBrush(pool::instance().acquire_solid_brush(RGB(rgbColor[0], rgbColor[1], rgbColor[2]))) { }
+
+	pooled_brush(brush::pattern hatch, COLORREF color) :
+		_hBrush(pool::instance().acquire_hatch_brush(static_cast<int>(hatch), color)) { }
+
+	pooled_brush(pooled_brush&& other) noexcept { std::swap(this->_hBrush, other._hBrush); }
+
+	pooled_brush& operator=(pooled_brush&& other) noexcept {
+		std::swap(this->_hBrush, other._hBrush);
+		return *this;
+	}
+
+	HBRUSH hbrush() const noexcept {
+		return this->_hBrush;
+	}
+
+	void release() noexcept {
+		if (this->_hBrush) {
+			pool::instance().release(this->_hBrush);
+			this->_hBrush = nullptr;
+		}
+	}
+};
+
 }//namespace gdi
 }//namespace wl
@@ -0,0 +1,142 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace wl {
+namespace _wli {
+
+// Move-only callable wrapper with a large inline buffer, used on the message
+// dispatch path instead of std::function: ordinary capturing lambdas fit the
+// buffer, so storing and invoking a handler doesn't touch the heap.
+template<typename signatureT>
+class inline_func;
+
+template<typename retT, typename... argsT>
+class inline_func<retT(argsT...)> final {
+private:
+	static constexpr size_t _BUF_SZ = sizeof(void*) * 6; // inline room, fits most capturing lambdas
+
+	enum class _op { DESTROY, MOVE };
+
+	using _invokeT = retT (*)(void*, argsT&&...);
+	using _manageT = void (*)(void* self, void* other, _op op);
+
+	alignas(std::max_align_t) unsigned char _buf[_BUF_SZ];
+	_invokeT _invoke = nullptr;
+	_manageT _manage = nullptr;
+
+	// Operations upon a callable constructed in-place within _buf.
+	template<typename funcT>
+	struct _inline_ops final {
+		static retT invoke(void* pObj, argsT&&... args) {
+			return (*static_cast<funcT*>(pObj))(std::forward<argsT>(args)...);
+		}
+		static void manage(void* self, void* other, _op op) {
+			if (op == _op::MOVE) {
+				new (self) funcT(std::move(*static_cast<funcT*>(other)));
+				static_cast<funcT*>(other)->~funcT();
+			} else {
+				static_cast<funcT*>(self)->~funcT();
+			}
+		}
+	};
+
+	// Operations upon a callable too big for _buf, which then holds only a pointer.
+	template<typename funcT>
+	struct _heap_ops final {
+		static retT invoke(void* pObj, argsT&&... args) {
+			return (**static_cast<funcT**>(pObj))(std::forward<argsT>(args)...);
+		}
+		static void manage(void* self, void* other, _op op) {
+			funcT** ppSelf = static_cast<funcT**>(self);
+			if (op == _op::MOVE) {
+				funcT** ppOther = static_cast<funcT**>(other);
+				*ppSelf = *ppOther;
+				*ppOther = nullptr;
+			} else {
+				delete *ppSelf;
+			}
+		}
+	};
+
+public:
+	~inline_func() {
+		this->_destroy();
+	}
+
+	inline_func() = default;
+	inline_func(std::nullptr_t) noexcept { }
+	inline_func(inline_func&& other) noexcept { this->operator=(std::move(other)); }
+
+	inline_func(const inline_func&) = delete;
+	inline_func& operator=(const inline_func&) = delete;
+
+	template<typename funcT,
+		typename = typename std::enable_if<
+			!std::is_same<typename std::decay<funcT>::type, inline_func>::value &&
+			!std::is_same<typename std::decay<funcT>::type, std::nullptr_t>::value
+		>::type>
+	inline_func(funcT&& func) {
+		using decayT = typename std::decay<funcT>::type;
+		this->_construct<decayT>(std::forward<funcT>(func),
+			std::integral_constant<bool, sizeof(decayT) <= _BUF_SZ &&
+				alignof(decayT) <= alignof(std::max_align_t)>{});
+	}
+
+	inline_func& operator=(inline_func&& other) noexcept {
+		if (this != &other) {
+			this->_destroy();
+			if (other._invoke) {
+				this->_invoke = other._invoke;
+				this->_manage = other._manage;
+				this->_manage(this->_buf, other._buf, _op::MOVE);
+				other._invoke = nullptr;
+				other._manage = nullptr;
+			}
+		}
+		return *this;
+	}
+
+	explicit operator bool() const noexcept {
+		return this->_invoke != nullptr;
+	}
+
+	retT operator()(argsT... args) {
+		return this->_invoke(this->_buf, std::forward<argsT>(args)...);
+	}
+
+private:
+	template<typename decayT, typename funcT>
+	void _construct(funcT&& func, std::true_type) { // callable fits the inline buffer
+		new (this->_buf) decayT(std::forward<funcT>(func));
+		this->_invoke = &_inline_ops<decayT>::invoke;
+		this->_manage = &_inline_ops<decayT>::manage;
+	}
+
+	template<typename decayT, typename funcT>
+	void _construct(funcT&& func, std::false_type) { // too big, fall back to the heap
+		*reinterpret_cast<decayT**>(this->_buf) = new decayT(std::forward<funcT>(func));
+		this->_invoke = &_heap_ops<decayT>::invoke;
+		this->_manage = &_heap_ops<decayT>::manage;
+	}
+
+	void _destroy() noexcept {
+		if (this->_invoke) {
+			this->_manage(this->_buf, nullptr, _op::DESTROY);
+			this->_invoke = nullptr;
+			this->_manage = nullptr;
+		}
+	}
+};
+
+}//namespace _wli
+}//namespace wl
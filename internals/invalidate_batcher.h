@@ -0,0 +1,111 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <vector>
+#include <Windows.h>
+
+namespace wl {
+namespace _wli {
+
+// Coalesces invalidation requests raised while a message handler runs. A bulk
+// model update that pokes dozens of controls used to fire one InvalidateRect
+// per control, each a future WM_PAINT; with a scope open, the rects are only
+// recorded — mapped into the coordinates of their top-level window — and at
+// handler exit nearby rects are unioned and flushed as a minimal set of
+// RedrawWindow calls, one composite paint pass per dirtied region. Per-thread
+// state: UI windows live on the thread that pumps them, so no locking.
+class invalidate_batcher final {
+private:
+	struct _pending final {
+		HWND hTop;
+		RECT rc;    // in hTop client coordinates
+		bool erase;
+		bool consumed = false; // merged into an earlier region during flush
+	};
+
+	std::vector<_pending> _pendings;
+	int                   _depth = 0; // nested handler scopes; outermost flushes
+
+public:
+	static invalidate_batcher& current() noexcept {
+		thread_local invalidate_batcher obj; // one per UI thread
+		return obj;
+	}
+
+	// Brackets one handler dispatch; opened by base_msg around the user lambda.
+	class scope final {
+	public:
+		scope() noexcept { ++current()._depth; }
+		~scope() {
+			invalidate_batcher& batcher = current();
+			if (!--batcher._depth) {
+				batcher._flush();
+			}
+		}
+		scope(const scope&) = delete;
+		scope& operator=(const scope&) = delete;
+	};
+
+	// Requests a repaint of the window, or of a rect of it in its own client
+	// coordinates. Outside a handler scope this is a plain InvalidateRect;
+	// inside, the rect is recorded and coalesced at handler exit.
+	void request(HWND hWnd, const RECT* rc, bool erase) noexcept {
+		if (!this->_depth) {
+			InvalidateRect(hWnd, rc, erase ? TRUE : FALSE);
+			return;
+		}
+		RECT rcTop{};
+		if (rc) {
+			rcTop = *rc;
+		} else {
+			GetClientRect(hWnd, &rcTop);
+		}
+		HWND hTop = GetAncestor(hWnd, GA_ROOT);
+		MapWindowPoints(hWnd, hTop, reinterpret_cast<POINT*>(&rcTop), 2);
+		this->_pendings.push_back({hTop, rcTop, erase});
+	}
+
+private:
+	void _flush() noexcept {
+		for (size_t i = 0; i < this->_pendings.size(); ++i) {
+			_pending& seed = this->_pendings[i];
+			if (seed.consumed) continue;
+
+			// Grow the region with every nearby rect of the same window until
+			// it stops growing; rects this close would repaint together anyway.
+			bool grew = true;
+			while (grew) {
+				grew = false;
+				for (size_t j = i + 1; j < this->_pendings.size(); ++j) {
+					_pending& other = this->_pendings[j];
+					if (other.consumed || other.hTop != seed.hTop) continue;
+					if (!_near(seed.rc, other.rc)) continue;
+					UnionRect(&seed.rc, &seed.rc, &other.rc);
+					seed.erase = seed.erase || other.erase;
+					other.consumed = true;
+					grew = true;
+				}
+			}
+			// RDW_ALLCHILDREN dirties every child intersecting the region, so
+			// one call covers all the controls that requested a repaint there.
+			RedrawWindow(seed.hTop, &seed.rc, nullptr,
+				RDW_INVALIDATE | RDW_ALLCHILDREN | (seed.erase ? RDW_ERASE : 0));
+		}
+		this->_pendings.clear();
+	}
+
+	static bool _near(const RECT& a, const RECT& b) noexcept {
+		RECT aGrown = a;
+		InflateRect(&aGrown, 16, 16); // rects within 16px count as one region
+		RECT unused{};
+		return IntersectRect(&unused, &aGrown, &b) != FALSE;
+	}
+};
+
+}//namespace _wli
+}//namespace wl
@@ -0,0 +1,189 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <atomic>
+#include <cwchar>
+#include <vector>
+#include <Windows.h>
+#include <evntprov.h>
+#pragma comment(lib, "Advapi32.lib")
+
+namespace wl {
+namespace _wli {
+
+// Answers "why did that click take 80ms to repaint" without attaching a
+// profiler: the pump, the message dispatcher and the painters drop
+// QueryPerformanceCounter-stamped events into a fixed ring buffer, so the
+// path from an input message leaving the queue to EndPaint can be replayed
+// after the fact, in-process, on a user machine. Recording is off by default
+// and gated by one relaxed load, so the shipped cost of the hooks is a
+// predicted branch per message; events can optionally also be emitted as ETW
+// strings onto the system timeline. The ring is written from the UI thread(s)
+// and sized to hold a few seconds of traffic; older events are overwritten.
+class latency_tracer final {
+public:
+	enum class event_kind : int {
+		MSG_DEQUEUED,  // the pump pulled a message off the queue
+		HANDLER_ENTER, // a window's handler lambda starts
+		HANDLER_EXIT,  // the handler returned (or threw)
+		PAINT_BEGIN,   // a painter called BeginPaint
+		PAINT_END      // the painter destructor called EndPaint
+	};
+
+	struct event final {
+		event_kind kind = event_kind::MSG_DEQUEUED;
+		HWND       hWnd = nullptr;
+		UINT       msg = 0;  // zero for paint events
+		long long  us = 0;   // QueryPerformanceCounter, microseconds
+	};
+
+private:
+	static const size_t _RING_SIZE = 8192; // power of 2, the index is masked
+
+	event                    _ring[_RING_SIZE];
+	std::atomic<size_t>      _next{0};      // total events ever written
+	std::atomic<bool>        _recording{false};
+	std::atomic<bool>        _etw{false};
+	REGHANDLE                _hEtwProvider = 0;
+
+	latency_tracer() noexcept {
+		// {6B3F0D9C-2A71-4E55-9D08-4C1B87A35F62} - WinLamb latency events.
+		static const GUID providerGuid = {0x6B3F0D9C, 0x2A71, 0x4E55,
+			{0x9D, 0x08, 0x4C, 0x1B, 0x87, 0xA3, 0x5F, 0x62}};
+		EventRegister(&providerGuid, nullptr, nullptr, &this->_hEtwProvider); // failure just mutes ETW
+	}
+
+public:
+	~latency_tracer() {
+		if (this->_hEtwProvider) {
+			EventUnregister(this->_hEtwProvider);
+		}
+	}
+
+	latency_tracer(const latency_tracer&) = delete;
+	latency_tracer& operator=(const latency_tracer&) = delete;
+
+	static latency_tracer& instance() noexcept {
+		static latency_tracer obj; // thread-safe in C++11
+		return obj;
+	}
+
+	// Starts or stops recording; the ring keeps its contents when stopped, so
+	// the usual pattern is stop-then-snapshot after a sluggish interaction.
+	void enable(bool doRecord) noexcept {
+		this->_recording.store(doRecord, std::memory_order_relaxed);
+	}
+
+	// Mirrors every recorded event as an ETW string, putting input-to-paint
+	// spans on the same xperf/WPA timeline as the rest of the system. Off by
+	// default: the ring is cheap, EventWriteString per message is not.
+	void enable_etw(bool doEmit) noexcept {
+		this->_etw.store(doEmit, std::memory_order_relaxed);
+	}
+
+	bool recording() const noexcept {
+		return this->_recording.load(std::memory_order_relaxed);
+	}
+
+	// Hot-path hook; the instrumented call sites call it unconditionally.
+	void record(event_kind kind, HWND hWnd, UINT msg) noexcept {
+		if (!this->_recording.load(std::memory_order_relaxed)) return;
+
+		long long now = _now_us();
+		size_t slot = this->_next.fetch_add(1, std::memory_order_relaxed) & (_RING_SIZE - 1);
+		this->_ring[slot] = {kind, hWnd, msg, now};
+
+		if (this->_etw.load(std::memory_order_relaxed) && this->_hEtwProvider) {
+			static const wchar_t* kindNames[] = {
+				L"msg-dequeued", L"handler-enter", L"handler-exit",
+				L"paint-begin", L"paint-end"};
+			wchar_t buf[96]{};
+			swprintf(buf, 96, L"winlamb-latency: %s hwnd=%p msg=0x%04X",
+				kindNames[static_cast<int>(kind)], static_cast<void*>(hWnd), msg);
+			EventWriteString(this->_hEtwProvider, 5, 0, buf); // verbose level
+		}
+	}
+
+	// Times one bracketed span; the closing event fires on destruction, so a
+	// handler that throws still closes its span.
+	class span final {
+	private:
+		event_kind _closeKind;
+		HWND       _hWnd;
+		UINT       _msg;
+
+	public:
+		span(event_kind openKind, event_kind closeKind, HWND hWnd, UINT msg) noexcept :
+			_closeKind(closeKind), _hWnd(hWnd), _msg(msg)
+		{
+			instance().record(openKind, hWnd, msg);
+		}
+
+		~span() {
+			instance().record(this->_closeKind, this->_hWnd, this->_msg);
+		}
+	};
+
+	// Copies the retained events out in chronological order; recording should
+	// be stopped first, or concurrent writes may tear the oldest entries.
+	std::vector<event> snapshot() const {
+		size_t total = this->_next.load(std::memory_order_relaxed);
+		size_t count = total < _RING_SIZE ? total : _RING_SIZE;
+		size_t first = total - count; // oldest surviving event
+
+		std::vector<event> ret;
+		ret.reserve(count);
+		for (size_t i = 0; i < count; ++i) {
+			ret.push_back(this->_ring[(first + i) & (_RING_SIZE - 1)]);
+		}
+		return ret;
+	}
+
+	// Milliseconds from the most recent input message leaving the queue to the
+	// paint-end that followed it — the "click to pixels" number. Returns -1
+	// when the ring holds no complete input-to-paint sequence.
+	double last_input_to_paint_ms() const {
+		std::vector<event> evs = this->snapshot();
+
+		for (size_t i = evs.size(); i-- > 0; ) { // newest paint-end first
+			if (evs[i].kind != event_kind::PAINT_END) continue;
+			for (size_t j = i; j-- > 0; ) { // the input dequeue that led to it
+				if (evs[j].kind == event_kind::MSG_DEQUEUED && _is_input_msg(evs[j].msg)) {
+					return static_cast<double>(evs[i].us - evs[j].us) / 1000.0;
+				}
+			}
+			break;
+		}
+		return -1;
+	}
+
+	// Discards every retained event.
+	void reset() noexcept {
+		this->_next.store(0, std::memory_order_relaxed);
+	}
+
+private:
+	static bool _is_input_msg(UINT msg) noexcept {
+		return (msg >= WM_KEYFIRST && msg <= WM_KEYLAST) ||
+			(msg >= WM_MOUSEFIRST && msg <= WM_MOUSELAST);
+	}
+
+	static long long _now_us() noexcept {
+		static LARGE_INTEGER freq = []() noexcept -> LARGE_INTEGER {
+			LARGE_INTEGER f{};
+			QueryPerformanceFrequency(&f);
+			return f;
+		}();
+		LARGE_INTEGER now{};
+		QueryPerformanceCounter(&now);
+		return now.QuadPart * 1'000'000 / freq.QuadPart;
+	}
+};
+
+}//namespace _wli
+}//namespace wl
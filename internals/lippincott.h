@@ -12,6 +12,16 @@
 namespace wl {
 namespace _wli {
 
+// Hook run by lippincott() before the error dialog goes up; log_sink installs
+// a drain here so the tail of the log reaches the disk even when we're about
+// to die. Null until someone registers.
+using crash_flush_fn = void (*)();
+
+inline crash_flush_fn& crash_flush_hook() noexcept {
+	static crash_flush_fn hook = nullptr;
+	return hook;
+}
+
 inline void lippincott() noexcept {
 	const char* caption = "Oops... unknown error";
 	const char* msg = "An unknown exception, not derived from std::exception, was thrown.";
@@ -25,6 +35,10 @@ inline void lippincott() noexcept {
 	catch (const std::runtime_error& e)    { msg = e.what(); caption = "Oops... runtime error"; }
 	catch (const std::exception& e)        { msg = e.what(); caption = "Oops... generic error"; }
 
+	if (crash_flush_hook()) {
+		try { crash_flush_hook()(); } catch (...) { } // best effort, we're going down anyway
+	}
+
 	MessageBoxA(nullptr, msg, caption, MB_ICONERROR);
 }
 
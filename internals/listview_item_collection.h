@@ -6,7 +6,9 @@
  */
 
 #pragma once
+#include <functional>
 #include <vector>
+#include "alloc_profiler.h"
 #include "listview_item.h"
 
 namespace wl {
@@ -84,6 +86,38 @@ public:
 		return this->add_at_pos_with_icon(caption, -1, -1);
 	}
 
+	// Adds many items at once, each row being the texts of its columns. The control is
+	// pre-sized with LVM_SETITEMCOUNT, a single LVITEMW is reused across the whole loop,
+	// and redrawing is suspended until the last row is in, which is an order of magnitude
+	// faster than calling add() row by row on large report views.
+	listview_item_collection& add_batch(const std::vector<std::vector<std::wstring>>& rows) noexcept {
+		SendMessageW(this->_hList, WM_SETREDRAW, static_cast<WPARAM>(FALSE), 0);
+		size_t firstNewIndex = this->count();
+		ListView_SetItemCount(this->_hList,
+			static_cast<int>(firstNewIndex + rows.size())); // pre-allocate control-side structures
+
+		LVITEMW lvi{};
+		lvi.mask = LVIF_TEXT;
+		for (size_t r = 0; r < rows.size(); ++r) {
+			if (rows[r].empty()) continue; // a row needs at least the 1st column text
+
+			lvi.iItem = static_cast<int>(firstNewIndex + r);
+			lvi.iSubItem = 0;
+			lvi.pszText = const_cast<wchar_t*>(rows[r][0].c_str());
+			int newIndex = ListView_InsertItem(this->_hList, &lvi);
+
+			for (size_t c = 1; c < rows[r].size(); ++c) { // remaining columns of this row
+				lvi.iSubItem = static_cast<int>(c);
+				lvi.pszText = const_cast<wchar_t*>(rows[r][c].c_str());
+				SendMessageW(this->_hList, LVM_SETITEMTEXT,
+					newIndex, reinterpret_cast<LPARAM>(&lvi));
+			}
+		}
+
+		SendMessageW(this->_hList, WM_SETREDRAW, static_cast<WPARAM>(TRUE), 0);
+		return *this;
+	}
+
 	// Returns a vector with all items in the listview.
 	std::vector<listview_item> get_all() const {
 		size_t totItems = this->count();
@@ -213,17 +247,63 @@ public:
 		return (iFoc == -1) ? listview_item::npos : static_cast<size_t>(iFoc);
 	}
 
-	// Return the texts, from the given column, from the given items.
+	// Return the texts, from the given column, from the given items. One buffer is
+	// reused for every LVM_GETITEMTEXT, so in steady state each cell costs a single
+	// message round-trip; only the returned strings themselves are allocated.
 	std::vector<std::wstring> get_texts(const std::vector<listview_item>& itemsToGet,
 		size_t columnIndex = 0) const
 	{
 		std::vector<std::wstring> texts;
 		texts.reserve(itemsToGet.size());
+
+		std::wstring buf;
 		for (const listview_item& oneItem : itemsToGet) {
-			texts.emplace_back(oneItem.get_text(columnIndex));
+			size_t len = this->_get_text_into(buf, oneItem.index, columnIndex);
+			texts.emplace_back(buf.data(), len);
 		}
 		return texts;
 	}
+
+	// Passes the text of each given item, from the given column, to the callback as
+	// a raw pointer, valid only for the duration of the call. The whole batch runs
+	// over one reused buffer, with no per-cell allocation at all; suited for export
+	// paths that stream millions of cells.
+	const listview_item_collection& for_each_text(const std::vector<listview_item>& itemsToGet,
+		size_t columnIndex, std::function<void(const wchar_t*)> callback) const
+	{
+		std::wstring buf;
+		for (const listview_item& oneItem : itemsToGet) {
+			this->_get_text_into(buf, oneItem.index, columnIndex);
+			callback(buf.c_str());
+		}
+		return *this;
+	}
+
+private:
+	// Fetches one cell text into the caller's buffer, growing it only on overflow;
+	// the buffer never shrinks, so it converges to the longest cell of the batch.
+	size_t _get_text_into(std::wstring& buf, size_t itemIndex, size_t columnIndex) const {
+		LVITEMW lvi{};
+		lvi.iItem = static_cast<int>(itemIndex);
+		lvi.iSubItem = static_cast<int>(columnIndex);
+
+		if (buf.size() < 64) {
+			buf.resize(64); // arbitrary starting room
+			WINLAMB_COUNT_ALLOC(LISTVIEW, 64 * sizeof(wchar_t));
+		}
+		for (;;) {
+			lvi.cchTextMax = static_cast<int>(buf.size());
+			lvi.pszText = &buf[0];
+			int written = static_cast<int>(
+				SendMessageW(this->_hList, LVM_GETITEMTEXT,
+					itemIndex, reinterpret_cast<LPARAM>(&lvi)) );
+			if (written < static_cast<int>(buf.size()) - 1) { // must have at least 1 char gap
+				return static_cast<size_t>(written);
+			}
+			buf.resize(buf.size() * 2); // didn't fit, retry bigger
+			WINLAMB_COUNT_ALLOC(LISTVIEW, buf.size() * sizeof(wchar_t));
+		}
+	}
 };
 
 }//namespace _wli
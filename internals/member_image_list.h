@@ -7,7 +7,10 @@
 
 #pragma once
 #include <functional>
+#include <string>
 #include "../image_list.h"
+#include "thread_pool.h"
+#include "ui_marshal.h"
 
 namespace wl {
 namespace _wli {
@@ -72,6 +75,32 @@ public:
 		return this->_owner;
 	}
 
+	// Loads an icon from resource, deduplicated: a glyph already present in the
+	// list through a shared load keeps its slot instead of being added again.
+	// Returns the image list index the glyph occupies.
+	size_t load_shared_from_resource(int iconId) {
+		this->_create_if_not_yet();
+		return this->_imageList.load_shared_from_resource(iconId, this->_owner.hwnd());
+	}
+
+	// Adds every cell of a strip bitmap resource in one ImageList_Add call,
+	// instead of one icon load per glyph.
+	controlT& load_strip_from_resource(int bitmapId) {
+		this->_create_if_not_yet();
+		this->_imageList.load_strip_from_resource(bitmapId,
+			reinterpret_cast<HINSTANCE>(GetWindowLongPtrW(this->_owner.hwnd(), GWLP_HINSTANCE)));
+		return this->_owner;
+	}
+
+	// Adds every cell of a strip bitmap resource in one ImageList_Add call,
+	// rendering the given color transparent.
+	controlT& load_strip_from_resource(int bitmapId, COLORREF maskColor) {
+		this->_create_if_not_yet();
+		this->_imageList.load_strip_from_resource(bitmapId, maskColor,
+			reinterpret_cast<HINSTANCE>(GetWindowLongPtrW(this->_owner.hwnd(), GWLP_HINSTANCE)));
+		return this->_owner;
+	}
+
 	// Loads the icon used by Windows Explorer to represent the given file type.
 	controlT& load_from_shell(const wchar_t* fileExtension) {
 		this->_create_if_not_yet();
@@ -86,6 +115,43 @@ public:
 		return this->_owner;
 	}
 
+	// Like load_from_shell(), but without blocking the UI thread: the slot is
+	// filled immediately with the generic file icon, and the real one is resolved
+	// in the thread pool and swapped in through the parent window's UI-marshal
+	// channel. Returns the image list index the icon will occupy. The control
+	// must outlive any pending resolutions.
+	size_t load_from_shell_async(std::wstring fileExtension) {
+		this->_create_if_not_yet();
+		icon::res iRes = icon::util::resolve_resolution_type(this->_resolution);
+		if (iRes == icon::res::OTHER) {
+			throw std::logic_error("Trying to load icon from shell with unsupported resolution.");
+		}
+		int shilRes = static_cast<int>(iRes);
+
+		// The generic file icon is cached after the very first call, so the
+		// placeholder costs a map lookup, not a shell round-trip.
+		HICON hPlaceholder = shell_icon_cache::instance().get_or_load(L"", shilRes);
+		HIMAGELIST hImgList = this->_imageList.himagelist();
+		int newIndex = ImageList_AddIcon(hImgList, hPlaceholder);
+
+		HWND hOwner = this->_owner.hwnd();
+		thread_pool::instance().submit(
+			[hOwner, hImgList, newIndex, shilRes, ext = std::move(fileExtension)]() noexcept
+		{
+			HICON hReal = nullptr;
+			try {
+				hReal = shell_icon_cache::instance().get_or_load(ext.c_str(), shilRes);
+			} catch (...) {
+				return; // shell refused; the placeholder simply stays
+			}
+			ui_marshal::post(GetAncestor(hOwner, GA_PARENT), [hOwner, hImgList, newIndex, hReal]() noexcept {
+				ImageList_ReplaceIcon(hImgList, newIndex, hReal); // makes its own copy
+				InvalidateRect(hOwner, nullptr, FALSE); // repaint rows showing the slot
+			});
+		});
+		return static_cast<size_t>(newIndex);
+	}
+
 private:
 	void _create_if_not_yet() {
 		if (!this->_imageList.himagelist()) {
@@ -0,0 +1,104 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace wl {
+namespace _wli {
+
+// Lock-free bounded multi-producer single-consumer ring of UI callbacks, in
+// the style of the Vyukov bounded queue: every cell carries a sequence number,
+// so producers claim slots with one CAS and never touch a lock. The cells are
+// reused forever, so bursts recycle the same storage instead of allocating a
+// node per call. push() reports when the ring went empty to non-empty, which
+// is the producer's cue to post a single wake-up message for the whole batch.
+class mpsc_ui_queue final {
+private:
+	struct _cell final {
+		std::atomic<size_t>   seq;
+		std::function<void()> func;
+	};
+
+	static const size_t _CAP = 512; // power of two; beyond this, callers fall back to one post per call
+
+	std::unique_ptr<_cell[]> _cells{new _cell[_CAP]};
+	std::atomic<size_t>      _enqueuePos{0};
+	size_t                   _dequeuePos = 0; // touched by the single consumer only
+	std::atomic<size_t>      _count{0};
+
+public:
+	mpsc_ui_queue() {
+		for (size_t i = 0; i < _CAP; ++i) {
+			this->_cells[i].seq.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	mpsc_ui_queue(const mpsc_ui_queue&) = delete;
+	mpsc_ui_queue& operator=(const mpsc_ui_queue&) = delete; // atomics pin us in place
+
+	// Enqueues a callback from any thread. Returns false when the ring is full,
+	// leaving the callback untouched so the caller can take a fallback path;
+	// otherwise sets needWake when this push made the ring non-empty.
+	bool push(std::function<void()>& func, bool& needWake) noexcept {
+		size_t pos = this->_enqueuePos.load(std::memory_order_relaxed);
+		_cell* cell = nullptr;
+		for (;;) {
+			cell = &this->_cells[pos & (_CAP - 1)];
+			size_t seq = cell->seq.load(std::memory_order_acquire);
+			intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+			if (dif == 0) {
+				if (this->_enqueuePos.compare_exchange_weak(pos, pos + 1,
+					std::memory_order_relaxed))
+				{
+					break; // slot claimed
+				}
+			} else if (dif < 0) {
+				return false; // full
+			} else {
+				pos = this->_enqueuePos.load(std::memory_order_relaxed); // lost a race, retry
+			}
+		}
+
+		cell->func = std::move(func);
+		cell->seq.store(pos + 1, std::memory_order_release); // publish
+		needWake = this->_count.fetch_add(1, std::memory_order_acq_rel) == 0;
+		return true;
+	}
+
+	// Runs everything queued so far, in submission order. Must be called from
+	// the single consumer (the UI thread). If a producer has claimed a slot but
+	// not finished publishing it, postRewake is invoked so the remainder is
+	// picked up on the next pump cycle instead of spinning.
+	template<typename runT, typename rewakeT>
+	void drain(runT runOne, rewakeT postRewake) {
+		for (;;) {
+			_cell* cell = &this->_cells[this->_dequeuePos & (_CAP - 1)];
+			size_t seq = cell->seq.load(std::memory_order_acquire);
+
+			if (seq == this->_dequeuePos + 1) { // published, take it
+				std::function<void()> func = std::move(cell->func);
+				cell->func = nullptr; // release captures while the slot is ours
+				cell->seq.store(this->_dequeuePos + _CAP, std::memory_order_release); // recycle
+				++this->_dequeuePos;
+				this->_count.fetch_sub(1, std::memory_order_acq_rel);
+				runOne(func);
+			} else {
+				if (this->_count.load(std::memory_order_acquire) != 0) {
+					postRewake(); // mid-publish producer; retry next cycle
+				}
+				return;
+			}
+		}
+	}
+};
+
+}//namespace _wli
+}//namespace wl
@@ -0,0 +1,106 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include <Windows.h>
+
+namespace wl {
+namespace _wli {
+
+// Per-window bump allocator for message-lifetime scratch. Handlers borrow
+// memory that is reclaimed wholesale when the outermost handler returns, so
+// notification-heavy paths stop paying one malloc/free pair per message.
+// The slab converges to the peak usage of a dispatch cycle, after which every
+// allocation is a pointer bump.
+class msg_arena final {
+private:
+	std::unique_ptr<BYTE[]> _slab;
+	size_t                  _slabSz = 0;
+	size_t                  _used = 0;
+	size_t                  _depth = 0; // nested dispatches share the same cycle
+
+	std::vector<std::unique_ptr<BYTE[]>> _overflow; // blocks that outgrew the slab this cycle
+	size_t                               _overflowBytes = 0;
+
+public:
+	msg_arena() = default;
+	msg_arena(msg_arena&&) = default;
+	msg_arena& operator=(msg_arena&&) = default; // movable only
+
+	// Borrows raw bytes, valid until the outermost handler of this cycle returns.
+	void* alloc(size_t numBytes) {
+		numBytes = (numBytes + alignof(std::max_align_t) - 1)
+			& ~(alignof(std::max_align_t) - 1); // keep every borrow max-aligned
+
+		if (this->_used + numBytes <= this->_slabSz) {
+			void* p = this->_slab.get() + this->_used;
+			this->_used += numBytes;
+			return p; // warm path, no heap at all
+		}
+
+		// Doesn't fit; serve from a dedicated block and note the shortfall, so the
+		// slab grows to cover everything on the next reset. Growing the slab now
+		// would invalidate the borrows already handed out this cycle.
+		this->_overflow.emplace_back(new BYTE[numBytes]);
+		this->_overflowBytes += numBytes;
+		return this->_overflow.back().get();
+	}
+
+	// Borrows an array of a trivially destructible type.
+	template<typename T>
+	T* alloc_array(size_t numElems) {
+		static_assert(std::is_trivially_destructible<T>::value,
+			"The arena never runs destructors, only trivially destructible types can live in it.");
+		return static_cast<T*>(this->alloc(numElems * sizeof(T)));
+	}
+
+	// Copies a zero-terminated string into the arena.
+	wchar_t* strdup(const wchar_t* text) {
+		size_t numChars = lstrlenW(text) + 1; // including terminating null
+		wchar_t* copy = this->alloc_array<wchar_t>(numChars);
+		memcpy(copy, text, numChars * sizeof(wchar_t));
+		return copy;
+	}
+
+	// Brackets one message dispatch; nested dispatches stack, and the memory is
+	// reclaimed only when the outermost one ends.
+	void begin_dispatch() noexcept {
+		++this->_depth;
+	}
+
+	void end_dispatch() {
+		if (--this->_depth) return; // a nested dispatch, outer borrows still alive
+
+		if (this->_overflowBytes) { // grow the slab to this cycle's peak
+			this->_slabSz = this->_used + this->_overflowBytes;
+			this->_slab.reset(new BYTE[this->_slabSz]);
+			this->_overflow.clear();
+			this->_overflowBytes = 0;
+		}
+		this->_used = 0;
+	}
+
+	// RAII bracket used by base_msg around each handler invocation.
+	class dispatch_scope final {
+	private:
+		msg_arena& _owner;
+	public:
+		explicit dispatch_scope(msg_arena& owner) noexcept : _owner(owner) {
+			this->_owner.begin_dispatch();
+		}
+		~dispatch_scope() {
+			this->_owner.end_dispatch();
+		}
+	};
+};
+
+}//namespace _wli
+}//namespace wl
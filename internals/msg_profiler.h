@@ -0,0 +1,112 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#ifdef WINLAMB_PROFILE_MSGS // opt-in; without the define this header is empty
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <Windows.h>
+#include "str_priv.h"
+
+namespace wl {
+namespace _wli {
+
+// Aggregates the time spent inside message handler lambdas of one window.
+// Only compiled when WINLAMB_PROFILE_MSGS is defined, so release builds
+// carry neither the bookkeeping nor the QueryPerformanceCounter calls.
+class msg_profiler final {
+private:
+	struct _slot final {
+		UINT      msg = 0;
+		size_t    count = 0;
+		long long totalUs = 0; // microseconds
+		long long maxUs = 0;
+	};
+
+	std::vector<_slot> _slots; // sorted by msg, tiny set in practice
+	std::function<void(UINT, long long)> _callback;
+
+public:
+	// Times one handler invocation; records on destruction, so the duration
+	// is captured even when the handler throws.
+	class scope final {
+	private:
+		msg_profiler& _owner;
+		UINT          _msg;
+		long long     _t0;
+
+	public:
+		scope(msg_profiler& owner, UINT msg) noexcept :
+			_owner(owner), _msg(msg), _t0(_now_us()) { }
+
+		~scope() {
+			this->_owner._record(this->_msg, _now_us() - this->_t0);
+		}
+	};
+
+	// Assigns a lambda to be called with (message id, duration in microseconds)
+	// after each handler runs; pass an empty function to unhook.
+	void on_handler_timed(std::function<void(UINT, long long)> callback) {
+		this->_callback = std::move(callback);
+	}
+
+	// Discards every aggregated sample.
+	void reset() noexcept {
+		this->_slots.clear();
+	}
+
+	// Returns the aggregated per-message totals as a printable table,
+	// worst total first, ready for OutputDebugString or a log file.
+	std::wstring dump() const {
+		std::vector<_slot> sorted = this->_slots;
+		std::sort(sorted.begin(), sorted.end(), [](const _slot& a, const _slot& b) noexcept -> bool {
+			return a.totalUs > b.totalUs;
+		});
+
+		std::wstring ret = L"msg        count      total us     avg us     max us\n";
+		for (const _slot& s : sorted) {
+			ret.append(str_priv::format_raw(0, L"0x%04X %10Iu %12lld %10lld %10lld\n",
+				s.msg, s.count, s.totalUs, s.totalUs / static_cast<long long>(s.count), s.maxUs));
+		}
+		return ret;
+	}
+
+private:
+	void _record(UINT msg, long long durationUs) {
+		std::vector<_slot>::iterator it = std::lower_bound(
+			this->_slots.begin(), this->_slots.end(), msg,
+			[](const _slot& s, UINT m) noexcept -> bool {
+				return s.msg < m;
+			});
+		if (it == this->_slots.end() || it->msg != msg) {
+			it = this->_slots.insert(it, _slot{msg});
+		}
+		++it->count;
+		it->totalUs += durationUs;
+		if (durationUs > it->maxUs) it->maxUs = durationUs;
+
+		if (this->_callback) this->_callback(msg, durationUs);
+	}
+
+	static long long _now_us() noexcept {
+		static LARGE_INTEGER freq = []() noexcept -> LARGE_INTEGER {
+			LARGE_INTEGER f{};
+			QueryPerformanceFrequency(&f);
+			return f;
+		}();
+		LARGE_INTEGER now{};
+		QueryPerformanceCounter(&now);
+		return now.QuadPart * 1'000'000 / freq.QuadPart;
+	}
+};
+
+}//namespace _wli
+}//namespace wl
+
+#endif//WINLAMB_PROFILE_MSGS
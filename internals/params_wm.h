@@ -8,6 +8,7 @@
 #pragma once
 #include <string>
 #include <vector>
+#include "msg_arena.h"
 #include "params.h"
 
 namespace wl {
@@ -39,8 +40,23 @@ namespace wm {
 	struct notify : public params {
 		notify(const params& p) noexcept : params(p) { }
 		NMHDR& nmhdr() const noexcept { return *reinterpret_cast<NMHDR*>(this->lParam); }
+
+		// Copies the full notification struct into the window's message arena,
+		// giving the handler a mutable copy without touching the heap.
+		template<typename nmT>
+		nmT* copy_nm(_wli::msg_arena& arena) const {
+			nmT* copy = arena.alloc_array<nmT>(1);
+			memcpy(copy, reinterpret_cast<nmT*>(this->lParam), sizeof(nmT));
+			return copy;
+		}
 	};
 
+	// Duplicates a zero-terminated string into the window's message arena; the
+	// copy is valid until the current handler returns, with no heap traffic.
+	inline wchar_t* stash_text(_wli::msg_arena& arena, const wchar_t* text) {
+		return arena.strdup(text);
+	}
+
 	struct activate : public params {
 		activate(const params& p) noexcept : params(p) { }
 		bool is_being_activated() const noexcept           { return this->wParam != WA_INACTIVE; }
@@ -10,6 +10,7 @@
 #include <Windows.h>
 #include <CommCtrl.h>
 #include "lippincott.h"
+#include "startup_profiler.h"
 #pragma comment(lib, "Comctl32.lib")
 
 namespace wl {
@@ -19,7 +20,9 @@ template<typename wnd_mainT>
 int run_main(HINSTANCE hInst, int cmdShow) noexcept {
 	int ret = 0;
 	try { // any exception which was not caught, except those from within message lambdas
+		startup_profiler::instance().mark(L"crt-done"); // also takes the timing baseline
 		wnd_mainT wndMain;
+		startup_profiler::instance().mark(L"main-window-constructed");
 		ret = wndMain.winmain_run(hInst, cmdShow);
 	} catch (...) {
 		lippincott();
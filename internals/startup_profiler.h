@@ -0,0 +1,105 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <cwchar>
+#include <string>
+#include <vector>
+#include <Windows.h>
+#include <evntprov.h>
+#pragma comment(lib, "Advapi32.lib")
+
+namespace wl {
+namespace _wli {
+
+// Records where process startup time goes: named phase markers (CRT done,
+// first class registered, first window created, first paint) are timestamped
+// against a QueryPerformanceCounter baseline taken at first touch, kept for
+// in-process queries and also emitted as ETW events, so xperf/WPA traces show
+// them on the same timeline as the rest of the system. Each phase is recorded
+// only once — later marks with a known name are ignored — and marks are
+// expected from the UI thread.
+class startup_profiler final {
+public:
+	struct phase final {
+		std::wstring name;
+		double       msSinceBase = 0;
+	};
+
+private:
+	LARGE_INTEGER      _qpcBase{};
+	LARGE_INTEGER      _qpcFreq{};
+	REGHANDLE          _hEtwProvider = 0;
+	std::vector<phase> _phases;
+
+	startup_profiler() noexcept {
+		QueryPerformanceCounter(&this->_qpcBase);
+		QueryPerformanceFrequency(&this->_qpcFreq);
+
+		// {7E1C1A2B-98D4-4C8F-B0A3-6F2D51E90C47} - WinLamb startup phases.
+		static const GUID providerGuid = {0x7E1C1A2B, 0x98D4, 0x4C8F,
+			{0xB0, 0xA3, 0x6F, 0x2D, 0x51, 0xE9, 0x0C, 0x47}};
+		EventRegister(&providerGuid, nullptr, nullptr, &this->_hEtwProvider); // failure just mutes ETW
+		this->_phases.reserve(8);
+	}
+
+public:
+	~startup_profiler() {
+		if (this->_hEtwProvider) {
+			EventUnregister(this->_hEtwProvider);
+		}
+	}
+
+	startup_profiler(const startup_profiler&) = delete;
+	startup_profiler& operator=(const startup_profiler&) = delete;
+
+	static startup_profiler& instance() {
+		static startup_profiler obj; // thread-safe in C++11; baseline taken here
+		return obj;
+	}
+
+	// Records the phase at the current timestamp; a name already recorded is
+	// ignored, so hot paths can mark unconditionally.
+	void mark(const wchar_t* phaseName) noexcept {
+		for (const phase& ph : this->_phases) {
+			if (ph.name == phaseName) return; // first occurrence wins
+		}
+
+		LARGE_INTEGER now{};
+		QueryPerformanceCounter(&now);
+		double ms = static_cast<double>(now.QuadPart - this->_qpcBase.QuadPart)
+			* 1000.0 / static_cast<double>(this->_qpcFreq.QuadPart);
+
+		try {
+			this->_phases.push_back({phaseName, ms});
+		} catch (...) {
+			return; // out of memory, drop the mark
+		}
+
+		if (this->_hEtwProvider) {
+			wchar_t buf[160]{};
+			swprintf(buf, 160, L"winlamb-startup: %s at %.3f ms", phaseName, ms);
+			EventWriteString(this->_hEtwProvider, 4, 0, buf); // informational level
+		}
+	}
+
+	// All phases recorded so far, in the order they happened.
+	const std::vector<phase>& phases() const noexcept {
+		return this->_phases;
+	}
+
+	// Milliseconds of the given phase since the baseline, or -1 if never marked.
+	double ms_of(const wchar_t* phaseName) const noexcept {
+		for (const phase& ph : this->_phases) {
+			if (ph.name == phaseName) return ph.msSinceBase;
+		}
+		return -1;
+	}
+};
+
+}//namespace _wli
+}//namespace wl
@@ -1,72 +1,177 @@
-/**
- * Part of WinLamb - Win32 API Lambda Library
- * https://github.com/rodrigocfd/winlamb
- * Copyright 2017-present Rodrigo Cesar de Freitas Dias
- * This library is released under the MIT License
- */
-
-#pragma once
-#include <functional>
-#include <vector>
-#include "params.h"
-
-namespace wl {
-namespace _wli {
-
-// Generic storage for message identifiers and their respective lambda handlers.
-template<typename idT, typename retT>
-class store final {
-private:
-	struct _msg_unit final {
-		idT                         id;   // UINT, WORD or {UINT_PTR, UINT}
-		std::function<retT(params)> func; // retT is LRESULT or INT_PTR
-
-		_msg_unit() = default;
-		_msg_unit(idT id, std::function<retT(params)> func) noexcept :
-			id(id), func(std::move(func)) { }
-	};
-
-	std::vector<_msg_unit> _msgUnits;
-
-public:
-	explicit store(size_t msgsReserve = 0) {
-		this->reserve(msgsReserve); // initial reserve is useful to save realloc time
-		this->_msgUnits.emplace_back(); // 1st element is sentinel room
-	}
-
-	bool empty() const noexcept {
-		return this->_msgUnits.size() == 1; // sentinel always present
-	}
-
-	void reserve(size_t msgsReserve) {
-		this->_msgUnits.reserve(msgsReserve + 1); // +1 because sentinel
-	}
-
-	void add(idT id, std::function<retT(params)> func) {
-		this->_msgUnits.emplace_back(id, std::move(func)); // reverse search: messages can be overwritten by a later one
-	}
-
-	void add(std::initializer_list<idT> ids, std::function<retT(params)> func) {
-		const idT* pIds = ids.begin();
-		this->add(pIds[0], std::move(func)); // store user func once
-		size_t funcIdx = this->_msgUnits.size() - 1;
-		for (size_t i = 1; i < ids.size(); ++i) {
-			if (pIds[i] != pIds[0]) { // avoid overwriting
-				this->add(pIds[i], [this, funcIdx](params p) -> retT {
-					return this->_msgUnits[funcIdx].func(p); // store light wrapper to 1st func
-				});
-			}
-		}
-	}
-
-	std::function<retT(params)>* find(idT id) {
-		this->_msgUnits[0].id = id; // sentinel for reverse linear search
-		_msg_unit* revRunner = &this->_msgUnits.back(); // pointer to last element
-		while (revRunner->id != id) --revRunner;
-		return revRunner == &this->_msgUnits[0] ? // if we stopped only at 1st element, id wasn't found
-			nullptr : &revRunner->func;
-	}
-};
-
-}//namespace _wli
-}//namespace wl
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "alloc_profiler.h"
+#include "inline_func.h"
+#include "params.h"
+
+namespace wl {
+namespace _wli {
+
+// Folds a message identifier into the bit position of the store filter bitmap.
+inline size_t filter_hash_id(UINT id) noexcept {
+	return id;
+}
+inline size_t filter_hash_id(WORD id) noexcept {
+	return id;
+}
+inline size_t filter_hash_id(const std::pair<UINT_PTR, UINT>& id) noexcept {
+	return static_cast<size_t>(id.first * 31 + id.second);
+}
+
+// Generic storage for message identifiers and their respective lambda handlers.
+template<typename idT, typename retT>
+class store final {
+private:
+	struct _msg_unit final {
+		idT                       id;   // UINT, WORD or {UINT_PTR, UINT}
+		inline_func<retT(params)> func; // retT is LRESULT or INT_PTR
+
+		_msg_unit() = default;
+		_msg_unit(idT id, inline_func<retT(params)> func) noexcept :
+			id(id), func(std::move(func)) { }
+	};
+
+	struct _idx_unit final {
+		idT    id;
+		size_t slot; // index into _msgUnits
+
+		_idx_unit(idT id, size_t slot) noexcept :
+			id(id), slot(slot) { }
+	};
+
+	std::vector<_msg_unit> _msgUnits;
+	std::vector<_idx_unit> _index; // sorted by id, built lazily on 1st find() after last add()
+	std::shared_ptr<const std::vector<_idx_unit>> _sharedIndex; // class-level snapshot, see adopt_or_publish_layout
+	bool                   _indexDirty = true;
+	unsigned long long     _filterBits[16]{}; // 1024-bit occupancy bloom over hashed ids
+
+public:
+	explicit store(size_t msgsReserve = 0) {
+		this->reserve(msgsReserve); // initial reserve is useful to save realloc time
+		this->_msgUnits.emplace_back(); // 1st element is sentinel room
+	}
+
+	bool empty() const noexcept {
+		return this->_msgUnits.size() == 1; // sentinel always present
+	}
+
+	void reserve(size_t msgsReserve) {
+		this->_msgUnits.reserve(msgsReserve + 1); // +1 because sentinel
+	}
+
+	void add(idT id, inline_func<retT(params)> func) {
+		WINLAMB_COUNT_ALLOC(STORE, sizeof(_msg_unit)); // slot growth, plus whatever the func captured
+		this->_msgUnits.emplace_back(id, std::move(func)); // messages can be overwritten by a later one
+		this->_indexDirty = true;
+		this->_sharedIndex.reset(); // a dynamic addition outgrows the class snapshot
+
+		size_t h = filter_hash_id(id) & 1023;
+		this->_filterBits[h >> 6] |= 1ull << (h & 63); // bits are never cleared, only added
+	}
+
+	// Cheap negative filter: false guarantees the id is not in the store, so the
+	// caller can skip find() — and the index rebuild it may trigger — entirely.
+	// True only means "possibly present" (hash collisions are allowed).
+	bool can_match(idT id) const noexcept {
+		size_t h = filter_hash_id(id) & 1023;
+		return (this->_filterBits[h >> 6] & (1ull << (h & 63))) != 0;
+	}
+
+	void add(std::initializer_list<idT> ids, inline_func<retT(params)> func) {
+		const idT* pIds = ids.begin();
+		this->add(pIds[0], std::move(func)); // store user func once
+		size_t funcIdx = this->_msgUnits.size() - 1;
+		for (size_t i = 1; i < ids.size(); ++i) {
+			if (pIds[i] != pIds[0]) { // avoid overwriting
+				this->add(pIds[i], [this, funcIdx](params p) -> retT {
+					return this->_msgUnits[funcIdx].func(p); // store light wrapper to 1st func
+				});
+			}
+		}
+	}
+
+	inline_func<retT(params)>* find(idT id) {
+		const std::vector<_idx_unit>* pIdx = this->_sharedIndex ?
+			this->_sharedIndex.get() : &this->_index;
+		if (!this->_sharedIndex && this->_indexDirty) {
+			this->_rebuild_index(); // lazy, once after the last add()
+		}
+		auto matched = std::lower_bound(pIdx->begin(), pIdx->end(), id,
+			[](const _idx_unit& entry, const idT& id) noexcept -> bool {
+				return entry.id < id;
+			});
+		return matched == pIdx->end() || matched->id != id ? // not found
+			nullptr : &this->_msgUnits[matched->slot].func;
+	}
+
+	// Adopts the sorted index published by an earlier instance under the same
+	// key, when the registered id sequence matches exactly — constructors of the
+	// same window class register the same handlers in the same order, so clones
+	// skip the sort and share one index allocation. The first instance under a
+	// key builds and publishes; a mismatching sequence just keeps its private
+	// index. A later add() drops back to the private index transparently.
+	void adopt_or_publish_layout(size_t key) {
+		struct _published final {
+			size_t                                       key;
+			std::vector<idT>                             idSeq;
+			std::shared_ptr<const std::vector<_idx_unit>> index;
+		};
+		static std::vector<_published> published; // per template instantiation
+		static std::mutex              publishedMutex;
+
+		std::vector<idT> myIdSeq;
+		myIdSeq.reserve(this->_msgUnits.size() - 1);
+		for (size_t i = 1; i < this->_msgUnits.size(); ++i) { // skip sentinel
+			myIdSeq.emplace_back(this->_msgUnits[i].id);
+		}
+
+		std::lock_guard<std::mutex> lock(publishedMutex);
+		for (const _published& pub : published) {
+			if (pub.key == key) {
+				if (pub.idSeq == myIdSeq) { // slots are valid for us too, then
+					this->_sharedIndex = pub.index;
+					this->_index.clear();
+					this->_index.shrink_to_fit();
+				}
+				return; // on mismatch, keep the private index
+			}
+		}
+
+		this->_rebuild_index();
+		published.push_back({key, std::move(myIdSeq),
+			std::make_shared<const std::vector<_idx_unit>>(this->_index)});
+	}
+
+private:
+	void _rebuild_index() {
+		this->_index.clear();
+		this->_index.reserve(this->_msgUnits.size() - 1); // minus sentinel
+		for (size_t i = 1; i < this->_msgUnits.size(); ++i) { // skip sentinel
+			this->_index.emplace_back(this->_msgUnits[i].id, i);
+		}
+		std::stable_sort(this->_index.begin(), this->_index.end(),
+			[](const _idx_unit& a, const _idx_unit& b) noexcept -> bool {
+				return a.id < b.id;
+			});
+		auto uniqEnd = std::unique(this->_index.rbegin(), this->_index.rend(), // keep the last duplicate:
+			[](const _idx_unit& a, const _idx_unit& b) noexcept -> bool {      // later registrations win
+				return a.id == b.id;
+			});
+		this->_index.erase(this->_index.begin(), uniqEnd.base());
+		this->_indexDirty = false;
+	}
+};
+
+}//namespace _wli
+}//namespace wl
@@ -7,8 +7,14 @@
 
 #pragma once
 #include <cwctype>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <Windows.h>
+#include "alloc_profiler.h"
+#if defined(_M_IX86) || defined(_M_X64)
+	#include <emmintrin.h> // SSE2, baseline on both x86 and x64 targets
+#endif
 
 namespace wl {
 namespace _wli {
@@ -33,11 +39,78 @@ inline std::wstring format_raw(size_t strFormatLen, const wchar_t* strFormat, co
 	// https://stackoverflow.com/a/514921/6923555
 	size_t len = swprintf(nullptr, 0, strFormat, format_raw_arg(args)...);
 	std::wstring ret(len + 1, L'\0'); // room for terminating null
+	WINLAMB_COUNT_ALLOC(STR, (len + 1) * sizeof(wchar_t));
 	swprintf(&ret[0], len + 1, strFormat, format_raw_arg(args)...);
 	ret.resize(len); // remove terminating null
 	return ret;
 }
 
+template<typename ...argsT>
+inline void format_raw_to(std::wstring& dest, const wchar_t* strFormat, const argsT&... args) {
+	// Tries straight into the existing capacity first; only on overflow does the
+	// classic probe-and-resize, so a warm buffer is formatted in a single pass.
+	size_t room = dest.capacity();
+	dest.resize(room);
+
+	int written = -1;
+	if (room) {
+		written = swprintf(&dest[0], room, strFormat, format_raw_arg(args)...);
+	}
+	if (written < 0) { // didn't fit, probe the needed length and go again
+		size_t len = swprintf(nullptr, 0, strFormat, format_raw_arg(args)...);
+		dest.resize(len + 1); // room for terminating null
+		WINLAMB_COUNT_ALLOC(STR, (len + 1) * sizeof(wchar_t)); // only the overflow path reallocates
+		written = swprintf(&dest[0], len + 1, strFormat, format_raw_arg(args)...);
+	}
+	dest.resize(written);
+}
+
+// Returns the index of the next occurrence of ch at or past from, or npos.
+// Scans 8 wchar_t per iteration with SSE2 where available, so delimiter search
+// over big buffers is memory-bandwidth-bound instead of loop-bound.
+inline size_t find_char(const wchar_t* p, size_t len, size_t from, wchar_t ch) noexcept {
+	size_t i = from;
+#if defined(_M_IX86) || defined(_M_X64)
+	const __m128i needle = _mm_set1_epi16(static_cast<short>(ch));
+	for (; i + 8 <= len; i += 8) {
+		__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+		int mask = _mm_movemask_epi8(_mm_cmpeq_epi16(chunk, needle));
+		if (mask) {
+			unsigned long bitIdx = 0;
+			_BitScanForward(&bitIdx, static_cast<unsigned long>(mask));
+			return i + bitIdx / 2; // 2 mask bits per wchar_t
+		}
+	}
+#endif
+	for (; i < len; ++i) { // scalar tail, or whole scan on other architectures
+		if (p[i] == ch) return i;
+	}
+	return static_cast<size_t>(-1); // std::wstring::npos
+}
+
+// Returns the index of the first byte above 0x7F, or len if the buffer is
+// pure ASCII. Sweeps 16 bytes per iteration with SSE2 where available — the
+// sign-bit movemask is exactly the "non-ASCII" test — so encoding sniffing
+// over big buffers costs one vector pass instead of a byte loop.
+inline size_t find_non_ascii(const BYTE* p, size_t len) noexcept {
+	size_t i = 0;
+#if defined(_M_IX86) || defined(_M_X64)
+	for (; i + 16 <= len; i += 16) {
+		__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+		int mask = _mm_movemask_epi8(chunk); // one bit per byte >= 0x80
+		if (mask) {
+			unsigned long bitIdx = 0;
+			_BitScanForward(&bitIdx, static_cast<unsigned long>(mask));
+			return i + bitIdx;
+		}
+	}
+#endif
+	for (; i < len; ++i) { // scalar tail, or whole scan on other architectures
+		if (p[i] > 0x7F) return i;
+	}
+	return len;
+}
+
 inline bool ends_begins_first_check(const std::wstring& s, const wchar_t* what, size_t& whatLen) noexcept {
 	if (s.empty()) return false;
 
@@ -48,34 +121,102 @@ inline bool ends_begins_first_check(const std::wstring& s, const wchar_t* what,
 	return true;
 }
 
-inline std::wstring parse_ascii(const BYTE* data, size_t sz) {
-	std::wstring ret;
+inline void parse_ascii_to(std::wstring& dest, const BYTE* data, size_t sz) {
+	dest.clear();
 	if (data && sz) {
-		ret.resize(sz);
-		for (size_t i = 0; i < sz; ++i) {
+		dest.resize(sz);
+		size_t i = 0;
+#if defined(_M_IX86) || defined(_M_X64)
+		// Widen 16 bytes per iteration; zero-extension through unpack-with-zero is
+		// exactly the raw conversion of the scalar loop below. Bail to scalar at
+		// the first block holding a terminating null.
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 16 <= sz; i += 16) {
+			__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero))) break; // embedded null
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&dest[i]),
+				_mm_unpacklo_epi8(chunk, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&dest[i + 8]),
+				_mm_unpackhi_epi8(chunk, zero));
+		}
+#endif
+		for (; i < sz; ++i) {
 			if (!data[i]) { // found terminating null
-				ret.resize(i);
-				return ret;
+				dest.resize(i);
+				return;
 			}
-			ret[i] = static_cast<wchar_t>(data[i]); // raw conversion
+			dest[i] = static_cast<wchar_t>(data[i]); // raw conversion
 		}
 	}
-	return ret; // data didn't have a terminating null
 }
 
-inline std::wstring parse_encoded(const BYTE* data, size_t sz, UINT codePage) {
+inline std::wstring parse_ascii(const BYTE* data, size_t sz) {
 	std::wstring ret;
+	parse_ascii_to(ret, data, sz);
+	return ret;
+}
+
+inline void parse_encoded_to(std::wstring& dest, const BYTE* data, size_t sz, UINT codePage) {
+	dest.clear();
 	if (data && sz) {
 		int neededLen = MultiByteToWideChar(codePage, 0, reinterpret_cast<const char*>(data),
 			static_cast<int>(sz), nullptr, 0);
-		ret.resize(neededLen);
+		dest.resize(neededLen);
 		MultiByteToWideChar(codePage, 0, reinterpret_cast<const char*>(data),
-			static_cast<int>(sz), &ret[0], neededLen);
-		ret.resize( lstrlenW(ret.c_str()) ); // trim_nulls()
+			static_cast<int>(sz), &dest[0], neededLen);
+		dest.resize( lstrlenW(dest.c_str()) ); // trim_nulls()
 	}
+}
+
+inline std::wstring parse_encoded(const BYTE* data, size_t sz, UINT codePage) {
+	std::wstring ret;
+	parse_encoded_to(ret, data, sz, codePage);
 	return ret;
 }
 
+// Process-wide refcounted storage behind str::intern. Each distinct string
+// lives exactly once in the map; handles keep a pointer to the node, which is
+// stable across rehashes, so c_str() stays valid for the handle's lifetime.
+// Guarded by a mutex, usable from worker threads filling UI models.
+class intern_pool final {
+public:
+	using entry = std::pair<const std::wstring, size_t>; // text, refcount
+
+private:
+	std::unordered_map<std::wstring, size_t> _entries;
+	std::mutex _entriesMutex;
+
+	intern_pool() = default;
+
+public:
+	intern_pool(const intern_pool&) = delete;
+	intern_pool& operator=(const intern_pool&) = delete;
+
+	static intern_pool& instance() {
+		static intern_pool pool; // thread-safe in C++11
+		return pool;
+	}
+
+	entry* acquire(const wchar_t* s) {
+		std::lock_guard<std::mutex> lock(this->_entriesMutex);
+		auto inserted = this->_entries.emplace(s, 0); // finds the existing node, if any
+		++inserted.first->second;
+		return &*inserted.first;
+	}
+
+	void add_ref(entry* pEntry) noexcept {
+		std::lock_guard<std::mutex> lock(this->_entriesMutex);
+		++pEntry->second;
+	}
+
+	void release(entry* pEntry) noexcept {
+		std::lock_guard<std::mutex> lock(this->_entriesMutex);
+		if (!--pEntry->second) {
+			this->_entries.erase(pEntry->first); // last handle gone, free the storage
+		}
+	}
+};
+
 }//namespace str_priv
 }//namespace wli
 }//namespace wl
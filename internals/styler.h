@@ -1,60 +1,118 @@
-/**
- * Part of WinLamb - Win32 API Lambda Library
- * https://github.com/rodrigocfd/winlamb
- * Copyright 2017-present Rodrigo Cesar de Freitas Dias
- * This library is released under the MIT License
- */
-
-#pragma once
-#include <Windows.h>
-
-namespace wl {
-namespace _wli {
-
-// Wraps window style changes done by Get/SetWindowLongPtr, and allows custom methods.
-template<typename wndT>
-class styler {
-public:
-	wndT& target;
-
-	explicit styler(wndT* targetWnd) noexcept :
-		target(*targetWnd) { }
-
-	styler(styler&&) = default;
-	styler& operator=(styler&&) = default; // movable only
-
-	// Sets an ordinary window style, wraps SetWindowLongPtr.
-	wndT& set_style(bool addStyle, DWORD styleFlags) noexcept {
-		return this->_change_style_flags(false, addStyle, styleFlags);
-	}
-
-	// Sets an extended window style, wraps SetWindowLongPtr.
-	wndT& set_style_ex(bool addStyle, DWORD styleFlags) noexcept {
-		return this->_change_style_flags(true, addStyle, styleFlags);
-	}
-
-	// Wraps GetWindowLongPtr to retrieve an ordinary window style.
-	bool has_style(DWORD styleFlags) const noexcept {
-		return (GetWindowLongPtrW(this->target.hwnd(), GWL_STYLE) & styleFlags) != 0;
-	}
-
-	// Wraps GetWindowLongPtr to retrieve an extended window style.
-	bool has_style_ex(DWORD styleFlags) const noexcept {
-		return (GetWindowLongPtrW(this->target.hwnd(), GWL_EXSTYLE) & styleFlags) != 0;
-	}
-
-private:
-	wndT& _change_style_flags(bool isEx, bool addStyle, DWORD styleFlags) noexcept {
-		LONG_PTR curFlags = GetWindowLongPtrW(this->target.hwnd(), isEx ? GWL_EXSTYLE : GWL_STYLE);
-		if (addStyle) {
-			curFlags |= static_cast<LONG_PTR>(styleFlags);
-		} else {
-			curFlags &= ~static_cast<LONG_PTR>(styleFlags);
-		}
-		SetWindowLongPtrW(this->target.hwnd(), isEx ? GWL_EXSTYLE : GWL_STYLE, curFlags);
-		return this->target;
-	}
-};
-
-}//namespace _wli
-}//namespace wl
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <Windows.h>
+
+namespace wl {
+namespace _wli {
+
+// Wraps window style changes done by Get/SetWindowLongPtr, and allows custom methods.
+template<typename wndT>
+class styler {
+private:
+	// Batch transaction state: between begin_batch and apply_batch the setters
+	// only accumulate bits here, and the window is touched once at the end.
+	bool     _batching = false;
+	LONG_PTR _batchAdd = 0;
+	LONG_PTR _batchClear = 0;
+	LONG_PTR _batchAddEx = 0;
+	LONG_PTR _batchClearEx = 0;
+
+public:
+	wndT& target;
+
+	explicit styler(wndT* targetWnd) noexcept :
+		target(*targetWnd) { }
+
+	styler(styler&&) = default;
+	styler& operator=(styler&&) = default; // movable only
+
+	// Sets an ordinary window style, wraps SetWindowLongPtr.
+	wndT& set_style(bool addStyle, DWORD styleFlags) noexcept {
+		return this->_change_style_flags(false, addStyle, styleFlags);
+	}
+
+	// Sets an extended window style, wraps SetWindowLongPtr.
+	wndT& set_style_ex(bool addStyle, DWORD styleFlags) noexcept {
+		return this->_change_style_flags(true, addStyle, styleFlags);
+	}
+
+	// Wraps GetWindowLongPtr to retrieve an ordinary window style.
+	bool has_style(DWORD styleFlags) const noexcept {
+		return (GetWindowLongPtrW(this->target.hwnd(), GWL_STYLE) & styleFlags) != 0;
+	}
+
+	// Wraps GetWindowLongPtr to retrieve an extended window style.
+	bool has_style_ex(DWORD styleFlags) const noexcept {
+		return (GetWindowLongPtrW(this->target.hwnd(), GWL_EXSTYLE) & styleFlags) != 0;
+	}
+
+	// Starts a style transaction: every set_style/set_style_ex until
+	// apply_batch, including the control-specific setters of the derived
+	// stylers, just accumulates bits. The window then pays one
+	// SetWindowLongPtr per touched category and a single frame
+	// recalculation, instead of one per style changed.
+	wndT& begin_batch() noexcept {
+		this->_batching = true;
+		this->_batchAdd = this->_batchClear = 0;
+		this->_batchAddEx = this->_batchClearEx = 0;
+		return this->target;
+	}
+
+	// Ends the transaction started by begin_batch, applying all accumulated
+	// style changes at once, with one SWP_FRAMECHANGED notification.
+	wndT& apply_batch() noexcept {
+		this->_batching = false;
+
+		if (this->_batchAdd | this->_batchClear) {
+			LONG_PTR curFlags = GetWindowLongPtrW(this->target.hwnd(), GWL_STYLE);
+			SetWindowLongPtrW(this->target.hwnd(), GWL_STYLE,
+				(curFlags & ~this->_batchClear) | this->_batchAdd);
+		}
+		if (this->_batchAddEx | this->_batchClearEx) {
+			LONG_PTR curFlags = GetWindowLongPtrW(this->target.hwnd(), GWL_EXSTYLE);
+			SetWindowLongPtrW(this->target.hwnd(), GWL_EXSTYLE,
+				(curFlags & ~this->_batchClearEx) | this->_batchAddEx);
+		}
+
+		SetWindowPos(this->target.hwnd(), nullptr, 0, 0, 0, 0, // frame recalculated once
+			SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER | SWP_NOACTIVATE | SWP_FRAMECHANGED);
+
+		this->_batchAdd = this->_batchClear = 0;
+		this->_batchAddEx = this->_batchClearEx = 0;
+		return this->target;
+	}
+
+private:
+	wndT& _change_style_flags(bool isEx, bool addStyle, DWORD styleFlags) noexcept {
+		if (this->_batching) { // inside a transaction: last call wins per bit
+			LONG_PTR& add = isEx ? this->_batchAddEx : this->_batchAdd;
+			LONG_PTR& clear = isEx ? this->_batchClearEx : this->_batchClear;
+			if (addStyle) {
+				add |= static_cast<LONG_PTR>(styleFlags);
+				clear &= ~static_cast<LONG_PTR>(styleFlags);
+			} else {
+				clear |= static_cast<LONG_PTR>(styleFlags);
+				add &= ~static_cast<LONG_PTR>(styleFlags);
+			}
+			return this->target;
+		}
+
+		LONG_PTR curFlags = GetWindowLongPtrW(this->target.hwnd(), isEx ? GWL_EXSTYLE : GWL_STYLE);
+		if (addStyle) {
+			curFlags |= static_cast<LONG_PTR>(styleFlags);
+		} else {
+			curFlags &= ~static_cast<LONG_PTR>(styleFlags);
+		}
+		SetWindowLongPtrW(this->target.hwnd(), isEx ? GWL_EXSTYLE : GWL_STYLE, curFlags);
+		return this->target;
+	}
+};
+
+}//namespace _wli
+}//namespace wl
@@ -6,8 +6,10 @@
  */
 
 #pragma once
+#include <functional>
 #include <vector>
 #include <Windows.h>
+#include <process.h>
 
 namespace wl {
 namespace _wli {
@@ -33,6 +35,23 @@ inline std::vector<wchar_t> format_file_filter(const wchar_t* filterWithPipes) {
 	return ret;
 }
 
+// Spawns a dedicated detached thread for a modal system dialog. A pool worker
+// would be held hostage for as long as the user keeps the dialog open, so each
+// async dialog gets its own short-lived thread instead.
+inline void run_dialog_thread(std::function<void()> func) noexcept {
+	std::function<void()>* pFunc = new std::function<void()>(std::move(func));
+
+	uintptr_t hThread = _beginthreadex(nullptr, 0, [](void* ptr) noexcept -> unsigned int {
+		std::function<void()>* pFunc = reinterpret_cast<std::function<void()>*>(ptr);
+		(*pFunc)(); // the callback itself must not let exceptions escape
+		delete pFunc;
+		_endthreadex(0);
+		return 0;
+	}, pFunc, 0, nullptr);
+
+	CloseHandle(reinterpret_cast<HANDLE>(hThread));
+}
+
 }//namespace sysdlg_priv
 }//namespace _wli
 }//namespace wl
@@ -0,0 +1,87 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <Windows.h>
+#include <process.h>
+
+namespace wl {
+namespace _wli {
+
+// Process-wide pool of worker threads, shared by all windows and started lazily
+// on the first submitted task. Submitting a task is a queue push, much cheaper
+// than the thread spawn of run_thread_detached.
+class thread_pool final {
+private:
+	std::deque<std::function<void()>> _tasks;
+	std::mutex                        _tasksMtx;
+	std::condition_variable           _tasksCv;
+	bool                              _workersStarted = false;
+
+	thread_pool() = default;
+
+public:
+	thread_pool(const thread_pool&) = delete;
+	thread_pool& operator=(const thread_pool&) = delete; // non-copyable, non-movable
+
+	static thread_pool& instance() {
+		static thread_pool obj; // thread-safe in C++11
+		return obj;
+	}
+
+	// Queues a task to be run by one of the pool workers.
+	// The task itself is responsible for not letting exceptions escape.
+	void submit(std::function<void()> task) {
+		{
+			std::lock_guard<std::mutex> lock(this->_tasksMtx);
+			if (!this->_workersStarted) {
+				this->_start_workers(); // lazy, so apps that never pool pay nothing
+				this->_workersStarted = true;
+			}
+			this->_tasks.emplace_back(std::move(task));
+		}
+		this->_tasksCv.notify_one();
+	}
+
+private:
+	void _start_workers() noexcept {
+		SYSTEM_INFO si{};
+		GetNativeSystemInfo(&si);
+		DWORD numWorkers = si.dwNumberOfProcessors ? si.dwNumberOfProcessors : 2;
+
+		for (DWORD i = 0; i < numWorkers; ++i) {
+			// Workers live for the whole process; no join is ever needed.
+			uintptr_t hThread = _beginthreadex(nullptr, 0, [](void* ptr) noexcept -> unsigned int {
+				reinterpret_cast<thread_pool*>(ptr)->_worker_loop();
+				return 0;
+			}, this, 0, nullptr);
+			CloseHandle(reinterpret_cast<HANDLE>(hThread));
+		}
+	}
+
+	void _worker_loop() noexcept {
+		for (;;) {
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(this->_tasksMtx);
+				this->_tasksCv.wait(lock, [this]() noexcept -> bool {
+					return !this->_tasks.empty();
+				});
+				task = std::move(this->_tasks.front());
+				this->_tasks.pop_front();
+			}
+			task();
+		}
+	}
+};
+
+}//namespace _wli
+}//namespace wl
@@ -86,6 +86,19 @@ public:
 		return this->add_child_with_icon(caption, -1);
 	}
 
+	// Shows or hides the expand glyph regardless of actually inserted children.
+	// Together with treeview::on_populate, lets a node advertise children that
+	// will only be inserted when the user expands it.
+	treeview_item& set_has_children(bool hasChildren) noexcept {
+		TVITEMEX tvi{};
+		tvi.hItem = this->_hTreeItem;
+		tvi.mask = TVIF_CHILDREN;
+		tvi.cChildren = hasChildren ? 1 : 0;
+
+		TreeView_SetItem(this->_hTree, &tvi);
+		return *this;
+	}
+
 	treeview_item& set_select() noexcept {
 		TreeView_SelectItem(this->_hTree, this->_hTreeItem);
 		return *this;
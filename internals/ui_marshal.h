@@ -0,0 +1,43 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <exception>
+#include <functional>
+#include <Windows.h>
+
+namespace wl {
+namespace _wli {
+
+// The cross-thread UI marshal channel: a private message, handled by the
+// base_thread of every window, which carries a heap-allocated callback pack.
+// Library internals can use it to run code on the thread of any window that
+// was created through the library.
+struct ui_marshal final {
+	static const UINT WM_THREAD_MESSAGE = WM_APP + 0x3FFF;
+
+	struct pack final {
+		std::function<void()> func;
+		HWND                  hWnd = nullptr;
+		std::exception_ptr    curExcept = nullptr;
+	};
+
+	// Queues the callback to run on the thread of the given window, fire-and-forget.
+	static void post(HWND hWnd, std::function<void()> func) noexcept {
+		PostMessageW(hWnd, WM_THREAD_MESSAGE, 0,
+			reinterpret_cast<LPARAM>(new pack{std::move(func), hWnd}));
+	}
+
+	// Runs the callback on the thread of the given window, blocking until done.
+	static void send(HWND hWnd, std::function<void()> func) noexcept {
+		SendMessageW(hWnd, WM_THREAD_MESSAGE, 0,
+			reinterpret_cast<LPARAM>(new pack{std::move(func), hWnd}));
+	}
+};
+
+}//namespace _wli
+}//namespace wl
@@ -0,0 +1,276 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <stdexcept>
+#include <Windows.h>
+
+namespace wl {
+namespace _wli {
+
+// Raw DEFLATE (RFC 1951) decoder and CRC-32, used by wl::zip. Win32 offers no
+// public raw-inflate API, so the decoder is implemented here from the spec,
+// one-shot over in-memory input and output.
+class zip_priv final {
+private:
+	zip_priv() = delete;
+
+	static const int _MAX_BITS = 15;  // longest Huffman code length
+	static const int _MAX_LCODES = 286, _MAX_DCODES = 30, _MAX_CODES = 316;
+
+	struct _huffman final {
+		short count[_MAX_BITS + 1]; // number of codes of each length
+		short symbol[_MAX_LCODES];  // sorted symbols
+	};
+
+	struct _state final {
+		const BYTE* in;
+		size_t      inLen, inPos;
+		int         bitBuf, bitCnt;
+		BYTE*       out;
+		size_t      outLen, outPos;
+	};
+
+	static int _bits(_state& s, int need) {
+		long val = s.bitBuf;
+		while (s.bitCnt < need) {
+			if (s.inPos == s.inLen) {
+				throw std::runtime_error("Zip inflate: ran out of input.");
+			}
+			val |= static_cast<long>(s.in[s.inPos++]) << s.bitCnt;
+			s.bitCnt += 8;
+		}
+		s.bitBuf = static_cast<int>(val >> need);
+		s.bitCnt -= need;
+		return static_cast<int>(val & ((1L << need) - 1));
+	}
+
+	static void _stored_block(_state& s) {
+		s.bitBuf = 0; // discard bits up to the next byte boundary
+		s.bitCnt = 0;
+
+		if (s.inPos + 4 > s.inLen) {
+			throw std::runtime_error("Zip inflate: truncated stored block.");
+		}
+		unsigned len = s.in[s.inPos] | (s.in[s.inPos + 1] << 8);
+		s.inPos += 4; // skip LEN and its one's complement NLEN
+
+		if (s.inPos + len > s.inLen || s.outPos + len > s.outLen) {
+			throw std::runtime_error("Zip inflate: stored block overruns buffer.");
+		}
+		memcpy(s.out + s.outPos, s.in + s.inPos, len);
+		s.inPos += len;
+		s.outPos += len;
+	}
+
+	// Builds the Huffman decoding tables from the code lengths; returns zero on
+	// a complete code set, negative on an over-subscribed one.
+	static int _construct(_huffman& h, const short* length, int n) {
+		for (int len = 0; len <= _MAX_BITS; ++len) h.count[len] = 0;
+		for (int symbol = 0; symbol < n; ++symbol) ++h.count[length[symbol]];
+		if (h.count[0] == n) return 0; // no codes at all
+
+		int left = 1; // check for over-subscription
+		for (int len = 1; len <= _MAX_BITS; ++len) {
+			left <<= 1;
+			left -= h.count[len];
+			if (left < 0) return left;
+		}
+
+		short offs[_MAX_BITS + 1];
+		offs[1] = 0;
+		for (int len = 1; len < _MAX_BITS; ++len) {
+			offs[len + 1] = offs[len] + h.count[len];
+		}
+		for (int symbol = 0; symbol < n; ++symbol) {
+			if (length[symbol]) h.symbol[offs[length[symbol]]++] = static_cast<short>(symbol);
+		}
+		return left;
+	}
+
+	static int _decode(_state& s, const _huffman& h) {
+		int code = 0, first = 0, index = 0;
+		for (int len = 1; len <= _MAX_BITS; ++len) {
+			code |= _bits(s, 1);
+			int count = h.count[len];
+			if (code - count < first) {
+				return h.symbol[index + (code - first)];
+			}
+			index += count;
+			first += count;
+			first <<= 1;
+			code <<= 1;
+		}
+		throw std::runtime_error("Zip inflate: invalid Huffman code.");
+	}
+
+	static void _codes(_state& s, const _huffman& lenCode, const _huffman& distCode) {
+		static const short LENS[29] = { // length base for symbols 257..285
+			3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+			35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+		static const short LEXT[29] = { // extra bits for those lengths
+			0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+			3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+		static const short DISTS[30] = { // distance base for symbols 0..29
+			1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+			257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+		static const short DEXT[30] = { // extra bits for those distances
+			0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+			7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+		for (;;) {
+			int symbol = _decode(s, lenCode);
+			if (symbol < 256) { // literal byte
+				if (s.outPos == s.outLen) {
+					throw std::runtime_error("Zip inflate: output buffer too small.");
+				}
+				s.out[s.outPos++] = static_cast<BYTE>(symbol);
+			} else if (symbol == 256) { // end of block
+				return;
+			} else { // length/distance pair
+				symbol -= 257;
+				if (symbol >= 29) {
+					throw std::runtime_error("Zip inflate: invalid length symbol.");
+				}
+				int len = LENS[symbol] + _bits(s, LEXT[symbol]);
+
+				symbol = _decode(s, distCode);
+				size_t dist = DISTS[symbol] + _bits(s, DEXT[symbol]);
+				if (dist > s.outPos) {
+					throw std::runtime_error("Zip inflate: distance too far back.");
+				}
+				if (s.outPos + len > s.outLen) {
+					throw std::runtime_error("Zip inflate: output buffer too small.");
+				}
+				while (len--) {
+					s.out[s.outPos] = s.out[s.outPos - dist];
+					++s.outPos;
+				}
+			}
+		}
+	}
+
+	static void _fixed_block(_state& s) {
+		static _huffman lenCode, distCode;
+		static bool virgin = true;
+		if (virgin) { // tables are mandated by the spec, built once
+			short lengths[_MAX_LCODES + 2];
+			int symbol = 0;
+			for (; symbol < 144; ++symbol) lengths[symbol] = 8;
+			for (; symbol < 256; ++symbol) lengths[symbol] = 9;
+			for (; symbol < 280; ++symbol) lengths[symbol] = 7;
+			for (; symbol < 288; ++symbol) lengths[symbol] = 8;
+			_construct(lenCode, lengths, 288);
+			for (symbol = 0; symbol < 30; ++symbol) lengths[symbol] = 5;
+			_construct(distCode, lengths, 30);
+			virgin = false;
+		}
+		_codes(s, lenCode, distCode);
+	}
+
+	static void _dynamic_block(_state& s) {
+		static const short ORDER[19] = { // permutation of code length codes
+			16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+		int nLen = _bits(s, 5) + 257;
+		int nDist = _bits(s, 5) + 1;
+		int nCode = _bits(s, 4) + 4;
+		if (nLen > _MAX_LCODES || nDist > _MAX_DCODES) {
+			throw std::runtime_error("Zip inflate: bad dynamic block counts.");
+		}
+
+		short lengths[_MAX_CODES];
+		for (int index = 0; index < nCode; ++index) lengths[ORDER[index]] = static_cast<short>(_bits(s, 3));
+		for (int index = nCode; index < 19; ++index) lengths[ORDER[index]] = 0;
+
+		_huffman lenCode, distCode;
+		if (_construct(lenCode, lengths, 19) != 0) {
+			throw std::runtime_error("Zip inflate: incomplete code length code.");
+		}
+
+		int index = 0;
+		while (index < nLen + nDist) {
+			int symbol = _decode(s, lenCode);
+			if (symbol < 16) { // literal length
+				lengths[index++] = static_cast<short>(symbol);
+			} else {
+				int len = 0; // last length to repeat
+				if (symbol == 16) {
+					if (index == 0) {
+						throw std::runtime_error("Zip inflate: no last length to repeat.");
+					}
+					len = lengths[index - 1];
+					symbol = 3 + _bits(s, 2);
+				} else if (symbol == 17) {
+					symbol = 3 + _bits(s, 3);
+				} else {
+					symbol = 11 + _bits(s, 7);
+				}
+				if (index + symbol > nLen + nDist) {
+					throw std::runtime_error("Zip inflate: too many lengths.");
+				}
+				while (symbol--) lengths[index++] = static_cast<short>(len);
+			}
+		}
+		if (lengths[256] == 0) {
+			throw std::runtime_error("Zip inflate: missing end-of-block code.");
+		}
+
+		if (_construct(lenCode, lengths, nLen) < 0 ||
+			_construct(distCode, lengths + nLen, nDist) < 0)
+		{
+			throw std::runtime_error("Zip inflate: over-subscribed code set.");
+		}
+		_codes(s, lenCode, distCode);
+	}
+
+public:
+	// Decompresses a raw deflate stream; the exact uncompressed size must be known.
+	static void inflate(const BYTE* src, size_t srcLen, BYTE* dst, size_t dstLen) {
+		_state s{src, srcLen, 0, 0, 0, dst, dstLen, 0};
+		int last = 0;
+		do {
+			last = _bits(s, 1);
+			int type = _bits(s, 2);
+			switch (type) {
+			case 0:  _stored_block(s); break;
+			case 1:  _fixed_block(s); break;
+			case 2:  _dynamic_block(s); break;
+			default: throw std::runtime_error("Zip inflate: invalid block type.");
+			}
+		} while (!last);
+
+		if (s.outPos != dstLen) {
+			throw std::runtime_error("Zip inflate: unexpected uncompressed size.");
+		}
+	}
+
+	// CRC-32 (the zip/PNG polynomial), table built on first use.
+	static DWORD crc32(const BYTE* data, size_t numBytes, DWORD crc = 0) noexcept {
+		static DWORD table[256];
+		static bool virgin = true;
+		if (virgin) {
+			for (DWORD n = 0; n < 256; ++n) {
+				DWORD c = n;
+				for (int k = 0; k < 8; ++k) {
+					c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+				}
+				table[n] = c;
+			}
+			virgin = false;
+		}
+
+		crc = ~crc;
+		for (size_t i = 0; i < numBytes; ++i) {
+			crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return ~crc;
+	}
+};
+
+}//namespace _wli
+}//namespace wl
@@ -0,0 +1,84 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+namespace wl {
+
+// Defers the creation of groups of child controls until they are first shown.
+// Register one creation lambda per group (a tab page, a collapsible section),
+// then call ensure_created() from the handler that brings the group into view;
+// dialog open only pays for the controls the user can actually see. Pair with
+// resizer::add_late() inside the lambda so late controls pick up the current
+// window size.
+class lazy_groups final {
+private:
+	struct _group final {
+		int                   groupId;
+		std::function<void()> createFunc;
+		bool                  created = false;
+	};
+
+	std::vector<_group> _groups;
+
+public:
+	// Registers the creation code of a group of controls, to be run only when
+	// the group is first shown.
+	lazy_groups& add(int groupId, std::function<void()> createFunc) {
+		for (const _group& g : this->_groups) {
+			if (g.groupId == groupId) {
+				throw std::logic_error("Adding a lazy group twice.");
+			}
+		}
+		this->_groups.push_back({groupId, std::move(createFunc)});
+		return *this;
+	}
+
+	// Runs the creation code of the group, if it hasn't run yet; intended to be
+	// called from the tab-change or show handler. Returns true if the controls
+	// were created right now, false if they already existed.
+	bool ensure_created(int groupId) {
+		for (_group& g : this->_groups) {
+			if (g.groupId == groupId) {
+				if (g.created) return false;
+				g.created = true; // set before calling, so a throwing lambda won't re-run
+				g.createFunc();
+				return true;
+			}
+		}
+		throw std::invalid_argument("Lazy group ID not found.");
+	}
+
+	// Tells if the creation code of the group has already run.
+	bool is_created(int groupId) const {
+		for (const _group& g : this->_groups) {
+			if (g.groupId == groupId) {
+				return g.created;
+			}
+		}
+		throw std::invalid_argument("Lazy group ID not found.");
+	}
+
+	// Runs every pending creation lambda; useful before operations that must
+	// touch all controls, like reading the whole form back.
+	size_t create_all() {
+		size_t createdNow = 0;
+		for (_group& g : this->_groups) {
+			if (!g.created) {
+				g.created = true;
+				g.createFunc();
+				++createdNow;
+			}
+		}
+		return createdNow;
+	}
+};
+
+}//namespace wl
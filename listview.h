@@ -6,6 +6,9 @@
  */
 
 #pragma once
+#include <algorithm>
+#include <functional>
+#include <vector>
 #include "internals/base_focus_pubm.h"
 #include "internals/base_native_ctrl_pubm.h"
 #include "internals/listview_column_collection.h"
@@ -37,11 +40,85 @@ public:
 		TILE      = LV_VIEW_TILE
 	};
 
+	// How the values of a column are compared when sorting.
+	enum class sort_type { TEXT, NUMERIC };
+
+	// RAII scope for bulk changes: on construction stops redrawing, pre-sizes the
+	// internal item storage, mutes parent notification handlers and suspends
+	// automatic sorting; on destruction restores everything and repaints once.
+	class batch_update final {
+		friend listview;
+
+	private:
+		HWND     _hList = nullptr;
+		LONG_PTR _ctrlId = 0;
+		LONG_PTR _sortStyles = 0;
+
+		explicit batch_update(HWND hList, size_t expectedItemCount) noexcept :
+			_hList(hList)
+		{
+			SendMessageW(hList, WM_SETREDRAW, FALSE, 0);
+
+			// While the ID is zeroed, WM_NOTIFY still flows but carries idFrom 0,
+			// so parent handlers keyed by this control's ID won't fire mid-batch.
+			this->_ctrlId = GetWindowLongPtrW(hList, GWLP_ID);
+			SetWindowLongPtrW(hList, GWLP_ID, 0);
+
+			// Automatic sorting would re-sort the whole list on every insert.
+			LONG_PTR style = GetWindowLongPtrW(hList, GWL_STYLE);
+			this->_sortStyles = style & (LVS_SORTASCENDING | LVS_SORTDESCENDING);
+			if (this->_sortStyles) {
+				SetWindowLongPtrW(hList, GWL_STYLE, style & ~this->_sortStyles);
+			}
+
+			if (expectedItemCount) {
+				ListView_SetItemCount(hList, static_cast<int>(expectedItemCount)); // pre-size
+			}
+		}
+
+	public:
+		~batch_update() {
+			if (!this->_hList) return; // moved-from
+			if (this->_sortStyles) {
+				SetWindowLongPtrW(this->_hList, GWL_STYLE,
+					GetWindowLongPtrW(this->_hList, GWL_STYLE) | this->_sortStyles);
+			}
+			SetWindowLongPtrW(this->_hList, GWLP_ID, this->_ctrlId);
+			SendMessageW(this->_hList, WM_SETREDRAW, TRUE, 0);
+			RedrawWindow(this->_hList, nullptr, nullptr,
+				RDW_ERASE | RDW_FRAME | RDW_INVALIDATE | RDW_ALLCHILDREN); // single repaint
+		}
+
+		batch_update(batch_update&& other) noexcept { this->operator=(std::move(other)); }
+
+		batch_update& operator=(batch_update&& other) noexcept {
+			this->_hList = other._hList;
+			this->_ctrlId = other._ctrlId;
+			this->_sortStyles = other._sortStyles;
+			other._hList = nullptr;
+			return *this;
+		}
+	};
+
 private:
 	HWND                   _hWnd = nullptr;
 	_wli::base_native_ctrl _baseNativeCtrl{_hWnd};
 	subclass               _subclass;
+	subclass               _parentSubclass; // installed on demand, routes virtual mode notifications
 	menu                   _contextMenu;
+	std::function<std::wstring(size_t, size_t)> _virtualProvider; // itemIndex, columnIndex
+	std::function<void(size_t, size_t)>         _virtualCacheHint; // iFrom, iTo
+
+	struct _sort_key final {
+		double       num = 0;
+		std::wstring text;
+	};
+	std::vector<_sort_key>  _sortKeys; // keys of _sortKeysColumn, one per item, in physical order
+	size_t                  _sortKeysColumn = -1;
+	std::vector<sort_type>  _columnSortTypes; // indexed by column; absent means TEXT
+	size_t                  _sortedColumn = -1;
+	bool                    _sortAscending = true;
+	bool                    _headerClickSort = false;
 
 public:
 	// Wraps window style changes done by Get/SetWindowLongPtr.
@@ -97,6 +174,21 @@ public:
 			this->_show_context_menu(true, p.has_ctrl(), p.has_shift());
 			return 0;
 		});
+
+		// Header clicks are notified to the listview itself, so they're caught here.
+		// Registered upfront because the subclass store locks once messages flow.
+		this->_subclass.on_message(WM_NOTIFY, [this](params p) -> LRESULT {
+			NMHDR* hdr = reinterpret_cast<NMHDR*>(p.lParam);
+			if (this->_headerClickSort &&
+				hdr->hwndFrom == ListView_GetHeader(this->_hWnd) &&
+				(hdr->code == HDN_ITEMCLICKW || hdr->code == HDN_ITEMCLICKA))
+			{
+				size_t col = static_cast<size_t>(reinterpret_cast<NMHEADERW*>(p.lParam)->iItem);
+				bool ascending = (col == this->_sortedColumn) ? !this->_sortAscending : true;
+				this->sort_by_column(col, ascending);
+			}
+			return DefSubclassProc(this->_hWnd, p.message, p.wParam, p.lParam);
+		});
 	}
 
 	listview(listview&&) = default;
@@ -138,21 +230,334 @@ public:
 		return *this;
 	}
 
+	// Returns a scope object that brackets a bulk update: keep it alive while
+	// removing, re-adding and resizing columns, and the control repaints only
+	// once, when the object goes out of scope. Optionally pre-sizes the item
+	// storage for the number of items about to be inserted.
+	batch_update begin_batch_update(size_t expectedItemCount = 0) noexcept {
+		return batch_update{this->_hWnd, expectedItemCount};
+	}
+
+	// Captures the visual state of the grid — column widths and order, sorted
+	// column, selection, focused item and scroll position — into a compact
+	// binary blob, suited to be persisted and fed to restore() next session.
+	// Selected rows are coalesced into ranges, so a contiguous selection of
+	// thousands of items costs 8 bytes.
+	std::vector<BYTE> state_snapshot() const {
+		UINT32 numCols = static_cast<UINT32>(this->columns.count());
+		std::vector<int> order(numCols, 0);
+		if (numCols) {
+			ListView_GetColumnOrderArray(this->_hWnd, static_cast<int>(numCols), &order[0]);
+		}
+
+		std::vector<BYTE> blob;
+		blob.reserve(40 + numCols * 8);
+		_put_u32(blob, _STATE_MAGIC);
+		_put_u32(blob, numCols);
+		for (UINT32 i = 0; i < numCols; ++i) {
+			_put_u32(blob, static_cast<UINT32>(ListView_GetColumnWidth(this->_hWnd, static_cast<int>(i))));
+		}
+		for (UINT32 i = 0; i < numCols; ++i) {
+			_put_u32(blob, static_cast<UINT32>(order[i]));
+		}
+		_put_u32(blob, static_cast<UINT32>(this->_sortedColumn));
+		_put_u32(blob, this->_sortAscending ? 1 : 0);
+		_put_u32(blob, static_cast<UINT32>(ListView_GetTopIndex(this->_hWnd)));
+		_put_u32(blob, static_cast<UINT32>(ListView_GetNextItem(this->_hWnd, -1, LVNI_FOCUSED)));
+
+		size_t numRangesOffset = blob.size();
+		_put_u32(blob, 0); // range count, patched below
+		UINT32 numRanges = 0;
+		int idx = ListView_GetNextItem(this->_hWnd, -1, LVNI_SELECTED);
+		while (idx != -1) {
+			int first = idx, last = idx;
+			for (;;) { // extend the range while the selection stays contiguous
+				idx = ListView_GetNextItem(this->_hWnd, last, LVNI_SELECTED);
+				if (idx != last + 1) break;
+				last = idx;
+			}
+			_put_u32(blob, static_cast<UINT32>(first));
+			_put_u32(blob, static_cast<UINT32>(last));
+			++numRanges;
+		}
+		CopyMemory(&blob[numRangesOffset], &numRanges, sizeof(numRanges));
+		return blob;
+	}
+
+	// Applies a snapshot taken by state_snapshot(), in one batched pass under
+	// suspended redraw: widths are set only where they differ, column order is
+	// restored with a single LVM_SETCOLUMNORDERARRAY, and selection is
+	// re-applied range by range. A blob whose column count doesn't match the
+	// current layout is considered stale and ignored, leaving the grid as built.
+	listview& restore(const std::vector<BYTE>& snapshot) {
+		size_t off = 0;
+		UINT32 magic = 0, numCols = 0;
+		if (!_get_u32(snapshot, off, magic) || magic != _STATE_MAGIC ||
+			!_get_u32(snapshot, off, numCols) ||
+			numCols != static_cast<UINT32>(this->columns.count()))
+		{
+			return *this;
+		}
+
+		batch_update blk = this->begin_batch_update(); // one repaint at scope end
+
+		for (UINT32 i = 0; i < numCols; ++i) {
+			UINT32 width = 0;
+			if (!_get_u32(snapshot, off, width)) return *this;
+			if (static_cast<int>(width) != ListView_GetColumnWidth(this->_hWnd, static_cast<int>(i))) {
+				ListView_SetColumnWidth(this->_hWnd, static_cast<int>(i), static_cast<int>(width));
+			}
+		}
+
+		std::vector<int> order(numCols, 0);
+		for (UINT32 i = 0; i < numCols; ++i) {
+			UINT32 pos = 0;
+			if (!_get_u32(snapshot, off, pos) || pos >= numCols) return *this;
+			order[i] = static_cast<int>(pos);
+		}
+		if (numCols) {
+			ListView_SetColumnOrderArray(this->_hWnd, static_cast<int>(numCols), &order[0]);
+		}
+
+		UINT32 sortedCol = 0, sortAsc = 0, topIndex = 0, focusedIndex = 0;
+		if (!_get_u32(snapshot, off, sortedCol) || !_get_u32(snapshot, off, sortAsc) ||
+			!_get_u32(snapshot, off, topIndex) || !_get_u32(snapshot, off, focusedIndex))
+		{
+			return *this;
+		}
+		if (sortedCol < numCols) {
+			this->sort_by_column(sortedCol, sortAsc != 0);
+		}
+
+		int numItems = ListView_GetItemCount(this->_hWnd);
+		ListView_SetItemState(this->_hWnd, -1, 0, LVIS_SELECTED); // clear, then re-apply ranges
+
+		UINT32 numRanges = 0;
+		if (!_get_u32(snapshot, off, numRanges)) return *this;
+		for (UINT32 r = 0; r < numRanges; ++r) {
+			UINT32 first = 0, last = 0;
+			if (!_get_u32(snapshot, off, first) || !_get_u32(snapshot, off, last)) return *this;
+			for (UINT32 i = first; i <= last && static_cast<int>(i) < numItems; ++i) {
+				ListView_SetItemState(this->_hWnd, static_cast<int>(i), LVIS_SELECTED, LVIS_SELECTED);
+			}
+		}
+
+		if (static_cast<int>(focusedIndex) >= 0 && static_cast<int>(focusedIndex) < numItems) {
+			ListView_SetItemState(this->_hWnd, static_cast<int>(focusedIndex),
+				LVIS_FOCUSED, LVIS_FOCUSED);
+		}
+		if (static_cast<int>(topIndex) > 0 && static_cast<int>(topIndex) < numItems) {
+			// Scrolling to the bottom first makes the following EnsureVisible
+			// land the saved item on the top row, not the bottom one.
+			ListView_EnsureVisible(this->_hWnd, numItems - 1, FALSE);
+			ListView_EnsureVisible(this->_hWnd, static_cast<int>(topIndex), FALSE);
+		}
+		return *this;
+	}
+
 	listview& set_view(view viewType) noexcept {
 		ListView_SetView(this->_hWnd, static_cast<DWORD>(viewType));
 		return *this;
 	}
 
+	// Puts the listview in virtual mode (LVS_OWNERDATA): no items are materialized, instead
+	// the given callback produces the text of each (item, column) cell on demand.
+	// The control must have been created with the LVS_OWNERDATA style.
+	listview& set_virtual(size_t itemCount,
+		std::function<std::wstring(size_t itemIndex, size_t columnIndex)> dataProvider)
+	{
+		if (!this->_hWnd) {
+			throw std::logic_error("Can't set virtual mode before the listview is assigned.");
+		} else if ((GetWindowLongPtrW(this->_hWnd, GWL_STYLE) & LVS_OWNERDATA) == 0) {
+			// LVS_OWNERDATA can't be added after the control exists, so demand it upfront.
+			throw std::logic_error("Virtual mode requires the listview to be created with LVS_OWNERDATA.");
+		}
+
+		this->_virtualProvider = std::move(dataProvider);
+		if (!this->_parentSubclass.hwnd()) {
+			this->_install_parent_subclass();
+		}
+		ListView_SetItemCountEx(this->_hWnd, static_cast<int>(itemCount), 0);
+		return *this;
+	}
+
+	// Updates the number of items of a virtual listview, keeping scroll position and
+	// avoiding a full repaint of the unchanged range.
+	listview& set_virtual_count(size_t itemCount) noexcept {
+		ListView_SetItemCountEx(this->_hWnd, static_cast<int>(itemCount),
+			LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
+		return *this;
+	}
+
+	// Assigns a lambda to be notified, in virtual mode, of the range of items the
+	// listview is about to display, so the application can prefetch row data.
+	listview& on_virtual_cache_hint(std::function<void(size_t iFrom, size_t iTo)> cacheHint) {
+		this->_virtualCacheHint = std::move(cacheHint);
+		return *this;
+	}
+
 	view get_view() const noexcept {
 		return static_cast<view>(ListView_GetView(this->_hWnd));
 	}
 
+	// Defines how the values of a column are compared when sorting; TEXT is the default.
+	listview& set_column_sort_type(size_t columnIndex, sort_type type) {
+		if (columnIndex >= this->_columnSortTypes.size()) {
+			this->_columnSortTypes.resize(columnIndex + 1, sort_type::TEXT);
+		}
+		this->_columnSortTypes[columnIndex] = type;
+		return *this;
+	}
+
+	// Enables sorting by clicking a column header: first click sorts ascending,
+	// clicking the same column again flips the order.
+	listview& enable_header_click_sort(bool enable = true) noexcept {
+		this->_headerClickSort = enable;
+		return *this;
+	}
+
+	// Sorts the items in place by the given column, with LVM_SORTITEMSEX. Cell texts
+	// are fetched once into a cached key vector, so the O(n log n) comparisons run
+	// over the cache instead of issuing one LVM_GETITEMTEXT each.
+	listview& sort_by_column(size_t columnIndex, bool ascending = true) {
+		size_t numItems = static_cast<size_t>(ListView_GetItemCount(this->_hWnd));
+		if (numItems > 1) {
+			sort_type type = columnIndex < this->_columnSortTypes.size() ?
+				this->_columnSortTypes[columnIndex] : sort_type::TEXT;
+
+			if (this->_sortKeysColumn != columnIndex || this->_sortKeys.size() != numItems) {
+				this->_build_sort_keys(columnIndex, type, numItems);
+			}
+
+			std::vector<size_t> order(numItems); // order[pos] = item currently at pos after sorting
+			for (size_t i = 0; i < numItems; ++i) order[i] = i;
+			std::stable_sort(order.begin(), order.end(),
+				[this, type, ascending](size_t a, size_t b) noexcept -> bool {
+					int cmp = _compare_keys(this->_sortKeys[a], this->_sortKeys[b], type);
+					return ascending ? (cmp < 0) : (cmp > 0);
+				});
+
+			std::vector<size_t> ranks(numItems); // ranks[item] = final position of item
+			for (size_t pos = 0; pos < numItems; ++pos) ranks[order[pos]] = pos;
+			ListView_SortItemsEx(this->_hWnd, _compare_ranks, reinterpret_cast<LPARAM>(&ranks));
+
+			std::vector<_sort_key> permuted(numItems); // keep cache aligned with new physical order
+			for (size_t pos = 0; pos < numItems; ++pos) {
+				permuted[pos] = std::move(this->_sortKeys[order[pos]]);
+			}
+			this->_sortKeys = std::move(permuted);
+		}
+
+		this->_sortedColumn = columnIndex;
+		this->_sortAscending = ascending;
+		this->_update_header_arrows();
+		return *this;
+	}
+
+	// Discards the cached sort keys; call after changing cell texts outside a sort,
+	// so the next sort re-reads the control instead of using stale keys.
+	listview& invalidate_sort_cache() noexcept {
+		this->_sortKeys.clear();
+		this->_sortKeysColumn = -1;
+		return *this;
+	}
+
+	// Returns the index of the column the items are currently sorted by, or -1 if none.
+	size_t sorted_column() const noexcept {
+		return this->_sortedColumn;
+	}
+
 private:
+	static const UINT32 _STATE_MAGIC = 0x534C4C57; // "WLLS", tags state_snapshot() blobs
+
+	static void _put_u32(std::vector<BYTE>& blob, UINT32 v) {
+		const BYTE* p = reinterpret_cast<const BYTE*>(&v);
+		blob.insert(blob.end(), p, p + sizeof(v));
+	}
+
+	static bool _get_u32(const std::vector<BYTE>& blob, size_t& off, UINT32& v) noexcept {
+		if (off + sizeof(v) > blob.size()) return false; // truncated blob
+		CopyMemory(&v, &blob[off], sizeof(v));
+		off += sizeof(v);
+		return true;
+	}
+
+	void _build_sort_keys(size_t columnIndex, sort_type type, size_t numItems) {
+		this->_sortKeys.clear();
+		this->_sortKeys.resize(numItems);
+		for (size_t i = 0; i < numItems; ++i) {
+			_sort_key& key = this->_sortKeys[i];
+			key.text = _wli::listview_item{i, this->_hWnd}.get_text(columnIndex);
+			if (type == sort_type::NUMERIC) {
+				key.num = wcstod(key.text.c_str(), nullptr);
+			}
+		}
+		this->_sortKeysColumn = columnIndex;
+	}
+
+	static int _compare_keys(const _sort_key& a, const _sort_key& b, sort_type type) noexcept {
+		if (type == sort_type::NUMERIC) {
+			return a.num < b.num ? -1 : (a.num > b.num ? 1 : 0);
+		}
+		return CompareStringW(LOCALE_USER_DEFAULT, NORM_IGNORECASE,
+			a.text.c_str(), -1, b.text.c_str(), -1) - CSTR_EQUAL;
+	}
+
+	// LVM_SORTITEMSEX hands over current item indices; the precomputed rank
+	// vector turns each comparison into two array loads.
+	static int CALLBACK _compare_ranks(LPARAM idx1, LPARAM idx2, LPARAM lpRanks) noexcept {
+		const std::vector<size_t>& ranks = *reinterpret_cast<const std::vector<size_t>*>(lpRanks);
+		return ranks[idx1] < ranks[idx2] ? -1 : (ranks[idx1] > ranks[idx2] ? 1 : 0);
+	}
+
+	void _update_header_arrows() const noexcept {
+		HWND hHeader = ListView_GetHeader(this->_hWnd);
+		int numCols = Header_GetItemCount(hHeader);
+		for (int i = 0; i < numCols; ++i) {
+			HDITEMW hdi{};
+			hdi.mask = HDI_FORMAT;
+			Header_GetItem(hHeader, i, &hdi);
+			hdi.fmt &= ~(HDF_SORTUP | HDF_SORTDOWN);
+			if (i == static_cast<int>(this->_sortedColumn)) {
+				hdi.fmt |= this->_sortAscending ? HDF_SORTUP : HDF_SORTDOWN;
+			}
+			Header_SetItem(hHeader, i, &hdi);
+		}
+	}
+
 	listview& _install_subclass() {
 		this->_subclass.install_subclass(*this);
 		return *this;
 	}
 
+	// Virtual mode notifications go to the parent, so it's the parent we subclass to
+	// serve LVN_GETDISPINFO and LVN_ODCACHEHINT without any user-side wiring.
+	void _install_parent_subclass() {
+		UINT_PTR ctrlId = this->ctrl_id();
+
+		this->_parentSubclass.on_notify(ctrlId, LVN_GETDISPINFO, [this](params p) noexcept -> LRESULT {
+			NMLVDISPINFOW* lvdi = reinterpret_cast<NMLVDISPINFOW*>(p.lParam);
+			if ((lvdi->item.mask & LVIF_TEXT) != 0 && this->_virtualProvider) {
+				std::wstring text = this->_virtualProvider(
+					static_cast<size_t>(lvdi->item.iItem),
+					static_cast<size_t>(lvdi->item.iSubItem));
+				lstrcpynW(lvdi->item.pszText, text.c_str(), lvdi->item.cchTextMax);
+			}
+			return 0;
+		});
+
+		this->_parentSubclass.on_notify(ctrlId, LVN_ODCACHEHINT, [this](params p) noexcept -> LRESULT {
+			if (this->_virtualCacheHint) {
+				NMLVCACHEHINT* lvch = reinterpret_cast<NMLVCACHEHINT*>(p.lParam);
+				this->_virtualCacheHint(static_cast<size_t>(lvch->iFrom),
+					static_cast<size_t>(lvch->iTo));
+			}
+			return 0;
+		});
+
+		this->_parentSubclass.install_subclass(GetAncestor(this->_hWnd, GA_PARENT));
+	}
+
 	int _show_context_menu(bool followCursor, bool hasCtrl, bool hasShift) noexcept {
 		if (!this->_contextMenu.hmenu()) return -1; // no context menu assigned
 
@@ -0,0 +1,247 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "file_writer.h"
+#include "internals/lippincott.h"
+#include "internals/str_priv.h"
+#include <process.h>
+
+namespace wl {
+
+// Process-wide log sink that never blocks the logging thread on the disk.
+// Each producer thread gets its own single-producer ring buffer; a background
+// flusher drains all rings into a buffered file_writer on a short interval.
+// Severity is checked before anything is formatted, so a suppressed message
+// costs one branch. lippincott() drains the rings before showing its error
+// dialog, so the log tail survives a crash.
+class log_sink final {
+public:
+	enum class severity : int { VERBOSE, INFO, WARNING, ERR };
+
+private:
+	// One ring per producer thread: the owning thread advances head, the
+	// flusher advances tail, so neither side ever takes a lock on the hot path.
+	// Records are a length slot followed by the characters, wrapping freely.
+	struct _ring final {
+		static const size_t CAP = 64 * 1024; // wchar_t slots; must be power of two
+
+		std::vector<wchar_t> slots;
+		std::atomic<size_t>  head{0}; // monotonic; producer-owned
+		std::atomic<size_t>  tail{0}; // monotonic; flusher-owned
+
+		_ring() : slots(CAP) { }
+	};
+
+	std::vector<std::unique_ptr<_ring>> _rings; // grow-only, one per thread ever seen
+	std::mutex        _ringsMutex;   // thread registration and ring-list snapshot
+	std::mutex        _drainMutex;   // one consumer at a time keeps each ring SPSC
+	file_writer       _out;
+	std::atomic<int>  _minSeverity{static_cast<int>(severity::INFO)};
+	std::atomic<bool> _opened{false};
+	bool              _flusherStarted = false;
+	UINT              _flushIntervalMs = 100;
+	std::wstring      _lineScratch;  // flusher-only, reused across records
+	std::vector<char> _utf8Scratch;  // flusher-only, reused across records
+
+	log_sink() = default;
+
+public:
+	log_sink(const log_sink&) = delete;
+	log_sink& operator=(const log_sink&) = delete; // non-copyable, non-movable
+
+	static log_sink& instance() {
+		static log_sink sink; // thread-safe in C++11
+		return sink;
+	}
+
+	// Opens the log file (truncating), starts the background flusher and hooks
+	// the crash-time drain. Call once, before the first log().
+	log_sink& open(const std::wstring& filePath, UINT flushIntervalMs = 100) {
+		this->_out.open(filePath);
+		this->_flushIntervalMs = flushIntervalMs ? flushIntervalMs : 100;
+		this->_opened.store(true, std::memory_order_release);
+
+		_wli::crash_flush_hook() = []() {
+			log_sink::instance().flush_now(); // tail of the log survives the fault
+		};
+
+		std::lock_guard<std::mutex> lock(this->_ringsMutex);
+		if (!this->_flusherStarted) {
+			this->_start_flusher();
+			this->_flusherStarted = true;
+		}
+		return *this;
+	}
+
+	// Messages below this severity are dropped at the call site, unformatted.
+	log_sink& set_min_severity(severity minSev) noexcept {
+		this->_minSeverity.store(static_cast<int>(minSev), std::memory_order_relaxed);
+		return *this;
+	}
+
+	// True if a message of this severity would actually be written; lets callers
+	// skip building expensive dump strings for suppressed levels.
+	bool would_log(severity sev) const noexcept {
+		return this->_opened.load(std::memory_order_acquire) &&
+			static_cast<int>(sev) >= this->_minSeverity.load(std::memory_order_relaxed);
+	}
+
+	// Logs an already-built message; the call is a ring push, no disk I/O.
+	// Line breaks are appended for you.
+	log_sink& log(severity sev, const wchar_t* msg) {
+		if (!this->would_log(sev)) return *this; // the one branch suppressed messages pay
+		this->_enqueue(sev, msg);
+		return *this;
+	}
+
+	log_sink& log(severity sev, const std::wstring& msg) {
+		return this->log(sev, msg.c_str());
+	}
+
+	// Printf-style logging; the severity gate runs before any formatting, so a
+	// suppressed call never touches its arguments.
+	template<typename ...argsT>
+	log_sink& logf(severity sev, const wchar_t* strFormat, const argsT&... args) {
+		if (!this->would_log(sev)) return *this;
+		this->_enqueue(sev,
+			_wli::str_priv::format_raw(lstrlenW(strFormat), strFormat, args...).c_str());
+		return *this;
+	}
+
+	// Drains every ring to the file and flushes the writer, synchronously.
+	// The flusher does this on its own interval; call it yourself only at
+	// points where the file must be current, like before spawning a reader.
+	log_sink& flush_now() {
+		if (!this->_opened.load(std::memory_order_acquire)) return *this;
+		std::lock_guard<std::mutex> lock(this->_drainMutex);
+		this->_drain_all();
+		this->_out.flush();
+		return *this;
+	}
+
+private:
+	// The per-thread ring, created on this thread's first message.
+	_ring& _my_ring() {
+		thread_local _ring* pRing = nullptr;
+		if (!pRing) {
+			std::lock_guard<std::mutex> lock(this->_ringsMutex);
+			this->_rings.emplace_back(std::make_unique<_ring>());
+			pRing = this->_rings.back().get(); // unique_ptr: stable across vector growth
+		}
+		return *pRing;
+	}
+
+	void _enqueue(severity sev, const wchar_t* msg) {
+		wchar_t stamp[48]{};
+		SYSTEMTIME st{};
+		GetLocalTime(&st);
+		int stampLen = swprintf(stamp, ARRAYSIZE(stamp), L"%04u-%02u-%02u %02u:%02u:%02u.%03u [%s] ",
+			st.wYear, st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond, st.wMilliseconds,
+			this->_severity_name(sev));
+
+		size_t msgLen = lstrlenW(msg);
+		if (msgLen > 0xFFFF - 64) msgLen = 0xFFFF - 64; // record length fits one slot
+
+		_ring& r = this->_my_ring();
+		size_t recLen = static_cast<size_t>(stampLen) + msgLen + 2; // CR LF
+		for (;;) { // backpressure: block the producer rather than lose log lines
+			size_t used = r.head.load(std::memory_order_relaxed) -
+				r.tail.load(std::memory_order_acquire);
+			if (_ring::CAP - used >= recLen + 1) break; // +1 for the length slot
+			SwitchToThread(); // flusher will catch up
+		}
+
+		size_t h = r.head.load(std::memory_order_relaxed);
+		r.slots[h++ % _ring::CAP] = static_cast<wchar_t>(recLen);
+		h = this->_put(r, h, stamp, static_cast<size_t>(stampLen));
+		h = this->_put(r, h, msg, msgLen);
+		h = this->_put(r, h, L"\r\n", 2);
+		r.head.store(h, std::memory_order_release); // record visible only when whole
+	}
+
+	static size_t _put(_ring& r, size_t h, const wchar_t* p, size_t len) noexcept {
+		for (size_t i = 0; i < len; ++i) {
+			r.slots[(h + i) % _ring::CAP] = p[i];
+		}
+		return h + len;
+	}
+
+	void _drain_all() {
+		std::vector<_ring*> ringsNow;
+		{
+			// Snapshot the pointers: the vector may grow while we drain, but the
+			// rings themselves never move or go away.
+			std::lock_guard<std::mutex> lock(this->_ringsMutex);
+			ringsNow.reserve(this->_rings.size());
+			for (const std::unique_ptr<_ring>& r : this->_rings) {
+				ringsNow.push_back(r.get());
+			}
+		}
+
+		for (_ring* pRing : ringsNow) {
+			_ring& r = *pRing;
+			for (;;) {
+				size_t t = r.tail.load(std::memory_order_relaxed);
+				if (t == r.head.load(std::memory_order_acquire)) break; // ring empty
+
+				size_t recLen = static_cast<size_t>(r.slots[t++ % _ring::CAP]);
+				this->_lineScratch.resize(recLen);
+				for (size_t i = 0; i < recLen; ++i) {
+					this->_lineScratch[i] = r.slots[(t + i) % _ring::CAP];
+				}
+				r.tail.store(t + recLen, std::memory_order_release); // slots reusable
+
+				this->_write_utf8(this->_lineScratch);
+			}
+		}
+	}
+
+	void _write_utf8(const std::wstring& line) {
+		int neededLen = WideCharToMultiByte(CP_UTF8, 0,
+			line.c_str(), static_cast<int>(line.length()), nullptr, 0, nullptr, nullptr);
+		this->_utf8Scratch.resize(neededLen);
+		WideCharToMultiByte(CP_UTF8, 0, line.c_str(), static_cast<int>(line.length()),
+			&this->_utf8Scratch[0], neededLen, nullptr, nullptr);
+		this->_out.write(reinterpret_cast<const BYTE*>(&this->_utf8Scratch[0]),
+			static_cast<size_t>(neededLen));
+	}
+
+	void _start_flusher() noexcept {
+		// Lives for the whole process, like the thread_pool workers; no join.
+		uintptr_t hThread = _beginthreadex(nullptr, 0, [](void* ptr) noexcept -> unsigned int {
+			reinterpret_cast<log_sink*>(ptr)->_flusher_loop();
+			return 0;
+		}, this, 0, nullptr);
+		CloseHandle(reinterpret_cast<HANDLE>(hThread));
+	}
+
+	void _flusher_loop() noexcept {
+		for (;;) {
+			Sleep(this->_flushIntervalMs);
+			try {
+				this->flush_now();
+			} catch (...) {
+				// disk trouble must not kill the flusher; next pass retries
+			}
+		}
+	}
+
+	static const wchar_t* _severity_name(severity sev) noexcept {
+		switch (sev) {
+		case severity::VERBOSE: return L"VERB";
+		case severity::INFO:    return L"INFO";
+		case severity::WARNING: return L"WARN";
+		default:                return L"ERROR";
+		}
+	}
+};
+
+}//namespace wl
@@ -8,6 +8,7 @@
 #pragma once
 #include <string>
 #include <system_error>
+#include "wstr_view.h"
 #include <Windows.h>
 
 namespace wl {
@@ -132,6 +133,14 @@ public:
 		return this->append_item(cmdId, caption.c_str());
 	}
 
+	// Slice overload: InsertMenu wants a terminated caption, so the view is
+	// staged through a per-thread buffer reused across calls — menus built from
+	// slices of a parsed buffer don't pay one wstring per item once warm.
+	menu& append_item(WORD cmdId, wstr_view caption) noexcept {
+		thread_local std::wstring buf;
+		return this->append_item(cmdId, caption.c_str_in(buf));
+	}
+
 	menu& insert_item_before_id(WORD newCmdId, WORD beforeCmdId, const wchar_t* caption) noexcept {
 		InsertMenuW(this->_hMenu, beforeCmdId, MF_BYCOMMAND | MF_STRING, newCmdId, caption);
 		return *this;
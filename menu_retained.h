@@ -0,0 +1,210 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include "menu.h"
+
+namespace wl {
+
+// A popup menu built once from a static descriptor table and kept alive, so
+// showing it is a single TrackPopupMenu call instead of dozens of AppendMenu
+// calls per right-click. Enable/check state is patched in place by command id
+// through a hash index mapping each id to its owning HMENU — no linear
+// GetMenuItemInfo scans.
+class menu_retained final {
+public:
+	// One row of the descriptor table; build the table as a static array with
+	// the item/separator/submenu/end_submenu helpers below.
+	struct entry final {
+		enum class kind : BYTE { ITEM, SEPARATOR, SUBMENU, END_SUBMENU };
+
+		kind           entryKind;
+		WORD           cmdId;
+		const wchar_t* caption;
+	};
+
+	static constexpr entry item(WORD cmdId, const wchar_t* caption) noexcept {
+		return {entry::kind::ITEM, cmdId, caption};
+	}
+	static constexpr entry separator() noexcept {
+		return {entry::kind::SEPARATOR, 0, nullptr};
+	}
+	static constexpr entry submenu(const wchar_t* caption) noexcept {
+		return {entry::kind::SUBMENU, 0, caption};
+	}
+	static constexpr entry end_submenu() noexcept {
+		return {entry::kind::END_SUBMENU, 0, nullptr};
+	}
+
+private:
+	menu                            _root;
+	std::unordered_map<WORD, HMENU> _idToOwner; // command id -> HMENU holding the item
+
+public:
+	~menu_retained() {
+		this->destroy();
+	}
+
+	menu_retained() = default;
+
+	menu_retained(menu_retained&& other) noexcept { this->operator=(std::move(other)); }
+
+	menu_retained& operator=(menu_retained&& other) noexcept {
+		this->destroy();
+		this->_root = other._root;
+		other._root = menu{};
+		this->_idToOwner.swap(other._idToOwner);
+		return *this;
+	} // movable only
+
+	// The retained menu; valid until this object dies.
+	const menu& root() const noexcept {
+		return this->_root;
+	}
+
+	void destroy() noexcept {
+		this->_root.destroy(); // destroys submenus too
+		this->_idToOwner.clear();
+	}
+
+	menu_retained& build(const entry* entries, size_t count) {
+		this->destroy();
+		this->_root = CreatePopupMenu();
+
+		std::vector<HMENU> menuStack{this->_root.hmenu()}; // innermost last
+
+		for (size_t i = 0; i < count; ++i) {
+			const entry& e = entries[i];
+			HMENU hCur = menuStack.back();
+
+			switch (e.entryKind) {
+			case entry::kind::ITEM:
+				InsertMenuW(hCur, -1, MF_BYPOSITION | MF_STRING, e.cmdId, e.caption);
+				this->_idToOwner.emplace(e.cmdId, hCur);
+				break;
+			case entry::kind::SEPARATOR:
+				InsertMenuW(hCur, -1, MF_BYPOSITION | MF_SEPARATOR, 0, nullptr);
+				break;
+			case entry::kind::SUBMENU: {
+				HMENU hSub = CreatePopupMenu();
+				AppendMenuW(hCur, MF_STRING | MF_POPUP,
+					reinterpret_cast<UINT_PTR>(hSub), e.caption);
+				menuStack.push_back(hSub);
+				break;
+			}
+			case entry::kind::END_SUBMENU:
+				if (menuStack.size() == 1) {
+					this->destroy();
+					throw std::logic_error("Unbalanced end_submenu in menu descriptor table.");
+				}
+				menuStack.pop_back();
+			}
+		}
+
+		if (menuStack.size() != 1) {
+			this->destroy();
+			throw std::logic_error("Missing end_submenu in menu descriptor table.");
+		}
+		return *this;
+	}
+
+	template<size_t N>
+	menu_retained& build(const entry (&entries)[N]) {
+		return this->build(entries, N);
+	}
+
+	// Patches the enabled state of the item in place, O(1) by command id.
+	menu_retained& enable_item(WORD cmdId, bool doEnable) {
+		EnableMenuItem(this->_owner_of(cmdId), cmdId,
+			MF_BYCOMMAND | (doEnable ? MF_ENABLED : MF_GRAYED));
+		return *this;
+	}
+
+	menu_retained& enable_item(std::initializer_list<WORD> cmdIds, bool doEnable) {
+		for (WORD cmdId : cmdIds) {
+			this->enable_item(cmdId, doEnable);
+		}
+		return *this;
+	}
+
+	// Patches the check state of the item in place, O(1) by command id.
+	menu_retained& check_item(WORD cmdId, bool doCheck) {
+		CheckMenuItem(this->_owner_of(cmdId), cmdId,
+			MF_BYCOMMAND | (doCheck ? MF_CHECKED : MF_UNCHECKED));
+		return *this;
+	}
+
+	// Shows the retained menu; by now all state has been patched in place, so
+	// this is the only USER call on the popup path.
+	menu_retained& show_at_point(HWND hParent, POINT pt, HWND hWndCoordsRelativeTo) noexcept {
+		this->_root.show_at_point(hParent, pt, hWndCoordsRelativeTo);
+		return *this;
+	}
+
+private:
+	HMENU _owner_of(WORD cmdId) const {
+		auto itOwner = this->_idToOwner.find(cmdId);
+		if (itOwner == this->_idToOwner.end()) {
+			throw std::invalid_argument("Command ID not found in retained menu.");
+		}
+		return itOwner->second;
+	}
+};
+
+// Wrapper to HACCEL built from a static ACCEL table; keep the object alive
+// for as long as the table is passed to the message loop.
+class accel_table final {
+private:
+	HACCEL _hAccel = nullptr;
+
+public:
+	~accel_table() {
+		this->destroy();
+	}
+
+	accel_table() = default;
+
+	accel_table(accel_table&& other) noexcept : _hAccel{other._hAccel} { other._hAccel = nullptr; }
+
+	accel_table& operator=(accel_table&& other) noexcept {
+		this->destroy();
+		std::swap(this->_hAccel, other._hAccel);
+		return *this;
+	} // movable only
+
+	HACCEL haccel() const noexcept {
+		return this->_hAccel;
+	}
+
+	void destroy() noexcept {
+		if (this->_hAccel) {
+			DestroyAcceleratorTable(this->_hAccel);
+			this->_hAccel = nullptr;
+		}
+	}
+
+	accel_table& build(const ACCEL* entries, size_t count) {
+		this->destroy();
+		this->_hAccel = CreateAcceleratorTableW(
+			const_cast<ACCEL*>(entries), static_cast<int>(count));
+		if (!this->_hAccel) {
+			throw std::system_error(GetLastError(), std::system_category(),
+				"CreateAcceleratorTable failed");
+		}
+		return *this;
+	}
+
+	template<size_t N>
+	accel_table& build(const ACCEL (&entries)[N]) {
+		return this->build(entries, N);
+	}
+};
+
+}//namespace wl
@@ -6,6 +6,10 @@
  */
 
 #pragma once
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+#include "internals/thread_pool.h"
 #include "str.h"
 
 namespace wl {
@@ -84,5 +88,106 @@ inline std::wstring file_from(const std::wstring& filePath) {
 	return ret;
 }
 
+// Streams every entry of the directory to the callback, with no per-entry
+// allocation: the callback receives the directory path (no trailing backslash)
+// and the raw WIN32_FIND_DATA, whose cFileName it can inspect in place. Return
+// false from the callback to stop early; enum_dir then also returns false.
+template<typename callbackT>
+inline bool enum_dir(const std::wstring& dirPath, callbackT&& callback) {
+	std::wstring dir = dirPath;
+	trim_backslash(dir);
+	std::wstring spec = dir + L"\\*";
+
+	WIN32_FIND_DATAW fd{};
+	HANDLE hFind = FindFirstFileExW(spec.c_str(), FindExInfoBasic, &fd,
+		FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+	if (hFind == INVALID_HANDLE_VALUE) {
+		DWORD err = GetLastError();
+		if (err == ERROR_FILE_NOT_FOUND || err == ERROR_PATH_NOT_FOUND) {
+			return true; // nothing to enumerate
+		}
+		throw std::system_error(err, std::system_category(),
+			"FindFirstFileEx failed to enumerate directory");
+	}
+
+	do {
+		if (!lstrcmpW(fd.cFileName, L".") || !lstrcmpW(fd.cFileName, L"..")) {
+			continue;
+		}
+		if (!callback(dir, fd)) { // entry doesn't interest the caller anymore
+			FindClose(hFind);
+			return false;
+		}
+	} while (FindNextFileW(hFind, &fd));
+
+	FindClose(hFind);
+	return true;
+}
+
+// Recursive enum_dir: streams every entry of the tree, depth-first. The filter
+// runs on the raw find data before anything is allocated or descended into;
+// entries it rejects are skipped entirely, including whole subdirectories.
+// Return false from the callback to stop the traversal.
+template<typename filterT, typename callbackT>
+inline bool enum_dir_recursive(const std::wstring& dirPath, filterT&& filter, callbackT&& callback) {
+	return enum_dir(dirPath,
+		[&](const std::wstring& dir, const WIN32_FIND_DATAW& fd) -> bool {
+			if (!filter(dir, fd)) return true; // rejected before any allocation
+			if (!callback(dir, fd)) return false;
+			if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+				return enum_dir_recursive(dir + L'\\' + fd.cFileName, filter, callback);
+			}
+			return true;
+		});
+}
+
+// Recursive enum_dir without a filter.
+template<typename callbackT>
+inline bool enum_dir_recursive(const std::wstring& dirPath, callbackT&& callback) {
+	return enum_dir_recursive(dirPath,
+		[](const std::wstring&, const WIN32_FIND_DATAW&) noexcept -> bool { return true; },
+		callback);
+}
+
+// Parallel recursive enumeration: first-level subdirectories are traversed
+// concurrently on the shared thread pool, which hides NTFS metadata latency on
+// big trees. Filter and callback must be thread-safe — they run concurrently —
+// and the callback has no early-stop form here. Blocks until the tree is done.
+template<typename filterT, typename callbackT>
+inline void enum_dir_parallel(const std::wstring& dirPath, filterT&& filter, callbackT&& callback) {
+	struct _pending final {
+		std::mutex              mtx;
+		std::condition_variable cv;
+		size_t                  count = 0;
+	} pending;
+
+	enum_dir(dirPath,
+		[&](const std::wstring& dir, const WIN32_FIND_DATAW& fd) -> bool {
+			if (!filter(dir, fd)) return true;
+			callback(dir, fd);
+			if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+				std::wstring subDir = dir + L'\\' + fd.cFileName;
+				{
+					std::lock_guard<std::mutex> lock(pending.mtx);
+					++pending.count;
+				}
+				_wli::thread_pool::instance().submit([&, subDir]() noexcept {
+					try {
+						enum_dir_recursive(subDir, filter, callback);
+					} catch (...) {
+						// swallowed: a vanished subdirectory shouldn't abort the siblings
+					}
+					std::lock_guard<std::mutex> lock(pending.mtx);
+					--pending.count;
+					pending.cv.notify_one();
+				});
+			}
+			return true;
+		});
+
+	std::unique_lock<std::mutex> lock(pending.mtx);
+	pending.cv.wait(lock, [&]() noexcept -> bool { return pending.count == 0; });
+}
+
 }//namespace path
 }//namespace wl
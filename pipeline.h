@@ -0,0 +1,254 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include <process.h>
+#include "internals/ui_marshal.h"
+
+namespace wl {
+
+// Reusable load-transform-display pipeline: a producer pushes records, the
+// transform stage fans out over dedicated worker threads, one per core, and
+// the results are delivered in batches to a callback on the UI thread of
+// the given window. The stages are connected by bounded queues, so a fast
+// producer blocks instead of ballooning memory, and UI delivery is a blocking
+// hand-off — the window can never be flooded faster than it consumes. Both
+// record types must be default-constructible and movable. The pipeline object
+// must outlive the run; keep it a member of the window and wait for on_done.
+template<typename inT, typename outT>
+class pipeline final {
+private:
+	// Bounded MPMC queue; push blocks while full, pop blocks while empty,
+	// close() releases everyone and drains the leftovers through pop.
+	template<typename T>
+	class _channel final {
+	private:
+		std::deque<T>           _items;
+		std::mutex              _mtx;
+		std::condition_variable _cvPush, _cvPop;
+		size_t                  _cap = 0;
+		bool                    _closed = false;
+
+	public:
+		void reset(size_t cap) {
+			std::lock_guard<std::mutex> lock{this->_mtx};
+			this->_items.clear();
+			this->_cap = cap;
+			this->_closed = false;
+		}
+
+		bool push(T item) {
+			std::unique_lock<std::mutex> lock{this->_mtx};
+			this->_cvPush.wait(lock, [this]() noexcept -> bool {
+				return this->_items.size() < this->_cap || this->_closed;
+			});
+			if (this->_closed) return false;
+			this->_items.emplace_back(std::move(item));
+			lock.unlock();
+			this->_cvPop.notify_one();
+			return true;
+		}
+
+		bool pop(T& out) {
+			std::unique_lock<std::mutex> lock{this->_mtx};
+			this->_cvPop.wait(lock, [this]() noexcept -> bool {
+				return !this->_items.empty() || this->_closed;
+			});
+			if (this->_items.empty()) return false; // closed and fully drained
+			out = std::move(this->_items.front());
+			this->_items.pop_front();
+			lock.unlock();
+			this->_cvPush.notify_one();
+			return true;
+		}
+
+		bool try_pop(T& out) {
+			std::lock_guard<std::mutex> lock{this->_mtx};
+			if (this->_items.empty()) return false;
+			out = std::move(this->_items.front());
+			this->_items.pop_front();
+			this->_cvPush.notify_one();
+			return true;
+		}
+
+		void close() {
+			{
+				std::lock_guard<std::mutex> lock{this->_mtx};
+				this->_closed = true;
+			}
+			this->_cvPush.notify_all();
+			this->_cvPop.notify_all();
+		}
+	};
+
+	_channel<inT>  _input;
+	_channel<outT> _output;
+
+	std::function<outT(inT)>                 _transform;
+	std::function<void(std::vector<outT>&)>  _uiBatch;
+	std::function<void()>                    _doneCallback;
+	HWND                                     _hWnd = nullptr;
+	size_t                                   _inputCap = 1024;
+	size_t                                   _outputCap = 1024;
+	size_t                                   _uiBatchSize = 256;
+	std::atomic<int>                         _liveTransforms{0};
+	std::atomic<bool>                        _running{false};
+
+public:
+	pipeline() = default;
+	pipeline(const pipeline&) = delete;
+	pipeline& operator=(const pipeline&) = delete; // worker threads hold this, so not even movable
+
+	// Capacity of the producer-to-transform queue; a full queue blocks push().
+	pipeline& set_input_capacity(size_t numItems) noexcept {
+		this->_inputCap = numItems;
+		return *this;
+	}
+
+	// Capacity of the transform-to-UI queue; a full queue blocks the workers.
+	pipeline& set_output_capacity(size_t numItems) noexcept {
+		this->_outputCap = numItems;
+		return *this;
+	}
+
+	// Most results handed to the UI callback at once; bigger batches mean
+	// fewer cross-thread hops, smaller ones mean earlier first rows.
+	pipeline& set_ui_batch(size_t numItems) noexcept {
+		this->_uiBatchSize = numItems ? numItems : 1;
+		return *this;
+	}
+
+	// The per-record transform, run concurrently on the pool workers. It must
+	// contain its own error handling; a record whose transform throws is dropped.
+	pipeline& on_transform(std::function<outT(inT)> transform) {
+		this->_transform = std::move(transform);
+		return *this;
+	}
+
+	// The display stage: receives result batches on the thread of the given
+	// window, which must be a library-created one. Typical body pushes rows
+	// into a listview under a batch_update scope.
+	pipeline& on_ui_batch(HWND hWnd, std::function<void(std::vector<outT>&)> callback) {
+		this->_hWnd = hWnd;
+		this->_uiBatch = std::move(callback);
+		return *this;
+	}
+
+	// Runs on the UI thread after the last batch was delivered.
+	pipeline& on_done(std::function<void()> callback) {
+		this->_doneCallback = std::move(callback);
+		return *this;
+	}
+
+	// Starts the pipeline and returns immediately. The producer runs on its
+	// own thread and feeds records through the given push function, which
+	// blocks under backpressure and returns false if the pipeline shut down;
+	// the producer simply returning ends the stream, and completion flows
+	// through the stages to on_done.
+	void run(std::function<void(const std::function<bool(inT)>&)> producer) {
+		if (!this->_transform || !this->_uiBatch || !this->_hWnd) {
+			throw std::logic_error("Trying to run a pipeline without transform or UI stage.");
+		}
+		bool wasRunning = this->_running.exchange(true);
+		if (wasRunning) {
+			throw std::logic_error("Trying to run a pipeline that is already running.");
+		}
+
+		this->_input.reset(this->_inputCap);
+		this->_output.reset(this->_outputCap);
+
+		SYSTEM_INFO si{};
+		GetNativeSystemInfo(&si);
+		int numWorkers = si.dwNumberOfProcessors ? static_cast<int>(si.dwNumberOfProcessors) : 2;
+		this->_liveTransforms.store(numWorkers);
+
+		// Transform stage: dedicated threads, not the process-wide pool. A
+		// worker parks in push() whenever the UI stage falls behind, and pool
+		// workers must never be held hostage on blocking waits — a pool-sized
+		// fan-out would starve every other pool client for the whole run, and
+		// deadlock outright if the UI thread then issued pool work of its own.
+		// All workers pull from the one shared input queue, so load balances
+		// itself — an idle one takes the next record no matter which fell behind.
+		for (int i = 0; i < numWorkers; ++i) {
+			_run_detached([this]() noexcept {
+				inT item{};
+				while (this->_input.pop(item)) {
+					try {
+						if (!this->_output.push(this->_transform(std::move(item)))) break;
+					} catch (...) {
+						// transform threw, this record is dropped
+					}
+				}
+				if (this->_liveTransforms.fetch_sub(1) == 1) {
+					this->_output.close(); // last worker turns off the lights
+				}
+			});
+		}
+
+		// Collector: dedicated thread, because it blocks inside ui_marshal::send
+		// for as long as the UI stage takes — that blocking is the backpressure,
+		// and a pool worker must not be held hostage by it.
+		_run_detached([this]() noexcept {
+			std::vector<outT> batch;
+			outT item{};
+			while (this->_output.pop(item)) {
+				batch.clear();
+				batch.push_back(std::move(item));
+				while (batch.size() < this->_uiBatchSize && this->_output.try_pop(item)) {
+					batch.push_back(std::move(item));
+				}
+				_wli::ui_marshal::send(this->_hWnd, [this, &batch]() {
+					this->_uiBatch(batch); // send blocks, so the reference stays valid
+				});
+			}
+			this->_running.store(false);
+			if (this->_doneCallback) {
+				_wli::ui_marshal::post(this->_hWnd, this->_doneCallback);
+			}
+		});
+
+		// Producer: also a dedicated thread, it may sit in file I/O for a while.
+		_run_detached([this, producer]() noexcept {
+			try {
+				producer([this](inT item) -> bool {
+					return this->_input.push(std::move(item));
+				});
+			} catch (...) {
+				// producer died; closing below ends the downstream stages cleanly
+			}
+			this->_input.close();
+		});
+	}
+
+	// Whether a run is still in flight (UI batches may still be pending).
+	bool running() const noexcept {
+		return this->_running.load();
+	}
+
+private:
+	static void _run_detached(std::function<void()> func) {
+		auto* pFunc = new std::function<void()>(std::move(func));
+		uintptr_t hThread = _beginthreadex(nullptr, 0,
+			[](void* ptr) noexcept -> unsigned int
+		{
+			std::function<void()>* pF = reinterpret_cast<std::function<void()>*>(ptr);
+			(*pF)();
+			delete pF;
+			return 0;
+		}, pFunc, 0, nullptr);
+		CloseHandle(reinterpret_cast<HANDLE>(hThread));
+	}
+};
+
+}//namespace wl
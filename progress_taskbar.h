@@ -19,6 +19,11 @@ private:
 	HWND                    _hWnd = nullptr;
 	com::lib                _comLib{com::lib::init::LATER};
 	com::ptr<ITaskbarList3> _bar;
+	UINT                    _throttleIntervalMs = 33; // ~30Hz
+	ULONGLONG               _lastThrottleTick = 0;
+	size_t                  _pendingPercent = 0;
+	size_t                  _pendingTotal = 0;
+	bool                    _hasPendingPos = false;
 
 public:
 	progress_taskbar() = default;
@@ -52,6 +57,43 @@ public:
 		return this->set_pos(static_cast<size_t>(percent + 0.5), 100);
 	}
 
+	// Sets how often set_pos_throttled actually calls into COM.
+	progress_taskbar& set_throttle_interval(UINT ms) noexcept {
+		this->_throttleIntervalMs = ms;
+		return *this;
+	}
+
+	// Rate-limited set_pos: the SetProgressValue COM call runs at most once per
+	// throttle interval (default ~30Hz); skipped values are remembered, so call
+	// flush_pos() when the work finishes to show the final one.
+	progress_taskbar& set_pos_throttled(size_t percent, size_t total) noexcept {
+		ULONGLONG now = GetTickCount64();
+		if (now - this->_lastThrottleTick >= this->_throttleIntervalMs) {
+			this->_lastThrottleTick = now;
+			this->_hasPendingPos = false;
+			return this->set_pos(percent, total);
+		}
+		this->_pendingPercent = percent; // cheap tick check failed, just remember it
+		this->_pendingTotal = total;
+		this->_hasPendingPos = true;
+		return *this;
+	}
+
+	// Value is 0-100.
+	progress_taskbar& set_pos_throttled(double percent) noexcept {
+		return this->set_pos_throttled(static_cast<size_t>(percent + 0.5), 100);
+	}
+
+	// Shows the last value passed to set_pos_throttled, if it was skipped.
+	progress_taskbar& flush_pos() noexcept {
+		if (this->_hasPendingPos) {
+			this->_hasPendingPos = false;
+			this->_lastThrottleTick = GetTickCount64();
+			return this->set_pos(this->_pendingPercent, this->_pendingTotal);
+		}
+		return *this;
+	}
+
 	progress_taskbar& set_waiting(bool isWaiting) noexcept {
 		return this->_set_state(isWaiting ? TBPF_INDETERMINATE : TBPF_NORMAL);
 	}
@@ -34,6 +34,10 @@ private:
 
 	HWND                   _hWnd = nullptr;
 	_wli::base_native_ctrl _baseNativeCtrl{_hWnd};
+	UINT                   _throttleIntervalMs = 33; // ~30Hz
+	ULONGLONG              _lastThrottleTick = 0;
+	int                    _pendingPos = 0;
+	bool                   _hasPendingPos = false;
 
 public:
 	// Wraps window style changes done by Get/SetWindowLongPtr.
@@ -80,6 +84,45 @@ public:
 		return this->set_pos(static_cast<int>(pos + 0.5));
 	}
 
+	// Sets how often set_pos_throttled actually updates the control.
+	progressbar& set_throttle_interval(UINT ms) noexcept {
+		this->_throttleIntervalMs = ms;
+		return *this;
+	}
+
+	// Rate-limited set_pos for tight worker loops: updates the control at most
+	// once per throttle interval (default ~30Hz), remembering skipped values;
+	// call flush_pos() when the loop finishes so the final value is shown.
+	progressbar& set_pos_throttled(int pos) noexcept {
+		ULONGLONG now = GetTickCount64();
+		if (now - this->_lastThrottleTick >= this->_throttleIntervalMs) {
+			this->_lastThrottleTick = now;
+			this->_hasPendingPos = false;
+			return this->set_pos(pos);
+		}
+		this->_pendingPos = pos; // cheap tick check failed, just remember it
+		this->_hasPendingPos = true;
+		return *this;
+	}
+
+	progressbar& set_pos_throttled(size_t pos) noexcept {
+		return this->set_pos_throttled(static_cast<int>(pos));
+	}
+
+	progressbar& set_pos_throttled(double pos) noexcept {
+		return this->set_pos_throttled(static_cast<int>(pos + 0.5));
+	}
+
+	// Shows the last value passed to set_pos_throttled, if it was skipped.
+	progressbar& flush_pos() noexcept {
+		if (this->_hasPendingPos) {
+			this->_hasPendingPos = false;
+			this->_lastThrottleTick = GetTickCount64();
+			return this->set_pos(this->_pendingPos);
+		}
+		return *this;
+	}
+
 	progressbar& set_waiting(bool isWaiting) noexcept {
 		if (isWaiting) {
 			this->style.set_style(true, PBS_MARQUEE); // set this on resource editor won't work
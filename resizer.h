@@ -8,6 +8,7 @@
 #pragma once
 #include <vector>
 #include "internals/params.h"
+#include "dpi.h"
 #include "wnd.h"
 
 namespace wl {
@@ -16,23 +17,41 @@ namespace wl {
 class resizer final {
 public:
 	enum class go {
-		REPOS,  // control size is fixed; control moves around anchored
-		RESIZE, // control size stretches; control doesn't move
-		NOTHING // control doesn't move or resize
+		REPOS,      // control size is fixed; control moves around anchored
+		RESIZE,     // control size stretches; control doesn't move
+		PROPORTION, // control position and size both scale with the parent, percent-based
+		NOTHING     // control doesn't move or resize
 	};
 
 private:
 	struct _ctrl final {
 		HWND hChild;
-		RECT rcOrig;   // original coordinates relative to parent
+		RECT rcOrig;   // original coordinates relative to parent, at the current DPI
 		go   modeHorz; // horizontal mode
 		go   modeVert; // vertical mode
+		RECT rcLast{};     // rect of the last pass, to skip controls that didn't move
+		bool dirty = false;
+		RECT rcCaptured{}; // rect as captured by add(), at the captured DPI
 	};
 
 	std::vector<_ctrl> _ctrls;
 	SIZE               _szOrig;
+	SIZE               _szCur{};     // last size seen by a layout pass
+	SIZE               _szCaptured{};     // parent size as captured by the first add()
+	UINT               _dpiCaptured = 0;  // monitor DPI at that moment
+	HWND               _hParent = nullptr;
+	UINT               _minIntervalMs = 0; // 0 = one layout pass per WM_SIZE
+	ULONGLONG          _lastPassTick = 0;
+	SIZE               _szPending{};
+	bool               _timerSet = false;
 
 public:
+	~resizer() {
+		if (this->_timerSet) {
+			KillTimer(this->_hParent, reinterpret_cast<UINT_PTR>(this));
+		}
+	}
+
 	resizer& add(HWND hCtrl, go modeHorz, go modeVert) {
 		return this->_add_one(hCtrl, modeHorz, modeVert);
 	}
@@ -83,8 +102,38 @@ public:
 		return *this;
 	}
 
+	// Adds a control created after the parent has already been resized, like the
+	// lazily created controls of a tab page. The control must sit at its original
+	// design-time coordinates; it's recorded like an ordinary add() and then
+	// immediately moved/resized to match the current parent size.
+	resizer& add_late(HWND hCtrl, go modeHorz, go modeVert) {
+		this->_add_one(hCtrl, modeHorz, modeVert);
+		this->_apply_one(this->_ctrls.back(), this->_szCur.cx, this->_szCur.cy);
+		return *this;
+	}
+
+	resizer& add_late(const wnd& ctrl, go modeHorz, go modeVert) {
+		return this->add_late(ctrl.hwnd(), modeHorz, modeVert);
+	}
+
+	resizer& add_late(HWND hParent, int ctrlId, go modeHorz, go modeVert) {
+		return this->add_late(GetDlgItem(hParent, ctrlId), modeHorz, modeVert);
+	}
+
+	resizer& add_late(const wnd* parent, int ctrlId, go modeHorz, go modeVert) {
+		return this->add_late(GetDlgItem(parent->hwnd(), ctrlId), modeHorz, modeVert);
+	}
+
+	// Coalesces WM_SIZE bursts during interactive drags to at most one layout
+	// pass per interval; 16ms gives roughly one pass per frame. A trailing
+	// timer pass always picks up the final size. Zero restores a pass per tick.
+	resizer& set_min_interval(UINT ms) noexcept {
+		this->_minIntervalMs = ms;
+		return *this;
+	}
+
 	// Updates controls, intended to be called with parent's WM_SIZE processing.
-	void adjust(const params& p) const noexcept {
+	void adjust(const params& p) noexcept {
 		int state = static_cast<int>(p.wParam);
 		int cx    = LOWORD(p.lParam);
 		int cy    = HIWORD(p.lParam);
@@ -93,34 +142,137 @@ public:
 			return; // only if created() was called; if minimized, no need to resize
 		}
 
-		HDWP hdwp = BeginDeferWindowPos(static_cast<int>(this->_ctrls.size()));
-		for (const _ctrl& control : this->_ctrls) {
-			UINT uFlags = SWP_NOZORDER;
-			if (control.modeHorz == go::REPOS && control.modeVert == go::REPOS) { // reposition both vert & horz
-				uFlags |= SWP_NOSIZE;
-			} else if (control.modeHorz == go::RESIZE && control.modeVert == go::RESIZE) { // resize both vert & horz
-				uFlags |= SWP_NOMOVE;
+		if (this->_minIntervalMs) {
+			ULONGLONG now = GetTickCount64();
+			ULONGLONG elapsed = now - this->_lastPassTick;
+			this->_szPending = {cx, cy}; // latest size always wins
+			if (elapsed < this->_minIntervalMs) {
+				if (!this->_timerSet) { // schedule the trailing pass
+					this->_timerSet = true;
+					SetTimer(this->_hParent, reinterpret_cast<UINT_PTR>(this),
+						static_cast<UINT>(this->_minIntervalMs - elapsed), _throttle_timer_proc);
+				}
+				return;
 			}
+		}
+		this->_layout_pass(cx, cy);
+	}
+
+	// Rescales the base rect table to the new monitor DPI and runs one layout
+	// pass; call from WM_DPICHANGED passing HIWORD(wParam). Scaling always
+	// starts from the rects captured by add(), so repeated monitor hops don't
+	// accumulate rounding drift — a cross-monitor drag is one table recompute,
+	// with no per-control metric queries.
+	resizer& rescale_dpi(UINT newDpi) noexcept {
+		if (!this->_dpiCaptured || newDpi == 0) return *this; // nothing captured yet
+
+		auto sc = [&](LONG v) noexcept -> LONG {
+			return MulDiv(v, static_cast<int>(newDpi), static_cast<int>(this->_dpiCaptured));
+		};
+		this->_szOrig = {sc(this->_szCaptured.cx), sc(this->_szCaptured.cy)};
+		for (_ctrl& control : this->_ctrls) {
+			control.rcOrig = {sc(control.rcCaptured.left), sc(control.rcCaptured.top),
+				sc(control.rcCaptured.right), sc(control.rcCaptured.bottom)};
+		}
+		// The OS also resizes the window to its suggested rect, whose WM_SIZE
+		// will run another pass; the dirty diff makes this one cheap.
+		this->_layout_pass(this->_szCur.cx, this->_szCur.cy);
+		return *this;
+	}
+
+private:
+	// Recomputes and applies the rect of every control whose rect changed.
+	void _layout_pass(int cx, int cy) noexcept {
+		this->_lastPassTick = GetTickCount64();
+		this->_szCur = {cx, cy}; // remembered for controls added late
 
+		size_t dirtyCount = 0;
+		for (_ctrl& control : this->_ctrls) {
+			int x = this->_calc_x(control, cx);
+			int y = this->_calc_y(control, cy);
+			RECT rcNew{x, y,
+				x + this->_calc_cx(control, cx),
+				y + this->_calc_cy(control, cy)};
+			control.dirty = !EqualRect(&rcNew, &control.rcLast);
+			if (control.dirty) {
+				control.rcLast = rcNew;
+				++dirtyCount;
+			}
+		}
+		if (!dirtyCount) return; // nothing moved, skip the whole DeferWindowPos cycle
+
+		HDWP hdwp = BeginDeferWindowPos(static_cast<int>(dirtyCount));
+		for (const _ctrl& control : this->_ctrls) {
+			if (!control.dirty) continue;
 			DeferWindowPos(hdwp, control.hChild, nullptr,
-				control.modeHorz == go::REPOS ?
-				cx - this->_szOrig.cx + control.rcOrig.left :
-				control.rcOrig.left, // keep original pos
-				control.modeVert == go::REPOS ?
-				cy - this->_szOrig.cy + control.rcOrig.top :
-				control.rcOrig.top, // keep original pos
-				control.modeHorz == go::RESIZE ?
-				cx - this->_szOrig.cx + control.rcOrig.right - control.rcOrig.left :
-				control.rcOrig.right - control.rcOrig.left, // keep original width
-				control.modeVert == go::RESIZE ?
-				cy - this->_szOrig.cy + control.rcOrig.bottom - control.rcOrig.top :
-				control.rcOrig.bottom - control.rcOrig.top, // keep original height
-				uFlags);
+				control.rcLast.left, control.rcLast.top,
+				control.rcLast.right - control.rcLast.left,
+				control.rcLast.bottom - control.rcLast.top,
+				this->_calc_flags(control));
 		}
 		EndDeferWindowPos(hdwp);
 	}
 
-private:
+	static void CALLBACK _throttle_timer_proc(HWND hWnd, UINT, UINT_PTR idEvent, DWORD) noexcept {
+		resizer* pSelf = reinterpret_cast<resizer*>(idEvent); // timer id carries the instance
+		KillTimer(hWnd, idEvent);
+		pSelf->_timerSet = false;
+		pSelf->_layout_pass(pSelf->_szPending.cx, pSelf->_szPending.cy);
+	}
+
+	int _calc_x(const _ctrl& control, int cx) const noexcept {
+		switch (control.modeHorz) {
+		case go::REPOS:      return cx - this->_szOrig.cx + control.rcOrig.left;
+		case go::PROPORTION: return MulDiv(control.rcOrig.left, cx, this->_szOrig.cx); // integer-only percent scaling
+		default:             return control.rcOrig.left; // keep original pos
+		}
+	}
+
+	int _calc_y(const _ctrl& control, int cy) const noexcept {
+		switch (control.modeVert) {
+		case go::REPOS:      return cy - this->_szOrig.cy + control.rcOrig.top;
+		case go::PROPORTION: return MulDiv(control.rcOrig.top, cy, this->_szOrig.cy);
+		default:             return control.rcOrig.top; // keep original pos
+		}
+	}
+
+	int _calc_cx(const _ctrl& control, int cx) const noexcept {
+		switch (control.modeHorz) {
+		case go::RESIZE:     return cx - this->_szOrig.cx + control.rcOrig.right - control.rcOrig.left;
+		case go::PROPORTION: return MulDiv(control.rcOrig.right, cx, this->_szOrig.cx) -
+			MulDiv(control.rcOrig.left, cx, this->_szOrig.cx); // scale both edges, so neighbors stay gap-consistent
+		default:             return control.rcOrig.right - control.rcOrig.left; // keep original width
+		}
+	}
+
+	int _calc_cy(const _ctrl& control, int cy) const noexcept {
+		switch (control.modeVert) {
+		case go::RESIZE:     return cy - this->_szOrig.cy + control.rcOrig.bottom - control.rcOrig.top;
+		case go::PROPORTION: return MulDiv(control.rcOrig.bottom, cy, this->_szOrig.cy) -
+			MulDiv(control.rcOrig.top, cy, this->_szOrig.cy);
+		default:             return control.rcOrig.bottom - control.rcOrig.top; // keep original height
+		}
+	}
+
+	static UINT _calc_flags(const _ctrl& control) noexcept {
+		UINT uFlags = SWP_NOZORDER;
+		if (control.modeHorz == go::REPOS && control.modeVert == go::REPOS) { // reposition both vert & horz
+			uFlags |= SWP_NOSIZE;
+		} else if (control.modeHorz == go::RESIZE && control.modeVert == go::RESIZE) { // resize both vert & horz
+			uFlags |= SWP_NOMOVE;
+		}
+		return uFlags;
+	}
+
+	void _apply_one(_ctrl& control, int cx, int cy) const noexcept {
+		int x = this->_calc_x(control, cx);
+		int y = this->_calc_y(control, cy);
+		int w = this->_calc_cx(control, cx);
+		int h = this->_calc_cy(control, cy);
+		control.rcLast = {x, y, x + w, y + h};
+		SetWindowPos(control.hChild, nullptr, x, y, w, h, this->_calc_flags(control));
+	}
+
 	resizer& _add_one(HWND hChild, go modeHorz, go modeVert) {
 		HWND hParent = GetParent(hChild);
 		if (this->_ctrls.empty()) { // first call to _addOne()
@@ -128,6 +280,10 @@ private:
 			GetClientRect(hParent, &rcP);
 			this->_szOrig.cx = rcP.right;
 			this->_szOrig.cy = rcP.bottom; // save original size of parent
+			this->_szCur = this->_szOrig;
+			this->_szCaptured = this->_szOrig;
+			this->_dpiCaptured = _wli::dpi_of_window(hParent); // rescale_dpi() scales relative to this
+			this->_hParent = hParent; // also carries the throttle timer
 		}
 
 		RECT rcCtrl{};
@@ -135,6 +291,8 @@ private:
 		this->_ctrls.push_back({hChild, rcCtrl, modeHorz, modeVert});
 		ScreenToClient(hParent, reinterpret_cast<POINT*>(&this->_ctrls.back().rcOrig)); // client coordinates relative to parent
 		ScreenToClient(hParent, reinterpret_cast<POINT*>(&this->_ctrls.back().rcOrig.right));
+		this->_ctrls.back().rcLast = this->_ctrls.back().rcOrig;
+		this->_ctrls.back().rcCaptured = this->_ctrls.back().rcOrig;
 		return *this;
 	}
 };
@@ -0,0 +1,204 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <functional>
+#include "internals/params.h"
+#include "wnd.h"
+
+namespace wl {
+
+// Smooth scrolling controller for virtual views. Positions are kept in 64-bit
+// units internally — content may exceed the 32-bit scrollbar range, which only
+// carries a scaled thumb — and incoming wheel/gesture deltas are accumulated
+// and flushed as one SetScrollInfo plus one invalidation per frame, so
+// high-resolution touchpad floods don't cause a scroll round trip per tick.
+class scroll_controller final {
+private:
+	static const int _MAP_MAX = 0x7FFFFFF; // scrollbar steps when content overflows 32 bits
+
+	HWND      _hWnd = nullptr;
+	int       _bar = SB_VERT;
+	long long _contentUnits = 0; // total virtual extent, in caller units (lines, pixels...)
+	long long _pageUnits = 0;
+	long long _pos = 0;
+	long long _pendingDelta = 0;
+	UINT      _frameIntervalMs = 16; // ~60Hz flushes
+	ULONGLONG _lastFlushTick = 0;
+	bool      _timerSet = false;
+	std::function<void(long long)> _onUpdate; // receives the new position per flush
+
+public:
+	~scroll_controller() {
+		if (this->_timerSet) {
+			KillTimer(this->_hWnd, reinterpret_cast<UINT_PTR>(this));
+		}
+	}
+
+	scroll_controller() = default;
+	scroll_controller(const scroll_controller&) = delete;
+	scroll_controller& operator=(const scroll_controller&) = delete; // the flush timer is keyed by this
+
+	// Binds the controller to the window whose scrollbar it drives.
+	scroll_controller& attach(HWND hWnd, int bar = SB_VERT) noexcept {
+		this->_hWnd = hWnd;
+		this->_bar = bar;
+		return *this;
+	}
+
+	scroll_controller& attach(const wnd* window, int bar = SB_VERT) noexcept {
+		return this->attach(window->hwnd(), bar);
+	}
+
+	// Sets the lambda invoked once per flush with the new position; repaint the
+	// visible range from it.
+	scroll_controller& on_update(std::function<void(long long)> callback) {
+		this->_onUpdate = std::move(callback);
+		return *this;
+	}
+
+	// Sets how often accumulated deltas are flushed to the scrollbar.
+	scroll_controller& set_frame_interval(UINT ms) noexcept {
+		this->_frameIntervalMs = ms;
+		return *this;
+	}
+
+	long long pos() const noexcept          { return this->_pos; }
+	long long content_size() const noexcept { return this->_contentUnits; }
+	long long page_size() const noexcept    { return this->_pageUnits; }
+
+	// Declares the virtual extent and page size, in caller units; the content
+	// may be far beyond what a scrollbar can address directly.
+	scroll_controller& set_virtual_size(long long contentUnits, long long pageUnits) noexcept {
+		this->_contentUnits = contentUnits;
+		this->_pageUnits = pageUnits;
+		this->_apply(); // reclamp and repaint the bar right away
+		return *this;
+	}
+
+	// Accumulates a movement in caller units; flushed on the next frame tick.
+	scroll_controller& add_delta(long long units) noexcept {
+		this->_pendingDelta += units;
+
+		ULONGLONG now = GetTickCount64();
+		ULONGLONG elapsed = now - this->_lastFlushTick;
+		if (elapsed >= this->_frameIntervalMs) {
+			this->flush();
+		} else if (!this->_timerSet) { // one trailing flush per burst
+			this->_timerSet = true;
+			SetTimer(this->_hWnd, reinterpret_cast<UINT_PTR>(this),
+				static_cast<UINT>(this->_frameIntervalMs - elapsed), _flush_timer_proc);
+		}
+		return *this;
+	}
+
+	// Accumulates a WM_MOUSEWHEEL event; fractional high-resolution deltas are
+	// carried over, so precision touchpads scroll smoothly.
+	scroll_controller& wheel(const params& p, long long unitsPerNotch = 3) noexcept {
+		short delta = GET_WHEEL_DELTA_WPARAM(p.wParam);
+		this->_wheelRemainder += static_cast<long long>(-delta) * unitsPerNotch;
+		long long wholeUnits = this->_wheelRemainder / WHEEL_DELTA;
+		this->_wheelRemainder -= wholeUnits * WHEEL_DELTA;
+		return this->add_delta(wholeUnits);
+	}
+
+	// Processes a WM_VSCROLL/WM_HSCROLL event, mapping the 32-bit thumb back
+	// into the 64-bit position space.
+	scroll_controller& scroll_event(const params& p) noexcept {
+		switch (LOWORD(p.wParam)) {
+		case SB_LINEUP:        this->add_delta(-1); break;
+		case SB_LINEDOWN:      this->add_delta(+1); break;
+		case SB_PAGEUP:        this->add_delta(-this->_pageUnits); break;
+		case SB_PAGEDOWN:      this->add_delta(+this->_pageUnits); break;
+		case SB_TOP:           this->set_pos(0); break;
+		case SB_BOTTOM:        this->set_pos(this->_max_pos()); break;
+		case SB_THUMBTRACK:
+		case SB_THUMBPOSITION: {
+			SCROLLINFO si{sizeof(SCROLLINFO)};
+			si.fMask = SIF_TRACKPOS; // 32-bit, unlike the 16-bit HIWORD(wParam)
+			GetScrollInfo(this->_hWnd, this->_bar, &si);
+			this->set_pos(this->_unmap_pos(si.nTrackPos));
+			break;
+		}
+		}
+		return *this;
+	}
+
+	// Jumps straight to the position, clamped; flushes immediately.
+	scroll_controller& set_pos(long long posUnits) noexcept {
+		this->_pendingDelta = posUnits - this->_pos;
+		return this->flush();
+	}
+
+	// Applies whatever is accumulated right now: one SetScrollInfo, one
+	// InvalidateRect, one callback.
+	scroll_controller& flush() noexcept {
+		this->_lastFlushTick = GetTickCount64();
+		if (!this->_pendingDelta) return *this;
+
+		long long newPos = this->_pos + this->_pendingDelta;
+		this->_pendingDelta = 0;
+		if (newPos < 0) newPos = 0;
+		if (newPos > this->_max_pos()) newPos = this->_max_pos();
+		if (newPos == this->_pos) return *this;
+
+		this->_pos = newPos;
+		this->_apply();
+		return *this;
+	}
+
+private:
+	long long _wheelRemainder = 0; // sub-notch leftovers of high-resolution wheels
+
+	long long _max_pos() const noexcept {
+		long long maxPos = this->_contentUnits - this->_pageUnits;
+		return maxPos > 0 ? maxPos : 0;
+	}
+
+	bool _needs_scaling() const noexcept {
+		return this->_contentUnits > static_cast<long long>(INT_MAX);
+	}
+
+	int _map_pos(long long posUnits) const noexcept {
+		if (!this->_needs_scaling()) return static_cast<int>(posUnits);
+		long long maxPos = this->_max_pos();
+		return maxPos ? static_cast<int>(posUnits * _MAP_MAX / maxPos) : 0;
+	}
+
+	long long _unmap_pos(int sbPos) const noexcept {
+		if (!this->_needs_scaling()) return sbPos;
+		return static_cast<long long>(sbPos) * this->_max_pos() / _MAP_MAX;
+	}
+
+	void _apply() noexcept {
+		SCROLLINFO si{sizeof(SCROLLINFO)};
+		si.fMask = SIF_RANGE | SIF_PAGE | SIF_POS;
+		si.nMin = 0;
+		if (this->_needs_scaling()) { // the bar only carries a scaled thumb
+			si.nMax = _MAP_MAX;
+			si.nPage = static_cast<UINT>(
+				static_cast<long long>(_MAP_MAX) * this->_pageUnits / this->_contentUnits);
+		} else {
+			si.nMax = static_cast<int>(this->_contentUnits ? this->_contentUnits - 1 : 0);
+			si.nPage = static_cast<UINT>(this->_pageUnits);
+		}
+		si.nPos = this->_map_pos(this->_pos);
+		SetScrollInfo(this->_hWnd, this->_bar, &si, TRUE);
+
+		InvalidateRect(this->_hWnd, nullptr, FALSE); // one repaint per flush
+		if (this->_onUpdate) this->_onUpdate(this->_pos);
+	}
+
+	static void CALLBACK _flush_timer_proc(HWND hWnd, UINT, UINT_PTR idEvent, DWORD) noexcept {
+		scroll_controller* pSelf = reinterpret_cast<scroll_controller*>(idEvent);
+		KillTimer(hWnd, idEvent);
+		pSelf->_timerSet = false;
+		pSelf->flush();
+	}
+};
+
+}//namespace wl
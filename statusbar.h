@@ -136,6 +136,14 @@ public:
 
 	std::wstring get_text(size_t iPart) const {
 		std::wstring buf;
+		this->get_text_to(iPart, buf);
+		return buf;
+	}
+
+	// Retrieves the text of the given part into a caller-provided buffer, reusing
+	// its capacity across calls; handy for status text polled on a timer. Returns buf.
+	std::wstring& get_text_to(size_t iPart, std::wstring& buf) const {
+		buf.clear();
 		int len = LOWORD(SendMessageW(this->_hWnd, SB_GETTEXTLENGTH, iPart, 0));
 		if (len) {
 			buf.resize(len + 1, L'\0');
@@ -7,8 +7,10 @@
 
 #pragma once
 #include <stdexcept>
+#include <utility>
 #include <vector>
 #include "internals/str_priv.h"
+#include "wstr_view.h"
 
 namespace wl {
 
@@ -74,6 +76,32 @@ inline std::wstring format(const std::wstring& strFormat, const argsT&... args)
 		std::forward<const argsT&>(args)...);
 }
 
+// Type-safe sprintf taking a string literal: the format length is captured at
+// compile time, so no runtime walk of the format string happens before printf.
+template<size_t N, typename ...argsT>
+inline std::wstring format(const wchar_t (&strFormat)[N], const argsT&... args) {
+	return _wli::str_priv::format_raw(N - 1, strFormat,
+		std::forward<const argsT&>(args)...);
+}
+
+// Type-safe sprintf into a caller-supplied reused buffer: a buffer warm from a
+// previous call is formatted in a single pass, with no allocation and no probe
+// scan, which matters in paint handlers and cell producers called per frame.
+template<typename ...argsT>
+inline std::wstring& format_to(std::wstring& dest, const wchar_t* strFormat, const argsT&... args) {
+	_wli::str_priv::format_raw_to(dest, strFormat,
+		std::forward<const argsT&>(args)...);
+	return dest;
+}
+
+// Type-safe sprintf into a caller-supplied reused buffer.
+template<typename ...argsT>
+inline std::wstring& format_to(std::wstring& dest, const std::wstring& strFormat, const argsT&... args) {
+	_wli::str_priv::format_raw_to(dest, strFormat.c_str(),
+		std::forward<const argsT&>(args)...);
+	return dest;
+}
+
 // Compares two strings, case insensitive.
 inline bool eqi(const std::wstring& s, const wchar_t* what) noexcept {
 	return !lstrcmpiW(s.c_str(), what); // str::eq() would be just operator==(), that's why there's no str::eq()
@@ -120,6 +148,44 @@ inline bool begins_withi(const std::wstring& s, const wchar_t* what) noexcept {
 	return !_wcsnicmp(s.c_str(), what, whatLen);
 }
 
+// Compares two slices, case sensitive, no null termination required.
+inline bool eq(wstr_view a, wstr_view b) noexcept {
+	// Complements operator==() on wstring: views over unterminated slices have
+	// no cheap operator== against each other through the overloads above.
+	return a == b;
+}
+
+// Compares two slices, case insensitive, no null termination required.
+inline bool eqi(wstr_view a, wstr_view b) noexcept {
+	// CompareStringOrdinal takes explicit lengths, so neither side is copied.
+	return CompareStringOrdinal(a.data(), static_cast<int>(a.length()),
+		b.data(), static_cast<int>(b.length()), TRUE) == CSTR_EQUAL;
+}
+
+// Checks, case sensitive, if the slice begins with the given text.
+inline bool begins_with(wstr_view s, wstr_view what) noexcept {
+	return !what.empty() && what.length() <= s.length() &&
+		!wmemcmp(s.data(), what.data(), what.length());
+}
+
+// Checks, case insensitive, if the slice begins with the given text.
+inline bool begins_withi(wstr_view s, wstr_view what) noexcept {
+	return !what.empty() && what.length() <= s.length() &&
+		eqi(s.substr(0, what.length()), what);
+}
+
+// Checks, case sensitive, if the slice ends with the given text.
+inline bool ends_with(wstr_view s, wstr_view what) noexcept {
+	return !what.empty() && what.length() <= s.length() &&
+		!wmemcmp(s.data() + s.length() - what.length(), what.data(), what.length());
+}
+
+// Checks, case insensitive, if the slice ends with the given text.
+inline bool ends_withi(wstr_view s, wstr_view what) noexcept {
+	return !what.empty() && what.length() <= s.length() &&
+		eqi(s.substr(s.length() - what.length()), what);
+}
+
 // Returns a new string converted to uppercase.
 inline std::wstring upper(const std::wstring& s) {
 	std::wstring ret = s;
@@ -328,8 +394,13 @@ inline encoding_info get_encoding(const BYTE* data, size_t sz) noexcept {
 	if (match(bocu1, 3)) return {encoding::BOCU1, 3};
 
 	// No BOM found, guess UTF-8 without BOM, or Windows-1252 (superset of ISO-8859-1).
+	// The pure-ASCII prefix — usually the whole buffer — is skipped in one
+	// vectorized sweep; the byte heuristics below only run past it.
+	size_t iFirstHigh = _wli::str_priv::find_non_ascii(data, sz);
+	if (iFirstHigh == sz) return {encoding::ASCII, 0};
+
 	bool canBeWin1252 = false;
-	for (size_t i = 0; i < sz; ++i) {
+	for (size_t i = iFirstHigh; i < sz; ++i) {
 		if (data[i] > 0x7F) { // 127
 			canBeWin1252 = true;
 			if (i <= sz - 2 && (
@@ -423,6 +494,150 @@ inline std::wstring to_wstring(const std::vector<BYTE>& data) {
 	return to_wstring(&data[0], data.size());
 }
 
+// Conversion to wstring, into a caller-provided buffer: the capacity of dest is
+// reused across calls, so polling code that decodes repeatedly doesn't generate
+// steady-state allocations. Returns dest.
+inline std::wstring& to_wstring_to(std::wstring& dest, const BYTE* data, size_t sz) {
+	dest.clear();
+	if (!data || !sz) return dest;
+
+	encoding_info fileEnc = get_encoding(data, sz);
+	data += fileEnc.bomSize; // skip BOM, if any
+	sz -= fileEnc.bomSize;
+
+	switch (fileEnc.encType) {
+	case encoding::UNKNOWN:
+	case encoding::ASCII:   _wli::str_priv::parse_ascii_to(dest, data, sz); return dest;
+	case encoding::WIN1252: _wli::str_priv::parse_encoded_to(dest, data, sz, 1252); return dest;
+	case encoding::UTF8:    _wli::str_priv::parse_encoded_to(dest, data, sz, CP_UTF8); return dest;
+	case encoding::UTF16BE: throw std::invalid_argument("UTF-16 big endian: encoding not implemented.");
+	case encoding::UTF16LE: throw std::invalid_argument("UTF-16 little endian: encoding not implemented.");
+	case encoding::UTF32BE: throw std::invalid_argument("UTF-32 big endian: encoding not implemented.");
+	case encoding::UTF32LE: throw std::invalid_argument("UTF-32 little endian: encoding not implemented.");
+	case encoding::SCSU:    throw std::invalid_argument("Standard compression scheme for Unicode: encoding not implemented.");
+	case encoding::BOCU1:   throw std::invalid_argument("Binary ordered compression for Unicode: encoding not implemented.");
+	default:                throw std::invalid_argument("Unknown encoding.");
+	}
+}
+
+// Conversion to wstring, into a caller-provided buffer whose capacity is reused
+// across calls. Returns dest.
+inline std::wstring& to_wstring_to(std::wstring& dest, const std::vector<BYTE>& data) {
+	return to_wstring_to(dest, &data[0], data.size());
+}
+
+// Streaming byte-to-wstring transcoder. The encoding is detected once, on the
+// first chunk, and conversion writes straight into the destination string with
+// no length-probe pass; the internal buffer of convert() grows but is reused
+// across calls. A UTF-8 sequence split across two chunks is carried over and
+// completed with the next chunk, so chunk boundaries are invisible.
+class transcoder final {
+private:
+	encoding _encType = encoding::UNKNOWN;
+	bool     _encDetected = false;
+	BYTE     _carry[4]{};    // incomplete UTF-8 sequence held from the last chunk
+	size_t   _carryLen = 0;
+	std::wstring _buf; // grow-only, reused across convert() calls
+
+public:
+	// Resets detection; the next chunk is treated as the start of a new stream.
+	transcoder& reset() noexcept {
+		this->_encDetected = false;
+		this->_carryLen = 0;
+		return *this;
+	}
+
+	// Converts the chunk, appending the result to the given wstring.
+	void append_to(std::wstring& dest, const BYTE* data, size_t sz) {
+		if (!data || !sz) return;
+
+		if (!this->_encDetected) { // 1st chunk of the stream
+			encoding_info chunkEnc = get_encoding(data, sz);
+			this->_encType = chunkEnc.encType;
+			data += chunkEnc.bomSize; // skip BOM, if any
+			sz -= chunkEnc.bomSize;
+			this->_encDetected = true;
+		}
+
+		switch (this->_encType) {
+		case encoding::UNKNOWN:
+		case encoding::ASCII: {
+			size_t base = dest.size();
+			dest.resize(base + sz);
+			for (size_t i = 0; i < sz; ++i) {
+				dest[base + i] = static_cast<wchar_t>(data[i]); // raw conversion
+			}
+			break;
+		}
+		case encoding::WIN1252:
+			this->_convert_append(dest, data, sz, 1252);
+			break;
+		case encoding::UTF8: {
+			if (this->_carryLen) { // complete the sequence held from the last chunk
+				size_t seqLen = this->_utf8_seq_len(this->_carry[0]);
+				while (this->_carryLen < seqLen && sz) {
+					this->_carry[this->_carryLen++] = *data++;
+					--sz;
+				}
+				if (this->_carryLen == seqLen) {
+					this->_convert_append(dest, this->_carry, seqLen, CP_UTF8);
+					this->_carryLen = 0;
+				}
+			}
+
+			size_t tailLen = this->_utf8_incomplete_tail(data, sz); // hold incomplete tail back
+			this->_convert_append(dest, data, sz - tailLen, CP_UTF8);
+			memcpy(this->_carry, data + sz - tailLen, tailLen);
+			this->_carryLen = tailLen;
+			break;
+		}
+		default:
+			throw std::invalid_argument("Encoding not implemented for streaming.");
+		}
+	}
+
+	// Converts the chunk into the internal reused buffer, returning a reference
+	// valid until the next call.
+	const std::wstring& convert(const BYTE* data, size_t sz) {
+		this->_buf.clear(); // capacity is kept
+		this->append_to(this->_buf, data, sz);
+		return this->_buf;
+	}
+
+private:
+	// Appends the converted bytes growing dest by the worst case (one wchar_t
+	// per byte) and shrinking to what was written: one pass, no length probe.
+	void _convert_append(std::wstring& dest, const BYTE* data, size_t sz, UINT codePage) {
+		if (!sz) return;
+		size_t base = dest.size();
+		dest.resize(base + sz);
+		int written = MultiByteToWideChar(codePage, 0,
+			reinterpret_cast<const char*>(data), static_cast<int>(sz),
+			&dest[base], static_cast<int>(sz));
+		dest.resize(base + written);
+	}
+
+	static size_t _utf8_seq_len(BYTE leadByte) noexcept {
+		if ((leadByte & 0xE0) == 0xC0) return 2;
+		if ((leadByte & 0xF0) == 0xE0) return 3;
+		if ((leadByte & 0xF8) == 0xF0) return 4;
+		return 1;
+	}
+
+	// Number of bytes at the end of the chunk forming an incomplete sequence.
+	static size_t _utf8_incomplete_tail(const BYTE* data, size_t sz) noexcept {
+		size_t lookBack = sz < 3 ? sz : 3;
+		for (size_t back = 1; back <= lookBack; ++back) {
+			BYTE b = data[sz - back];
+			if ((b & 0x80) == 0) return 0; // ASCII, sequence is complete
+			if ((b & 0xC0) == 0xC0) { // lead byte of a multi-byte sequence
+				return _utf8_seq_len(b) > back ? back : 0;
+			}
+		}
+		return 0; // continuation bytes only, assume complete
+	}
+};
+
 // Conversion to wstring.
 inline std::wstring to_wstring(const char* s) {
 	return _wli::str_priv::parse_ascii(reinterpret_cast<const BYTE*>(s), lstrlenA(s));
@@ -433,50 +648,161 @@ inline std::wstring to_wstring(const std::string& s) {
 	return to_wstring(s.c_str());
 }
 
-// Converts number to wstring, adding thousand separator.
-inline std::wstring to_wstring_with_separator(int number, wchar_t separator = L',') {
-	std::wstring ret;
-	ret.reserve(32); // arbitrary
+// Refcounted handle to an interned string: all handles to equal text share one
+// allocation in a process-wide pool, so heavily repeated UI labels (statuses,
+// categories) are stored once no matter how many cells display them. Converts
+// implicitly to const wchar_t*, so it can be passed straight to set_text and
+// the other item APIs; the pointer is stable for the handle's lifetime.
+class interned final {
+private:
+	_wli::str_priv::intern_pool::entry* _pEntry = nullptr;
+
+	explicit interned(_wli::str_priv::intern_pool::entry* pEntry) noexcept :
+		_pEntry{pEntry} { }
+
+	friend interned intern(const wchar_t*);
 
-	int abso = abs(number);
-	BYTE blocks = 0;
-	while (abso >= 1000) {
-		abso = (abso - (abso % 1000)) / 1000;
-		++blocks;
+public:
+	~interned() {
+		if (this->_pEntry) {
+			_wli::str_priv::intern_pool::instance().release(this->_pEntry);
+		}
 	}
 
-	abso = abs(number);
-	bool firstPass = true;
-	do {
-		int num = abso % 1000;
-		wchar_t buf[8]{};
+	interned() = default;
 
-		if (blocks) {
-			if (num < 100) lstrcatW(buf, L"0");
-			if (num < 10) lstrcatW(buf, L"0");
+	interned(const interned& other) noexcept : _pEntry{other._pEntry} {
+		if (this->_pEntry) {
+			_wli::str_priv::intern_pool::instance().add_ref(this->_pEntry);
 		}
+	}
 
-#pragma warning (disable: 4996)
-		_itow(num, buf + lstrlenW(buf), 10);
-#pragma warning (default: 4996)
+	interned(interned&& other) noexcept : _pEntry{other._pEntry} {
+		other._pEntry = nullptr;
+	}
 
-		if (firstPass) {
-			firstPass = false;
-		} else {
-			ret.insert(0, 1, separator);
+	interned& operator=(const interned& other) noexcept {
+		interned tmp{other}; // add_ref first, self-assignment-safe
+		std::swap(this->_pEntry, tmp._pEntry);
+		return *this;
+	}
+
+	interned& operator=(interned&& other) noexcept {
+		std::swap(this->_pEntry, other._pEntry);
+		return *this;
+	}
+
+	const wchar_t* c_str() const noexcept {
+		return this->_pEntry ? this->_pEntry->first.c_str() : L"";
+	}
+
+	size_t length() const noexcept {
+		return this->_pEntry ? this->_pEntry->first.length() : 0;
+	}
+
+	bool empty() const noexcept {
+		return !this->_pEntry || this->_pEntry->first.empty();
+	}
+
+	operator const wchar_t*() const noexcept {
+		return this->c_str();
+	}
+
+	// Equal text means equal entry, so comparison is one pointer compare.
+	bool operator==(const interned& other) const noexcept { return this->_pEntry == other._pEntry; }
+	bool operator!=(const interned& other) const noexcept { return this->_pEntry != other._pEntry; }
+};
+
+// Interns the string into the process-wide pool: one hash lookup, one shared
+// allocation per distinct text. Keep the returned handle alive as long as the
+// pointer is in use.
+inline interned intern(const wchar_t* s) {
+	return interned{_wli::str_priv::intern_pool::instance().acquire(s)};
+}
+
+inline interned intern(const std::wstring& s) {
+	return intern(s.c_str());
+}
+
+// A formatted number sitting inside a caller-owned fixed buffer; p points into
+// that buffer and is null-terminated, len excludes the terminator.
+struct num_span final {
+	const wchar_t* p = nullptr;
+	size_t         len = 0;
+};
+
+// Formats the integer into the fixed caller buffer, inserting the thousand
+// separator in a single backward pass; no heap allocation happens. Returns a
+// span into the buffer — the digits end at its back, so p doesn't start at
+// buf. Pass 0 as separator to skip grouping. The buffer must hold at least 28
+// characters (worst 64-bit value, separators, sign, terminating null).
+inline num_span format_int_to(wchar_t* buf, size_t bufLen, long long number,
+	wchar_t separator = L',') noexcept
+{
+	if (bufLen < 28) return {};
+
+	bool isNeg = number < 0;
+	unsigned long long abso = isNeg ?
+		~static_cast<unsigned long long>(number) + 1 : // two's complement, LLONG_MIN-safe
+		static_cast<unsigned long long>(number);
+
+	wchar_t* pEnd = buf + bufLen - 1;
+	*pEnd = L'\0';
+	wchar_t* p = pEnd;
+	int digitsOut = 0;
+	do {
+		if (separator && digitsOut && !(digitsOut % 3)) {
+			*--p = separator;
 		}
+		*--p = static_cast<wchar_t>(L'0' + (abso % 10));
+		abso /= 10;
+		++digitsOut;
+	} while (abso);
+	if (isNeg) *--p = L'-';
 
-		ret.insert(0, buf);
-		abso = (abso - (abso % 1000)) / 1000;
-	} while (blocks--);
+	return {p, static_cast<size_t>(pEnd - p)};
+}
 
-	if (number < 0) ret.insert(0, 1, L'-'); // prepend minus signal
-	return ret;
+template<size_t N>
+inline num_span format_int_to(wchar_t (&buf)[N], long long number,
+	wchar_t separator = L',') noexcept
+{
+	static_assert(N >= 28, "Buffer too small for a 64-bit number with separators.");
+	return format_int_to(buf, N, number, separator);
+}
+
+// Formats the floating-point value into the fixed caller buffer with the given
+// number of decimals; no heap allocation happens. Returns a span into the buffer.
+inline num_span format_double_to(wchar_t* buf, size_t bufLen, double value,
+	int numDecimals = 2) noexcept
+{
+	int written = swprintf(buf, bufLen, L"%.*f", numDecimals, value);
+	return {buf, written > 0 ? static_cast<size_t>(written) : 0};
+}
+
+template<size_t N>
+inline num_span format_double_to(wchar_t (&buf)[N], double value,
+	int numDecimals = 2) noexcept
+{
+	static_assert(N >= 32, "Buffer too small for a formatted double.");
+	return format_double_to(buf, N, value, numDecimals);
+}
+
+// Converts number to wstring, adding thousand separator.
+inline std::wstring to_wstring_with_separator(long long number, wchar_t separator = L',') {
+	wchar_t buf[32];
+	num_span sp = format_int_to(buf, number, separator); // the only allocation is the result itself
+	return {sp.p, sp.len};
+}
+
+// Converts number to wstring, adding thousand separator.
+inline std::wstring to_wstring_with_separator(int number, wchar_t separator = L',') {
+	return to_wstring_with_separator(static_cast<long long>(number), separator);
 }
 
 // Converts number to wstring, adding thousand separator.
 inline std::wstring to_wstring_with_separator(size_t number, wchar_t separator = L',') {
-	return to_wstring_with_separator(static_cast<int>(number), separator);
+	return to_wstring_with_separator(static_cast<long long>(number), separator);
 }
 
 // Splits the string at the given characters, the characters themselves will be removed.
@@ -489,14 +815,20 @@ inline std::vector<std::wstring> split(const std::wstring& s, const wchar_t* del
 		return ret;
 	}
 
+	size_t delimiterLen = lstrlenW(delimiter);
 	size_t base = 0, head = 0;
 
 	for (;;) {
-		head = s.find(delimiter, head);
+		head = _wli::str_priv::find_char(s.c_str(), s.length(), head, delimiter[0]); // vectorized
+		while (head != std::wstring::npos && delimiterLen > 1 &&
+			s.compare(head, delimiterLen, delimiter) != 0) // 1st char matched, rest didn't
+		{
+			head = _wli::str_priv::find_char(s.c_str(), s.length(), head + 1, delimiter[0]);
+		}
 		if (head == std::wstring::npos) break;
 		ret.emplace_back();
 		ret.back().insert(0, s, base, head - base);
-		head += lstrlenW(delimiter);
+		head += delimiterLen;
 		base = head;
 	}
 
@@ -515,6 +847,55 @@ inline std::vector<std::wstring> split_lines(const std::wstring& s) {
 	return split(s, get_linebreak(s));
 }
 
+// An offset/length token span over an external string buffer.
+struct span final {
+	size_t offset = 0;
+	size_t length = 0;
+};
+
+// Splits the string at the given characters into offset/length spans over the
+// original buffer: no string is allocated per token, so huge buffers can be
+// tokenized at memory-bandwidth speed.
+inline std::vector<span> split_spans(const std::wstring& s, const wchar_t* delimiter) {
+	std::vector<span> ret;
+	if (s.empty()) return ret;
+
+	if (!delimiter || !delimiter[0]) {
+		ret.push_back({0, s.length()}); // one single token
+		return ret;
+	}
+
+	size_t delimiterLen = lstrlenW(delimiter);
+	size_t base = 0, head = 0;
+
+	for (;;) {
+		head = _wli::str_priv::find_char(s.c_str(), s.length(), head, delimiter[0]); // vectorized
+		while (head != std::wstring::npos && delimiterLen > 1 &&
+			s.compare(head, delimiterLen, delimiter) != 0) // 1st char matched, rest didn't
+		{
+			head = _wli::str_priv::find_char(s.c_str(), s.length(), head + 1, delimiter[0]);
+		}
+		if (head == std::wstring::npos) break;
+		ret.push_back({base, head - base});
+		head += delimiterLen;
+		base = head;
+	}
+
+	ret.push_back({base, s.length() - base});
+	return ret;
+}
+
+// Splits the string at the given characters into offset/length spans over the
+// original buffer, allocating no string per token.
+inline std::vector<span> split_spans(const std::wstring& s, const std::wstring& delimiter) {
+	return split_spans(s, delimiter.c_str());
+}
+
+// Splits a string line by line into offset/length spans over the original buffer.
+inline std::vector<span> split_lines_spans(const std::wstring& s) {
+	return split_spans(s, get_linebreak(s));
+}
+
 // Splits a zero-delimited multi-string.
 inline std::vector<std::wstring> split_multi_zero(const wchar_t* s) {
 	// Example multi-zero string:
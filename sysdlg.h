@@ -13,6 +13,7 @@
 #include "wnd.h"
 #include <Shlobj.h>
 #include "internals/sysdlg_priv.h"
+#include "internals/ui_marshal.h"
 
 namespace wl {
 
@@ -204,5 +205,150 @@ inline bool choose_folder(const wnd* parent, std::wstring& buf) {
 	return choose_folder(parent->hwnd(), buf);
 }
 
+
+// The async variants below run the modal dialog on a dedicated thread, so the
+// calling window's pump keeps servicing paint and the other windows while the
+// shell enumerates — no more multi-second stalls on slow network shares. The
+// callback runs back on the parent window's own thread, riding the same
+// channel as run_thread_ui, which means the parent must be a window created
+// through the library. An exception inside the dialog is re-thrown on the
+// parent's thread, funneled into the usual error dialog.
+
+// Async open_file: callback receives (userPicked, chosenPath).
+inline void open_file_async(HWND hParent, const wchar_t* filterWithPipes,
+	std::function<void(bool, const std::wstring&)> callback)
+{
+	std::wstring filter = filterWithPipes; // the caller's buffer won't outlive the thread
+	_wli::sysdlg_priv::run_dialog_thread([hParent, filter, callback]() noexcept {
+		std::wstring chosen;
+		bool picked = false;
+		try {
+			picked = open_file(hParent, filter.c_str(), chosen);
+		} catch (...) {
+			std::exception_ptr pExc = std::current_exception();
+			_wli::ui_marshal::post(hParent, [pExc]() { std::rethrow_exception(pExc); });
+			return;
+		}
+		_wli::ui_marshal::post(hParent, [callback, picked, chosen]() {
+			callback(picked, chosen);
+		});
+	});
+}
+
+inline void open_file_async(const wnd* parent, const wchar_t* filterWithPipes,
+	std::function<void(bool, const std::wstring&)> callback)
+{
+	open_file_async(parent->hwnd(), filterWithPipes, std::move(callback));
+}
+
+// Async open_files: callback receives (userPicked, chosenPaths).
+inline void open_files_async(HWND hParent, const wchar_t* filterWithPipes,
+	std::function<void(bool, const std::vector<std::wstring>&)> callback)
+{
+	std::wstring filter = filterWithPipes;
+	_wli::sysdlg_priv::run_dialog_thread([hParent, filter, callback]() noexcept {
+		std::vector<std::wstring> chosen;
+		bool picked = false;
+		try {
+			picked = open_files(hParent, filter.c_str(), chosen);
+		} catch (...) {
+			std::exception_ptr pExc = std::current_exception();
+			_wli::ui_marshal::post(hParent, [pExc]() { std::rethrow_exception(pExc); });
+			return;
+		}
+		_wli::ui_marshal::post(hParent, [callback, picked, chosen]() {
+			callback(picked, chosen);
+		});
+	});
+}
+
+inline void open_files_async(const wnd* parent, const wchar_t* filterWithPipes,
+	std::function<void(bool, const std::vector<std::wstring>&)> callback)
+{
+	open_files_async(parent->hwnd(), filterWithPipes, std::move(callback));
+}
+
+// Async save_file: callback receives (userPicked, chosenPath).
+inline void save_file_async(HWND hParent, const wchar_t* filterWithPipes,
+	const std::wstring& defFile, std::function<void(bool, const std::wstring&)> callback)
+{
+	std::wstring filter = filterWithPipes;
+	std::wstring defFileCopy = defFile;
+	_wli::sysdlg_priv::run_dialog_thread([hParent, filter, defFileCopy, callback]() noexcept {
+		std::wstring chosen;
+		bool picked = false;
+		try {
+			picked = save_file(hParent, filter.c_str(), chosen, defFileCopy);
+		} catch (...) {
+			std::exception_ptr pExc = std::current_exception();
+			_wli::ui_marshal::post(hParent, [pExc]() { std::rethrow_exception(pExc); });
+			return;
+		}
+		_wli::ui_marshal::post(hParent, [callback, picked, chosen]() {
+			callback(picked, chosen);
+		});
+	});
+}
+
+inline void save_file_async(const wnd* parent, const wchar_t* filterWithPipes,
+	const std::wstring& defFile, std::function<void(bool, const std::wstring&)> callback)
+{
+	save_file_async(parent->hwnd(), filterWithPipes, defFile, std::move(callback));
+}
+
+// Async choose_folder: callback receives (userPicked, chosenFolder).
+inline void choose_folder_async(HWND hParent,
+	std::function<void(bool, const std::wstring&)> callback)
+{
+	_wli::sysdlg_priv::run_dialog_thread([hParent, callback]() noexcept {
+		std::wstring chosen;
+		bool picked = false;
+		try {
+			picked = choose_folder(hParent, chosen);
+		} catch (...) {
+			std::exception_ptr pExc = std::current_exception();
+			_wli::ui_marshal::post(hParent, [pExc]() { std::rethrow_exception(pExc); });
+			return;
+		}
+		_wli::ui_marshal::post(hParent, [callback, picked, chosen]() {
+			callback(picked, chosen);
+		});
+	});
+}
+
+inline void choose_folder_async(const wnd* parent,
+	std::function<void(bool, const std::wstring&)> callback)
+{
+	choose_folder_async(parent->hwnd(), std::move(callback));
+}
+
+// Async msgbox: callback receives the button the user chose (IDOK etc.).
+// The box is still centered on and owned by the parent, but the parent's
+// thread never blocks in the modal loop.
+inline void msgbox_async(HWND hParent, const std::wstring& title, const std::wstring& text,
+	UINT uType, std::function<void(int)> callback)
+{
+	std::wstring titleCopy = title, textCopy = text;
+	_wli::sysdlg_priv::run_dialog_thread([hParent, titleCopy, textCopy, uType, callback]() noexcept {
+		int chosenBtn = 0;
+		try {
+			chosenBtn = msgbox(hParent, titleCopy, textCopy, uType);
+		} catch (...) {
+			std::exception_ptr pExc = std::current_exception();
+			_wli::ui_marshal::post(hParent, [pExc]() { std::rethrow_exception(pExc); });
+			return;
+		}
+		_wli::ui_marshal::post(hParent, [callback, chosenBtn]() {
+			callback(chosenBtn);
+		});
+	});
+}
+
+inline void msgbox_async(const wnd* parent, const std::wstring& title, const std::wstring& text,
+	UINT uType, std::function<void(int)> callback)
+{
+	msgbox_async(parent->hwnd(), title, text, uType, std::move(callback));
+}
+
 }//namespace sysdlg
 }//namespace wl
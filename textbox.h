@@ -6,6 +6,8 @@
  */
 
 #pragma once
+#include <string>
+#include <vector>
 #include "internals/base_focus_pubm.h"
 #include "internals/base_text_pubm.h"
 #include "internals/base_native_ctrl_pubm.h"
@@ -13,6 +15,123 @@
 #include "wnd.h"
 
 namespace wl {
+namespace _wli {
+
+// Pending-append state behind textbox::append, keyed by the edit HWND — not by
+// the wrapper object, so textbox stays freely movable while a flush is due.
+// UI-thread only, like the control itself.
+class textbox_append_buf final {
+private:
+	static const UINT_PTR _TIMER_ID = 0x574C4150;
+
+	struct _state final {
+		HWND         hEdit = nullptr;
+		std::wstring buf;            // grow-only, reused across flushes
+		size_t       maxChars = 0;   // ring cap; 0 = unlimited
+		UINT         intervalMs = 50;
+		bool         timerSet = false;
+	};
+
+	std::vector<_state> _states;
+
+	textbox_append_buf() = default;
+
+public:
+	textbox_append_buf(const textbox_append_buf&) = delete;
+	textbox_append_buf& operator=(const textbox_append_buf&) = delete;
+
+	static textbox_append_buf& instance() {
+		static textbox_append_buf obj; // thread-safe in C++11
+		return obj;
+	}
+
+	void append(HWND hEdit, const wchar_t* t) {
+		_state& st = this->_state_of(hEdit);
+		st.buf.append(t);
+		if (!st.timerSet) { // one flush per coalescing window, however many appends
+			st.timerSet = true;
+			SetTimer(hEdit, _TIMER_ID, st.intervalMs, _timer_proc);
+		}
+	}
+
+	void set_cap(HWND hEdit, size_t maxChars) {
+		this->_state_of(hEdit).maxChars = maxChars;
+	}
+
+	void set_interval(HWND hEdit, UINT ms) {
+		this->_state_of(hEdit).intervalMs = ms ? ms : USER_TIMER_MINIMUM;
+	}
+
+	void flush(HWND hEdit) {
+		_state* pSt = this->_find(hEdit);
+		if (!pSt) return;
+		if (pSt->timerSet) {
+			KillTimer(hEdit, _TIMER_ID);
+			pSt->timerSet = false;
+		}
+		if (pSt->buf.empty()) return;
+
+		if (!IsWindow(hEdit)) { // the control died with appends pending
+			this->_states.erase(this->_states.begin() + (pSt - &this->_states[0]));
+			return;
+		}
+
+		SendMessageW(hEdit, WM_SETREDRAW, FALSE, 0); // no repaint per step below
+		size_t curLen = static_cast<size_t>(GetWindowTextLengthW(hEdit));
+
+		if (pSt->maxChars && curLen + pSt->buf.length() > pSt->maxChars) {
+			if (pSt->buf.length() >= pSt->maxChars) { // the batch alone overflows
+				SetWindowTextW(hEdit, L"");
+				curLen = 0;
+				size_t cut = pSt->buf.length() - pSt->maxChars;
+				size_t nl = pSt->buf.find(L'\n', cut); // keep whole lines only
+				pSt->buf.erase(0, nl == std::wstring::npos ? cut : nl + 1);
+			} else {
+				// Trim the oldest lines in one bulk range delete.
+				size_t excess = curLen + pSt->buf.length() - pSt->maxChars;
+				size_t iLine = static_cast<size_t>(
+					SendMessageW(hEdit, EM_LINEFROMCHAR, excess, 0));
+				LRESULT cut = SendMessageW(hEdit, EM_LINEINDEX, iLine + 1, 0);
+				if (cut < 0) cut = static_cast<LRESULT>(excess); // last line, cut mid-line
+				SendMessageW(hEdit, EM_SETSEL, 0, cut);
+				SendMessageW(hEdit, EM_REPLACESEL, FALSE,
+					reinterpret_cast<LPARAM>(L""));
+				curLen -= static_cast<size_t>(cut);
+			}
+		}
+
+		SendMessageW(hEdit, EM_SETSEL, curLen, curLen); // append point
+		SendMessageW(hEdit, EM_REPLACESEL, FALSE, // no undo buffer growth
+			reinterpret_cast<LPARAM>(pSt->buf.c_str()));
+		pSt->buf.clear();
+
+		SendMessageW(hEdit, WM_SETREDRAW, TRUE, 0);
+		SendMessageW(hEdit, EM_SCROLLCARET, 0, 0); // one scroll per batch
+		InvalidateRect(hEdit, nullptr, FALSE);
+	}
+
+private:
+	_state* _find(HWND hEdit) noexcept {
+		for (_state& st : this->_states) {
+			if (st.hEdit == hEdit) return &st;
+		}
+		return nullptr;
+	}
+
+	_state& _state_of(HWND hEdit) {
+		_state* pSt = this->_find(hEdit);
+		if (pSt) return *pSt;
+		this->_states.push_back({});
+		this->_states.back().hEdit = hEdit;
+		return this->_states.back();
+	}
+
+	static void CALLBACK _timer_proc(HWND hEdit, UINT, UINT_PTR, DWORD) noexcept {
+		instance().flush(hEdit); // also kills the timer
+	}
+};
+
+}//namespace _wli
 
 // Wrapper to native edit box control.
 class textbox final :
@@ -101,6 +220,40 @@ public:
 	textbox& replace_selected(const std::wstring& t) noexcept {
 		return this->replace_selected(t.c_str());
 	}
+
+	// High-throughput append for log panes: the text lands in a per-control
+	// buffer and reaches the edit as a single EM_REPLACESEL per coalescing
+	// interval, with redraw and scrolling suppressed until the flush — cost per
+	// append stays constant however big the content grows. Include your own
+	// line breaks.
+	textbox& append(const wchar_t* t) {
+		_wli::textbox_append_buf::instance().append(this->_hWnd, t);
+		return *this;
+	}
+
+	textbox& append(const std::wstring& t) {
+		return this->append(t.c_str());
+	}
+
+	// Caps the total content at roughly the given character count: when a batch
+	// flush would exceed it, the oldest lines are deleted in one bulk EM_SETSEL
+	// range delete. Zero, the default, means unlimited.
+	textbox& set_append_cap(size_t maxChars) {
+		_wli::textbox_append_buf::instance().set_cap(this->_hWnd, maxChars);
+		return *this;
+	}
+
+	// Sets the append coalescing interval; 50ms if never called.
+	textbox& set_append_interval(UINT ms) {
+		_wli::textbox_append_buf::instance().set_interval(this->_hWnd, ms);
+		return *this;
+	}
+
+	// Pushes any pending appended text to the control right away.
+	textbox& flush_appends() {
+		_wli::textbox_append_buf::instance().flush(this->_hWnd);
+		return *this;
+	}
 };
 
 }//namespace wl
@@ -6,11 +6,13 @@
  */
 
 #pragma once
+#include <functional>
 #include "internals/base_focus_pubm.h"
 #include "internals/base_native_ctrl_pubm.h"
 #include "internals/member_image_list.h"
 #include "internals/treeview_item_collection.h"
 #include "internals/treeview_styler.h"
+#include "subclass.h"
 #include "wnd.h"
 
 namespace wl {
@@ -28,6 +30,8 @@ public:
 private:
 	HWND                   _hWnd = nullptr;
 	_wli::base_native_ctrl _baseNativeCtrl{_hWnd};
+	subclass               _parentSubclass; // installed on demand, routes TVN_ITEMEXPANDING
+	std::function<void(_wli::treeview_item)> _onPopulate;
 
 public:
 	// Wraps window style changes done by Get/SetWindowLongPtr.
@@ -57,6 +61,96 @@ public:
 	treeview& create(const wnd* parent, int ctrlId, POINT pos, SIZE size) {
 		return this->create(parent->hwnd(), ctrlId, pos, size);
 	}
+
+	// One node of a build_batch array: parentIdx refers to an earlier entry of
+	// the same array, or -1 for a root node.
+	struct batch_node final {
+		const wchar_t* text = nullptr;
+		size_t         parentIdx = -1; // index of parent within the array; -1 = root
+		int            iconIdx = -1;   // imagelist index; -1 = no icon
+	};
+
+	// Enables or disables redrawing, wrapper to WM_SETREDRAW; disable around
+	// bulk insertions so the control doesn't repaint per item.
+	treeview& set_redraw(bool doRedraw) noexcept {
+		SendMessageW(this->_hWnd, WM_SETREDRAW,
+			static_cast<WPARAM>(static_cast<BOOL>(doRedraw)), 0);
+		return *this;
+	}
+
+	// Inserts a whole flat, parent-indexed node array in one pass: redraw is
+	// suspended for the duration, one TVINSERTSTRUCT is reused across all
+	// TVM_INSERTITEMs, and a single invalidation happens at the end — an 80k
+	// node tree loads without a repaint per item. Parents must come before
+	// their children in the array.
+	treeview& build_batch(const batch_node* nodes, size_t count) {
+		this->set_redraw(false);
+		std::vector<HTREEITEM> created(count, nullptr);
+
+		TVINSERTSTRUCTW tvi{}; // reused across the whole pass
+		tvi.hInsertAfter = TVI_LAST;
+
+		for (size_t i = 0; i < count; ++i) {
+			if (nodes[i].parentIdx != static_cast<size_t>(-1) && nodes[i].parentIdx >= i) {
+				this->set_redraw(true);
+				throw std::invalid_argument("Batch node refers to a parent at or after itself.");
+			}
+			tvi.hParent = nodes[i].parentIdx == static_cast<size_t>(-1) ?
+				TVI_ROOT : created[nodes[i].parentIdx];
+			tvi.itemex.mask = TVIF_TEXT |
+				(nodes[i].iconIdx == -1 ? 0 : (TVIF_IMAGE | TVIF_SELECTEDIMAGE));
+			tvi.itemex.pszText = const_cast<wchar_t*>(nodes[i].text);
+			tvi.itemex.iImage = nodes[i].iconIdx;
+			tvi.itemex.iSelectedImage = nodes[i].iconIdx;
+			created[i] = TreeView_InsertItem(this->_hWnd, &tvi);
+		}
+
+		this->set_redraw(true);
+		InvalidateRect(this->_hWnd, nullptr, TRUE); // one repaint for the whole batch
+		return *this;
+	}
+
+	treeview& build_batch(const std::vector<batch_node>& nodes) {
+		return this->build_batch(nodes.empty() ? nullptr : &nodes[0], nodes.size());
+	}
+
+	// Assigns a lambda to supply the children of a node on its first expansion.
+	// Insert only the roots upfront, flag the ones with children through
+	// item::set_has_children, and the lambda fills each node when the user
+	// actually opens it, so huge trees cost only what is being looked at.
+	treeview& on_populate(std::function<void(item node)> callback) {
+		if (!this->_hWnd) {
+			throw std::logic_error("Can't set on_populate before the treeview is created.");
+		}
+		this->_onPopulate = std::move(callback);
+		if (!this->_parentSubclass.hwnd()) {
+			this->_install_parent_subclass();
+		}
+		return *this;
+	}
+
+private:
+	// Expansion notifications go to the parent window, so it's the parent we
+	// subclass to serve TVN_ITEMEXPANDING without any user-side wiring.
+	void _install_parent_subclass() {
+		UINT_PTR ctrlId = this->ctrl_id();
+
+		this->_parentSubclass.on_notify(ctrlId, TVN_ITEMEXPANDINGW, [this](params p) -> LRESULT {
+			NMTREEVIEWW* nmtv = reinterpret_cast<NMTREEVIEWW*>(p.lParam);
+			if (nmtv->action == TVE_EXPAND && this->_onPopulate) {
+				item node{nmtv->itemNew.hItem, this->_hWnd};
+				if (!node.get_first_child().htreeitem()) { // not populated yet
+					this->_onPopulate(node);
+					if (!node.get_first_child().htreeitem()) {
+						node.set_has_children(false); // nothing came, drop the glyph
+					}
+				}
+			}
+			return FALSE; // allow the expansion
+		});
+
+		this->_parentSubclass.install_subclass(GetAncestor(this->_hWnd, GA_PARENT));
+	}
 };
 
 }//namespace _wli
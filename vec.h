@@ -7,9 +7,66 @@
 
 #pragma once
 #include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <vector>
+#include "internals/thread_pool.h"
 
 namespace wl {
+namespace _wli {
+
+// Splits [0, totalCount) into one contiguous chunk per worker, runs the chunks
+// on the shared thread pool and blocks until all finish. The first exception
+// thrown by any chunk is captured and rethrown in the calling thread, so
+// errors surface exactly where the sequential algorithm would have thrown —
+// and keep flowing to the same outer handlers (ultimately lippincott).
+template<typename workT>
+inline void parallel_chunks(size_t totalCount, size_t numWorkers, workT&& work,
+	size_t inlineThreshold = 2048)
+{
+	if (!numWorkers) {
+		numWorkers = std::thread::hardware_concurrency();
+		if (!numWorkers) numWorkers = 2;
+	}
+	if (totalCount < inlineThreshold || numWorkers == 1) { // not worth the dispatch overhead
+		work(static_cast<size_t>(0), totalCount);
+		return;
+	}
+
+	struct _state final {
+		std::mutex              mtx;
+		std::condition_variable cv;
+		size_t                  pending = 0;
+		std::exception_ptr      firstError;
+	} state;
+
+	size_t chunkSz = (totalCount + numWorkers - 1) / numWorkers;
+	for (size_t chunkFirst = 0; chunkFirst < totalCount; chunkFirst += chunkSz) {
+		size_t chunkPastLast = (std::min)(chunkFirst + chunkSz, totalCount);
+		{
+			std::lock_guard<std::mutex> lock(state.mtx);
+			++state.pending;
+		}
+		thread_pool::instance().submit([&, chunkFirst, chunkPastLast]() noexcept {
+			try {
+				work(chunkFirst, chunkPastLast);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(state.mtx);
+				if (!state.firstError) state.firstError = std::current_exception();
+			}
+			std::lock_guard<std::mutex> lock(state.mtx);
+			--state.pending;
+			state.cv.notify_one();
+		});
+	}
+
+	std::unique_lock<std::mutex> lock(state.mtx);
+	state.cv.wait(lock, [&]() noexcept -> bool { return state.pending == 0; });
+	if (state.firstError) std::rethrow_exception(state.firstError);
+}
+
+}//namespace _wli
 
 // Utilities to std::vector.
 namespace vec {
@@ -98,5 +155,88 @@ inline void remove_if(std::vector<T>& v, predicateT&& func) {
 	);
 }
 
+// Parallel for_each: elements are processed in contiguous chunks across the
+// shared thread pool. The lambda must be safe to run concurrently on distinct
+// elements; numWorkers 0 means one chunk per hardware thread. Blocks until all
+// elements are done; the first exception of any chunk is rethrown here.
+template<typename T, typename predicateT>
+inline void for_each_par(std::vector<T>& v, predicateT&& func, size_t numWorkers = 0) {
+	_wli::parallel_chunks(v.size(), numWorkers,
+		[&](size_t chunkFirst, size_t chunkPastLast) {
+			for (size_t i = chunkFirst; i < chunkPastLast; ++i) {
+				func(v[i]);
+			}
+		});
+}
+
+// Parallel for_each over a const vector.
+template<typename T, typename predicateT>
+inline void for_each_par(const std::vector<T>& v, predicateT&& func, size_t numWorkers = 0) {
+	_wli::parallel_chunks(v.size(), numWorkers,
+		[&](size_t chunkFirst, size_t chunkPastLast) {
+			for (size_t i = chunkFirst; i < chunkPastLast; ++i) {
+				func(v[i]);
+			}
+		});
+}
+
+// Parallel transform: out is resized to the size of in, and each out[i]
+// receives func(in[i]); chunks run across the shared thread pool, and writes
+// never overlap since every index belongs to exactly one chunk.
+template<typename T, typename U, typename funcT>
+inline void transform_par(const std::vector<T>& in, std::vector<U>& out,
+	funcT&& func, size_t numWorkers = 0)
+{
+	out.resize(in.size());
+	_wli::parallel_chunks(in.size(), numWorkers,
+		[&](size_t chunkFirst, size_t chunkPastLast) {
+			for (size_t i = chunkFirst; i < chunkPastLast; ++i) {
+				out[i] = func(in[i]);
+			}
+		});
+}
+
+// Parallel sort: each chunk is sorted on its own worker, then neighboring
+// sorted runs are merged in rounds, also in parallel, until one run remains.
+template<typename T, typename compareT>
+inline void sort_par(std::vector<T>& v, compareT&& comp, size_t numWorkers = 0) {
+	if (!numWorkers) {
+		numWorkers = std::thread::hardware_concurrency();
+		if (!numWorkers) numWorkers = 2;
+	}
+	if (v.size() < 2048 || numWorkers == 1) {
+		std::sort(v.begin(), v.end(), comp);
+		return;
+	}
+
+	size_t chunkSz = (v.size() + numWorkers - 1) / numWorkers;
+	_wli::parallel_chunks(v.size(), numWorkers,
+		[&](size_t chunkFirst, size_t chunkPastLast) {
+			std::sort(v.begin() + chunkFirst, v.begin() + chunkPastLast, comp);
+		});
+
+	for (size_t width = chunkSz; width < v.size(); width *= 2) {
+		size_t numPairs = (v.size() + 2 * width - 1) / (2 * width);
+		_wli::parallel_chunks(numPairs, numPairs, // merges of a round are independent
+			[&](size_t pairFirst, size_t pairPastLast) { // one pair per worker, see threshold below
+				for (size_t pair = pairFirst; pair < pairPastLast; ++pair) {
+					size_t lo = pair * 2 * width;
+					size_t mid = (std::min)(lo + width, v.size());
+					size_t hi = (std::min)(lo + 2 * width, v.size());
+					if (mid < hi) {
+						std::inplace_merge(v.begin() + lo, v.begin() + mid,
+							v.begin() + hi, comp);
+					}
+				}
+			}, 2); // always fan out: each merge is big even when pairs are few
+	}
+}
+
+// Parallel sort with operator<.
+template<typename T>
+inline void sort_par(std::vector<T>& v, size_t numWorkers = 0) {
+	sort_par(v, [](const T& a, const T& b) -> bool { return a < b; }, numWorkers);
+}
+
 }//namespace vec
 }//namespace wl
@@ -64,6 +64,14 @@ public:
 		this->create(parent->hwnd(), ctrlId, position, size);
 	}
 
+	// Registers the Win32 class of the given control type ahead of time, seeding
+	// the process-wide atom cache; repeated instantiations then reuse the atom.
+	template<typename wndT>
+	static void pre_register_class(HINSTANCE hInst) {
+		wndT tmp; // default construction fills in setup
+		_wli::base_window::pre_register(tmp.setup, hInst);
+	}
+
 private:
 	void _init_setup_styles() noexcept {
 		this->setup.wndClassEx.hbrBackground = reinterpret_cast<HBRUSH>(COLOR_WINDOW + 1);
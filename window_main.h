@@ -14,6 +14,7 @@
 #include "internals/base_window.h"
 #include "internals/run.h"
 #include "internals/styler.h"
+#include "dpi.h"
 #include "wnd.h"
 
 namespace wl {
@@ -48,6 +49,9 @@ public:
 	// Wraps window style changes done by Get/SetWindowLongPtr.
 	_wli::styler<window_main> style{this};
 
+	// Cached monitor DPI scale of this window, refreshed only on WM_DPICHANGED.
+	dpi_context dpi;
+
 protected:
 	window_main() :
 		wnd(_hWnd), base_msg_pubm(_baseMsg), base_thread_pubm(_baseThread), base_text_pubm(_hWnd)
@@ -58,6 +62,16 @@ protected:
 			PostQuitMessage(0);
 			return 0;
 		});
+
+		this->base_msg_pubm::on_message(WM_DPICHANGED, [this](params p) noexcept -> LRESULT {
+			this->dpi.on_dpi_changed(p.wParam); // one cache refresh per monitor hop
+			const RECT* rcSuggested = reinterpret_cast<const RECT*>(p.lParam);
+			SetWindowPos(this->hwnd(), nullptr, rcSuggested->left, rcSuggested->top,
+				rcSuggested->right - rcSuggested->left,
+				rcSuggested->bottom - rcSuggested->top,
+				SWP_NOZORDER | SWP_NOACTIVATE);
+			return 0;
+		});
 	}
 
 public:
@@ -68,6 +82,7 @@ public:
 	int winmain_run(HINSTANCE hInst, int cmdShow) {
 		InitCommonControls();
 		this->_baseWindow.register_create(this->setup, nullptr, hInst);
+		this->dpi.attach(this->hwnd()); // single query; reads are cache hits from here on
 		ShowWindow(this->hwnd(), cmdShow);
 		if (!UpdateWindow(this->hwnd())) {
 			throw std::system_error(GetLastError(), std::system_category(),
@@ -77,6 +92,69 @@ public:
 		return this->_baseLoop.run_loop(this->hwnd(), this->setup.accelTable); // can be used as program return value
 	}
 
+	// Registers a lambda to run whenever the message queue goes empty; returning
+	// true keeps it registered for the next gap, false unregisters it.
+	void add_idle_callback(std::function<bool()> callback) {
+		this->_baseLoop.add_idle_callback(std::move(callback));
+	}
+
+	// Queues a one-shot task to run at low priority in a message-queue gap.
+	void post_idle_task(std::function<void()> task) {
+		this->_baseLoop.post_idle_task(std::move(task));
+	}
+
+	// Registers a per-frame lambda for animations, driven by a high-resolution
+	// waitable timer inside the pump — steadier than SetTimer, paused while the
+	// window is minimized. Receives the milliseconds since the previous frame;
+	// returning true keeps it registered, false unregisters it.
+	void on_frame(std::function<bool(double)> callback) {
+		this->_baseLoop.add_frame_callback(std::move(callback));
+	}
+
+	// Sets the animation frame period; 15ms (roughly 60Hz) if never called.
+	void set_frame_period(UINT ms) noexcept {
+		this->_baseLoop.set_frame_period(ms);
+	}
+
+	// Disables the per-message IsDialogMessage call of the main loop; only do this
+	// if your window doesn't rely on Tab/arrow navigation between child controls.
+	void set_dialog_navigation(bool enable) noexcept {
+		this->_baseLoop.set_dialog_navigation(enable);
+	}
+
+	// Registers global hotkeys dispatched straight into this window's
+	// on_command handlers: one sorted lookup in the pump, no WM_COMMAND round
+	// trip and no HACCEL rebuild when hotkeys are added later.
+	void add_accels(std::initializer_list<_wli::base_loop::accel> accels) {
+		this->_baseLoop.add_accels(nullptr, [this](WORD cmdId) -> bool {
+			return this->try_command(cmdId);
+		}, accels.begin(), accels.size());
+	}
+
+	// Registers a hotkey layer for a child window, active while it or one of
+	// its children holds the focus; it shadows the global layer on key
+	// clashes. The dispatch callback usually forwards to the child's
+	// try_command. Call remove_accels_for when the child goes away.
+	void add_accels_for(HWND hTarget, std::function<bool(WORD)> dispatch,
+		std::initializer_list<_wli::base_loop::accel> accels)
+	{
+		this->_baseLoop.add_accels(hTarget, std::move(dispatch), accels.begin(), accels.size());
+	}
+
+	// Unregisters the hotkey layers of the given child window.
+	void remove_accels_for(HWND hTarget) {
+		this->_baseLoop.remove_accels(hTarget);
+	}
+
+	// Registers the Win32 class of the given window type right away, seeding the
+	// process-wide atom cache; call at startup for the windows the app will open,
+	// so none of them pays RegisterClassEx on its first creation.
+	template<typename wndT>
+	static void pre_register_class(HINSTANCE hInst) {
+		wndT tmp; // default construction fills in setup
+		_wli::base_window::pre_register(tmp.setup, hInst);
+	}
+
 private:
 	void _init_setup_styles() noexcept {
 		this->setup.wndClassEx.hbrBackground = reinterpret_cast<HBRUSH>(COLOR_BTNFACE + 1);
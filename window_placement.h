@@ -0,0 +1,158 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include "file_mapped.h"
+#include "wnd.h"
+
+namespace wl {
+
+// Persists window positions in a small binary memory-mapped settings file,
+// with one fixed-offset slot per application-defined window id. Saving is an
+// in-place mapped write — no INI parse at startup, no serialization pass at
+// shutdown. Typical usage: open() early, restore() right after the window is
+// created, save() on WM_DESTROY.
+class window_placement final {
+private:
+	static const UINT _MAGIC = 0x50574C57; // "WLWP"
+	static const UINT _VERSION = 1;
+
+	struct _header final {
+		UINT magic = 0;
+		UINT version = 0;
+		UINT slotCount = 0;
+		UINT reserved = 0;
+	};
+
+	struct _slot final {
+		UINT            windowId = 0;
+		UINT            used = FALSE;
+		WINDOWPLACEMENT wp{};
+	};
+
+	file_mapped _fm;
+
+public:
+	window_placement() = default;
+	window_placement(window_placement&&) = default;
+	window_placement& operator=(window_placement&&) = default; // movable only
+
+	window_placement& close() noexcept {
+		this->_fm.close();
+		return *this;
+	}
+
+	// Opens or creates the settings file; a fresh or corrupted file is zeroed
+	// and formatted with the given number of slots.
+	window_placement& open(const std::wstring& filePath, size_t slotCapacity = 64) {
+		this->close();
+
+		file fCreate;
+		fCreate.open_or_create(filePath);
+		bool fresh = fCreate.size() < sizeof(_header);
+		if (fresh) {
+			fCreate.set_new_size(sizeof(_header) + slotCapacity * sizeof(_slot));
+		}
+		fCreate.close(); // file_mapped reopens it below
+
+		this->_fm.open(filePath, file::access::READWRITE);
+
+		_header* pHdr = this->_hdr();
+		if (fresh || pHdr->magic != _MAGIC || pHdr->version != _VERSION) {
+			SecureZeroMemory(this->_fm.p_mem(), this->_fm.size()); // format
+			pHdr->magic = _MAGIC;
+			pHdr->version = _VERSION;
+			pHdr->slotCount = static_cast<UINT>(
+				(this->_fm.size() - sizeof(_header)) / sizeof(_slot));
+		}
+		return *this;
+	}
+
+	// Writes the current placement of the window into its slot; O(1) in-place
+	// mapped write, intended to be called on WM_DESTROY.
+	window_placement& save(UINT windowId, HWND hWnd) {
+		this->_check_open();
+		WINDOWPLACEMENT wp{};
+		wp.length = sizeof(WINDOWPLACEMENT);
+		if (!GetWindowPlacement(hWnd, &wp)) {
+			throw std::system_error(GetLastError(), std::system_category(),
+				"GetWindowPlacement failed");
+		}
+
+		_slot* pSlot = this->_find_slot(windowId, true);
+		pSlot->windowId = windowId;
+		pSlot->wp = wp;
+		pSlot->used = TRUE; // last, so a torn write never yields a half-valid slot
+		return *this;
+	}
+
+	window_placement& save(UINT windowId, const wnd& window) {
+		return this->save(windowId, window.hwnd());
+	}
+
+	// Applies the stored placement to the window, right after creation. Returns
+	// false if no placement was ever saved under this id, leaving the window at
+	// its setup defaults.
+	bool restore(UINT windowId, HWND hWnd) {
+		this->_check_open();
+		_slot* pSlot = this->_find_slot(windowId, false);
+		if (!pSlot || !pSlot->used) return false;
+
+		WINDOWPLACEMENT wp = pSlot->wp;
+		wp.length = sizeof(WINDOWPLACEMENT);
+		return SetWindowPlacement(hWnd, &wp) != FALSE;
+	}
+
+	bool restore(UINT windowId, const wnd& window) {
+		return this->restore(windowId, window.hwnd());
+	}
+
+	// Tells if a placement has been saved under this id.
+	bool has(UINT windowId) {
+		this->_check_open();
+		_slot* pSlot = this->_find_slot(windowId, false);
+		return pSlot && pSlot->used;
+	}
+
+private:
+	_header* _hdr() noexcept {
+		return reinterpret_cast<_header*>(this->_fm.p_mem());
+	}
+
+	_slot* _slots() noexcept {
+		return reinterpret_cast<_slot*>(this->_fm.p_mem() + sizeof(_header));
+	}
+
+	void _check_open() {
+		if (!this->_fm.p_mem()) {
+			throw std::logic_error("Window placement file has not been opened.");
+		}
+	}
+
+	_slot* _find_slot(UINT windowId, bool claimFree) {
+		_slot* pSlots = this->_slots();
+		UINT count = this->_hdr()->slotCount;
+		_slot* pFree = nullptr;
+
+		for (UINT i = 0; i < count; ++i) {
+			if (pSlots[i].used && pSlots[i].windowId == windowId) {
+				return &pSlots[i];
+			}
+			if (!pFree && !pSlots[i].used) {
+				pFree = &pSlots[i];
+			}
+		}
+
+		if (!claimFree) return nullptr;
+		if (!pFree) {
+			throw std::logic_error("No free window placement slots; open() with more capacity.");
+		}
+		return pFree;
+	}
+};
+
+}//namespace wl
@@ -6,6 +6,7 @@
  */
 
 #pragma once
+#include "internals/invalidate_batcher.h"
 #include <Windows.h>
 
 namespace wl {
@@ -24,6 +25,17 @@ public:
 	HWND hwnd() const noexcept {
 		return this->_hWnd;
 	}
+
+	// Schedules a repaint of the window, or of a rect of it in client
+	// coordinates. Called inside a message handler, the request is only
+	// recorded: when the handler returns, all requests raised during it are
+	// unioned per top-level window and flushed as a minimal set of composite
+	// invalidations — a bulk update touching dozens of controls triggers one
+	// paint pass, not one WM_PAINT per control. Outside a handler it behaves
+	// like a plain InvalidateRect.
+	void invalidate(const RECT* rc = nullptr, bool erase = false) const noexcept {
+		_wli::invalidate_batcher::current().request(this->_hWnd, rc, erase);
+	}
 };
 
 }//namespace wl
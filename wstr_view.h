@@ -0,0 +1,83 @@
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <string>
+#include <Windows.h>
+
+namespace wl {
+
+// Non-owning view over a wchar_t sequence — a stand-in for std::wstring_view,
+// which the library's C++ level predates. It carries only pointer and length:
+// the viewed characters must outlive the view, and are not necessarily
+// null-terminated, so a slice of a parsed buffer or of mapped file content
+// can travel through the API without an intermediate wstring. When a raw
+// Win32 call needs termination, c_str_in stages the view through a reused
+// caller buffer.
+class wstr_view final {
+private:
+	const wchar_t* _p = nullptr;
+	size_t         _len = 0;
+
+public:
+	static const size_t npos = static_cast<size_t>(-1);
+
+	wstr_view() = default;
+	wstr_view(const wchar_t* s) noexcept : _p(s), _len(s ? lstrlenW(s) : 0) { }
+	wstr_view(const wchar_t* s, size_t len) noexcept : _p(s), _len(len) { }
+	wstr_view(const std::wstring& s) noexcept : _p(s.c_str()), _len(s.length()) { }
+
+	const wchar_t* data() const noexcept   { return this->_p; }
+	size_t         length() const noexcept { return this->_len; }
+	size_t         size() const noexcept   { return this->_len; }
+	bool           empty() const noexcept  { return !this->_len; }
+	const wchar_t* begin() const noexcept  { return this->_p; }
+	const wchar_t* end() const noexcept    { return this->_p + this->_len; }
+
+	wchar_t operator[](size_t index) const noexcept {
+		return this->_p[index];
+	}
+
+	// A view of a slice of this view; no characters are copied.
+	wstr_view substr(size_t pos, size_t count = npos) const noexcept {
+		if (pos > this->_len) return {};
+		if (count == npos || pos + count > this->_len) count = this->_len - pos;
+		return {this->_p + pos, count};
+	}
+
+	// Index of the first occurrence of ch at or past from, or npos.
+	size_t find(wchar_t ch, size_t from = 0) const noexcept {
+		for (size_t i = from; i < this->_len; ++i) {
+			if (this->_p[i] == ch) return i;
+		}
+		return npos;
+	}
+
+	bool operator==(wstr_view other) const noexcept {
+		return this->_len == other._len &&
+			!memcmp(this->_p, other._p, this->_len * sizeof(wchar_t));
+	}
+
+	bool operator!=(wstr_view other) const noexcept {
+		return !this->operator==(other);
+	}
+
+	// An owning copy; the one place a view deliberately allocates.
+	std::wstring to_wstring() const {
+		return {this->_p, this->_len};
+	}
+
+	// Null-terminated access for raw API calls: the view is copied into the
+	// given buffer, whose capacity is reused across calls, so code staging many
+	// slices through the same buffer stops allocating once it is warm.
+	const wchar_t* c_str_in(std::wstring& buf) const {
+		buf.assign(this->_p, this->_len);
+		return buf.c_str();
+	}
+};
+
+}//namespace wl
@@ -6,11 +6,17 @@
  */
 
 #pragma once
+#include <algorithm>
+#include <functional>
 #include <string>
 #include "com.h"
 #include "insert_order_map.h"
 #include <MsXml2.h>
+#include <Shlwapi.h>
+#include <xmllite.h>
 #pragma comment(lib, "msxml2.lib")
+#pragma comment(lib, "shlwapi.lib")
+#pragma comment(lib, "xmllite.lib")
 
 namespace wl {
 
@@ -19,25 +25,102 @@ class xml final {
 public:
 	// A single XML node.
 	class node final {
+	private:
+		// Lazy per-node name index: one bucket per distinct child name, sorted
+		// case-insensitively, each holding the indexes of the equally named
+		// children. Built on the first query, rebuilt when the children vector
+		// changes size since.
+		struct _name_bucket final {
+			std::wstring        name;
+			std::vector<size_t> childIdxs;
+		};
+
+		std::vector<_name_bucket> _nameIndex;
+		size_t                    _indexedChildCount = static_cast<size_t>(-1); // -1 = never built
+
 	public:
 		std::wstring name;
 		std::wstring value;
 		insert_order_map<std::wstring, std::wstring> attrs;
 		std::vector<node> children;
 
+		// Non-owning view over the children that share one name, in document
+		// order; backed by the name index, nothing is copied.
+		class children_view final {
+			friend class node;
+
+		private:
+			node*                      _owner = nullptr;
+			const std::vector<size_t>* _childIdxs = nullptr;
+
+			children_view(node* owner, const std::vector<size_t>* childIdxs) noexcept :
+				_owner{owner}, _childIdxs{childIdxs} { }
+
+		public:
+			children_view() = default;
+
+			size_t size() const noexcept  { return this->_childIdxs ? this->_childIdxs->size() : 0; }
+			bool   empty() const noexcept { return !this->size(); }
+
+			node& operator[](size_t i) const noexcept {
+				return this->_owner->children[(*this->_childIdxs)[i]];
+			}
+
+			// Minimal forward iteration, enough for range-for.
+			class iterator final {
+				friend class children_view;
+
+			private:
+				const children_view* _view = nullptr;
+				size_t               _i = 0;
+
+				iterator(const children_view* view, size_t i) noexcept : _view{view}, _i{i} { }
+
+			public:
+				node& operator*() const noexcept              { return (*this->_view)[this->_i]; }
+				iterator& operator++() noexcept               { ++this->_i; return *this; }
+				bool operator!=(const iterator& o) const noexcept { return this->_i != o._i; }
+			};
+
+			iterator begin() const noexcept { return {this, 0}; }
+			iterator end() const noexcept   { return {this, this->size()}; }
+		};
+
 		void clear() noexcept {
 			this->name.clear();
 			this->value.clear();
 			this->attrs.clear();
 			this->children.clear();
+			this->_nameIndex.clear();
+			this->_indexedChildCount = static_cast<size_t>(-1);
+		}
+
+		// Drops the lazily built name index; call after renaming children in
+		// place, which the size-based staleness check can't see.
+		void invalidate_child_index() noexcept {
+			this->_nameIndex.clear();
+			this->_indexedChildCount = static_cast<size_t>(-1);
+		}
+
+		// Returns a no-copy view of the equally named children, in document
+		// order; the lookup is a binary search over the lazily built name index.
+		// The view is invalidated by any change to the children vector.
+		children_view children_named_view(const wchar_t* elemName) {
+			this->_ensure_index();
+			const _name_bucket* bucket = this->_find_bucket(elemName);
+			return {this, bucket ? &bucket->childIdxs : nullptr};
+		}
+
+		children_view children_named_view(const std::wstring& elemName) {
+			return this->children_named_view(elemName.c_str());
 		}
 
 		std::vector<std::reference_wrapper<node>> children_by_name(const wchar_t* elemName) {
+			children_view view = this->children_named_view(elemName);
 			std::vector<std::reference_wrapper<node>> nodeBuf;
-			for (node& node : this->children) {
-				if (!lstrcmpiW(node.name.c_str(), elemName)) { // case-insensitive match
-					nodeBuf.emplace_back(node);
-				}
+			nodeBuf.reserve(view.size());
+			for (size_t i = 0; i < view.size(); ++i) {
+				nodeBuf.emplace_back(view[i]);
 			}
 			return nodeBuf;
 		}
@@ -46,17 +129,118 @@ public:
 			return this->children_by_name(elemName.c_str());
 		}
 
-		node* first_child_by_name(const wchar_t* elemName) noexcept {
-			for (node& node : this->children) {
-				if (!lstrcmpiW(node.name.c_str(), elemName)) { // case-insensitive match
-					return &node;
+		node* first_child_by_name(const wchar_t* elemName) {
+			children_view view = this->children_named_view(elemName);
+			return view.empty() ? nullptr : &view[0]; // not found = nullptr
+		}
+
+		node* first_child_by_name(const std::wstring& elemName) {
+			return this->first_child_by_name(elemName.c_str());
+		}
+
+	private:
+		void _ensure_index() {
+			if (this->_indexedChildCount == this->children.size()) {
+				return; // still fresh
+			}
+			this->_nameIndex.clear();
+
+			for (size_t i = 0; i < this->children.size(); ++i) {
+				const std::wstring& childName = this->children[i].name;
+				auto itBucket = std::lower_bound(
+					this->_nameIndex.begin(), this->_nameIndex.end(), childName.c_str(),
+					[](const _name_bucket& b, const wchar_t* n) noexcept -> bool {
+						return lstrcmpiW(b.name.c_str(), n) < 0;
+					});
+
+				if (itBucket != this->_nameIndex.end() &&
+					!lstrcmpiW(itBucket->name.c_str(), childName.c_str()))
+				{
+					itBucket->childIdxs.push_back(i); // document order is preserved
+				} else {
+					itBucket = this->_nameIndex.insert(itBucket, {childName, {}});
+					itBucket->childIdxs.push_back(i);
 				}
 			}
-			return nullptr; // not found
+			this->_indexedChildCount = this->children.size();
 		}
 
-		node* first_child_by_name(const std::wstring& elemName) noexcept {
-			return this->first_child_by_name(elemName.c_str());
+		const _name_bucket* _find_bucket(const wchar_t* elemName) const noexcept {
+			auto itBucket = std::lower_bound(
+				this->_nameIndex.begin(), this->_nameIndex.end(), elemName,
+				[](const _name_bucket& b, const wchar_t* n) noexcept -> bool {
+					return lstrcmpiW(b.name.c_str(), n) < 0;
+				});
+			if (itBucket != this->_nameIndex.end() &&
+				!lstrcmpiW(itBucket->name.c_str(), elemName))
+			{
+				return &*itBucket;
+			}
+			return nullptr;
+		}
+	};
+
+	// Lambdas invoked by parse_stream for each piece of the document.
+	struct stream_handler final {
+		std::function<void(const std::wstring& name,
+			const insert_order_map<std::wstring, std::wstring>& attrs)> on_element_start;
+		std::function<void(const std::wstring& name)> on_element_end;
+		std::function<void(const std::wstring& text)> on_text;
+	};
+
+	// A node over the live MSXML DOM: name and attributes are read upfront, but
+	// the children vector is materialized, one level at a time, on first access.
+	class lazy_node final {
+	private:
+		com::ptr<IXMLDOMNode>  _domNode; // keeps the document alive
+		std::vector<lazy_node> _children;
+		bool                   _childrenLoaded = false;
+
+	public:
+		std::wstring name;
+		insert_order_map<std::wstring, std::wstring> attrs;
+
+		lazy_node(lazy_node&&) = default;
+		lazy_node& operator=(lazy_node&&) = default; // movable only
+
+		explicit lazy_node(com::ptr<IXMLDOMNode>&& domNode) :
+			_domNode{std::move(domNode)}
+		{
+			com::bstr bstrName;
+			this->_domNode->get_nodeName(&bstrName);
+			this->name = bstrName.c_str();
+			this->attrs = _read_attrs(this->_domNode);
+		}
+
+		// Returns the text of the node, queried from the DOM on demand.
+		std::wstring value() {
+			com::bstr bstrText;
+			this->_domNode->get_text(&bstrText);
+			return bstrText.c_str();
+		}
+
+		// Returns the child element nodes, materialized on the first call only.
+		std::vector<lazy_node>& children() {
+			if (!this->_childrenLoaded) {
+				com::ptr<IXMLDOMNodeList> nodeList;
+				this->_domNode->get_childNodes(&nodeList);
+
+				long totalCount = 0;
+				nodeList->get_length(&totalCount);
+
+				for (long i = 0; i < totalCount; ++i) {
+					com::ptr<IXMLDOMNode> child;
+					nodeList->get_item(i, &child);
+
+					DOMNodeType type = NODE_INVALID;
+					child->get_nodeType(&type);
+					if (type == NODE_ELEMENT) {
+						this->_children.emplace_back(std::move(child)); // one level down only
+					}
+				}
+				this->_childrenLoaded = true;
+			}
+			return this->_children;
 		}
 	};
 
@@ -109,6 +293,112 @@ public:
 		return this->parse(str.c_str());
 	}
 
+	// Parses the XML string in streaming (pull) mode over IXmlReader: the given
+	// lambdas are invoked per element/text as the reader advances, and no node
+	// tree is ever built, so memory stays flat regardless of document size.
+	static void parse_stream(const wchar_t* str, const stream_handler& handler) {
+		// Feed the reader raw UTF-16 bytes, prefixed with a BOM so the encoding is detected.
+		std::vector<BYTE> rawBytes;
+		size_t numChars = lstrlenW(str);
+		rawBytes.reserve(2 + numChars * sizeof(wchar_t));
+		rawBytes.push_back(0xFF); // UTF-16 LE BOM
+		rawBytes.push_back(0xFE);
+		rawBytes.insert(rawBytes.end(),
+			reinterpret_cast<const BYTE*>(str),
+			reinterpret_cast<const BYTE*>(str + numChars));
+
+		com::ptr<IStream> stream{
+			SHCreateMemStream(&rawBytes[0], static_cast<UINT>(rawBytes.size()))};
+		if (!stream) {
+			throw std::system_error(ERROR_OUTOFMEMORY, std::system_category(),
+				"SHCreateMemStream failed");
+		}
+
+		com::ptr<IXmlReader> reader;
+		com::check_hr(
+			CreateXmlReader(__uuidof(IXmlReader), reinterpret_cast<void**>(&reader), nullptr),
+			"CreateXmlReader failed");
+		com::check_hr(reader->SetInput(stream), "IXmlReader::SetInput failed");
+
+		std::wstring tmpName; // reused across nodes
+		insert_order_map<std::wstring, std::wstring> tmpAttrs;
+
+		XmlNodeType nodeType = XmlNodeType_None;
+		while (reader->Read(&nodeType) == S_OK) {
+			const wchar_t* pValue = nullptr;
+
+			switch (nodeType) {
+			case XmlNodeType_Element: {
+				reader->GetQualifiedName(&pValue, nullptr);
+				tmpName = pValue;
+				tmpAttrs.clear();
+				for (HRESULT hrAttr = reader->MoveToFirstAttribute();
+					hrAttr == S_OK; hrAttr = reader->MoveToNextAttribute())
+				{
+					const wchar_t* pAttrName = nullptr;
+					const wchar_t* pAttrVal = nullptr;
+					reader->GetQualifiedName(&pAttrName, nullptr);
+					reader->GetValue(&pAttrVal, nullptr);
+					tmpAttrs[pAttrName] = pAttrVal;
+				}
+				reader->MoveToElement(); // leave the attribute cursor
+				if (handler.on_element_start) handler.on_element_start(tmpName, tmpAttrs);
+
+				BOOL isEmpty = reader->IsEmptyElement(); // <foo/> has no matching EndElement
+				if (isEmpty && handler.on_element_end) handler.on_element_end(tmpName);
+				break;
+			}
+			case XmlNodeType_EndElement:
+				reader->GetQualifiedName(&pValue, nullptr);
+				if (handler.on_element_end) {
+					tmpName = pValue;
+					handler.on_element_end(tmpName);
+				}
+				break;
+			case XmlNodeType_Text:
+			case XmlNodeType_CDATA:
+				reader->GetValue(&pValue, nullptr);
+				if (handler.on_text) handler.on_text(pValue);
+				break;
+			default:
+				break; // whitespace, comments, processing instructions
+			}
+		}
+	}
+
+	static void parse_stream(const std::wstring& str, const stream_handler& handler) {
+		parse_stream(str.c_str(), handler);
+	}
+
+	// Parses the XML string building the DOM only: the returned lazy_node reads
+	// names and attributes upfront, but materializes children on first access,
+	// so untouched subtrees are never copied out of the DOM.
+	lazy_node parse_lazy(const wchar_t* str) {
+		this->_comLib.initialize(); // init COM library, if not yet
+
+		com::ptr<IXMLDOMDocument2> doc;
+		doc.co_create_instance(CLSID_DOMDocument30, IID_IXMLDOMDocument);
+		doc->put_async(FALSE);
+
+		VARIANT_BOOL vb = FALSE;
+		com::check_hr(
+			doc->loadXML(static_cast<BSTR>(const_cast<wchar_t*>(str)), &vb),
+			"IXMLDOMDocument::loadXML failed");
+
+		com::ptr<IXMLDOMElement> docElem;
+		com::check_hr(
+			doc->get_documentElement(&docElem),
+			"IXMLDOMDocument::get_documentElement failed");
+
+		com::ptr<IXMLDOMNode> rootNode;
+		docElem.query_interface(IID_IXMLDOMNode, &rootNode);
+		return lazy_node{std::move(rootNode)}; // node keeps the document alive
+	}
+
+	lazy_node parse_lazy(const std::wstring& str) {
+		return this->parse_lazy(str.c_str());
+	}
+
 private:
 	static xml::node _build_node(com::ptr<IXMLDOMNode>& xmlDomNode) {
 		xml::node ret;
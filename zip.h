@@ -1,73 +1,349 @@
-/**
- * Part of WinLamb - Win32 API Lambda Library
- * https://github.com/rodrigocfd/winlamb
- * Copyright 2017-present Rodrigo Cesar de Freitas Dias
- * This library is released under the MIT License
- */
-
-#pragma once
-#include "file.h"
-#include "com.h"
-#include <Shlobj.h>
-
-namespace wl {
-
-// Utilities to work with zipped files.
-class zip final {
-private:
-	zip() = delete;
-
-public:
-	static void extract_all(const std::wstring& zipFile, const std::wstring& destFolder) {
-		if (!file::util::exists(zipFile)) {
-			throw std::invalid_argument("File doesn't exist.");
-		}
-		if (!file::util::exists(destFolder)) {
-			throw std::invalid_argument("Output directory doesn't exist.");
-		}
-
-		// http://social.msdn.microsoft.com/Forums/vstudio/en-US/45668d18-2840-4887-87e1-4085201f4103/visual-c-to-unzip-a-zip-file-to-a-specific-directory
-		com::lib comLib{com::lib::init::NOW};
-
-		com::ptr<IShellDispatch> shellDispatch;
-		shellDispatch.co_create_instance(CLSID_Shell, IID_IShellDispatch);
-		
-		com::variant variZipFilePath;
-		variZipFilePath.set_str(zipFile);
-
-		com::ptr<Folder> zippedFile;
-		com::check_hr(
-			shellDispatch->NameSpace(variZipFilePath, &zippedFile),
-			"IShellDispatch::NameSpace failed on zip file name");
-		
-		com::variant variOutFolderPath;
-		variOutFolderPath.set_str(destFolder);
-
-		com::ptr<Folder> outFolder;
-		com::check_hr(
-			shellDispatch->NameSpace(variOutFolderPath, &outFolder),
-			"IShellDispatch::NameSpace failed on directory name");
-
-		com::ptr<FolderItems> filesInside;
-		com::check_hr(
-			zippedFile->Items(&filesInside),
-			"Folder::Items failed");
-
-		long fileCount = 0;
-		com::check_hr(
-			filesInside->get_Count(&fileCount),
-			"Folder::get_Count failed");
-
-		com::variant variItem;
-		variItem.set_idispatch(filesInside);
-
-		com::variant variOptions;
-		variOptions.set_int4(1024 | 512 | 16 | 4); // http://msdn.microsoft.com/en-us/library/bb787866(VS.85).aspx
-
-		com::check_hr(
-			outFolder->CopyHere(variItem, variOptions),
-			"Folder::CopyHere failed");
-	}
-};
-
-}//namespace wl
\ No newline at end of file
+/**
+ * Part of WinLamb - Win32 API Lambda Library
+ * https://github.com/rodrigocfd/winlamb
+ * Copyright 2017-present Rodrigo Cesar de Freitas Dias
+ * This library is released under the MIT License
+ */
+
+#pragma once
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include "file.h"
+#include "file_mapped.h"
+#include "internals/zip_priv.h"
+#include <process.h>
+
+namespace wl {
+
+// Utilities to work with zipped files. The archive is parsed natively from its
+// central directory over a memory-mapped view, with per-member inflate; no
+// shell automation (IShellDispatch) is involved.
+class zip final {
+private:
+	zip() = delete;
+
+	static const WORD _METHOD_STORED = 0, _METHOD_DEFLATE = 8;
+
+public:
+	// One member of the archive, as read from the central directory.
+	struct entry final {
+		std::wstring name;             // path inside the archive, backslash-normalized
+		size_t       compressedSize = 0;
+		size_t       uncompressedSize = 0;
+		size_t       headerOffset = 0; // offset of the local file header
+		WORD         compressionMethod = 0;
+		DWORD        crc32 = 0;
+
+		bool is_directory() const noexcept {
+			return !this->name.empty() && this->name.back() == L'\\';
+		}
+	};
+
+	// An open zip archive: the central directory is parsed once into an index,
+	// and members can be listed, found and extracted individually.
+	class archive final {
+	private:
+		file_mapped        _mappedFile;
+		std::vector<entry> _entries;
+
+	public:
+		archive() = default;
+		archive(archive&&) = default;
+		archive& operator=(archive&&) = default; // movable only
+
+		const std::vector<entry>& entries() const noexcept {
+			return this->_entries;
+		}
+
+		archive& close() noexcept {
+			this->_mappedFile.close();
+			this->_entries.clear();
+			return *this;
+		}
+
+		// Opens the archive and parses its central directory into the member index.
+		archive& open(const std::wstring& zipFilePath) {
+			this->close();
+			this->_mappedFile.open(zipFilePath, file::access::READONLY);
+			this->_parse_central_directory();
+			return *this;
+		}
+
+		// Returns the first member whose name matches, case-insensitive, or nullptr.
+		const entry* find(const std::wstring& memberName) const noexcept {
+			for (const entry& e : this->_entries) {
+				if (!lstrcmpiW(e.name.c_str(), memberName.c_str())) {
+					return &e;
+				}
+			}
+			return nullptr;
+		}
+
+		// Decompresses a single member into memory.
+		std::vector<BYTE> extract_to_buffer(const entry& memberEntry) {
+			std::vector<BYTE> buf(memberEntry.uncompressedSize, 0x00);
+			if (memberEntry.uncompressedSize) {
+				this->_inflate_member(memberEntry, &buf[0]);
+			}
+			return buf;
+		}
+
+		// Decompresses a single member to disk, under the given folder.
+		void extract(const entry& memberEntry, const std::wstring& destFolder) {
+			if (_is_unsafe_name(memberEntry.name)) { // zip-slip: "..\..\foo" or a rooted name
+				throw std::runtime_error("Zip member name escapes the destination folder.");
+			}
+
+			std::wstring destPath = destFolder;
+			if (destPath.back() != L'\\') destPath += L'\\';
+			destPath += memberEntry.name;
+
+			this->_create_sub_dirs(destPath);
+			if (memberEntry.is_directory()) return; // nothing else to write
+
+			std::vector<BYTE> buf = this->extract_to_buffer(memberEntry);
+			file fout;
+			fout.open_or_create(destPath);
+			fout.set_new_size(buf.size());
+			if (!buf.empty()) fout.write(buf);
+		}
+
+		// Extracts every member to disk. Independent members are decompressed in
+		// parallel by numThreads workers (0 = one per CPU); the progress callback,
+		// if any, is invoked from the workers, serialized, as (numDone, numTotal).
+		void extract_all(const std::wstring& destFolder,
+			std::function<void(size_t numDone, size_t numTotal)> progressCallback = nullptr,
+			size_t numThreads = 0)
+		{
+			if (!file::util::exists(destFolder)) {
+				throw std::invalid_argument("Output directory doesn't exist.");
+			}
+			if (!numThreads) {
+				SYSTEM_INFO si{};
+				GetNativeSystemInfo(&si);
+				numThreads = si.dwNumberOfProcessors ? si.dwNumberOfProcessors : 2;
+			}
+			if (numThreads > MAXIMUM_WAIT_OBJECTS) numThreads = MAXIMUM_WAIT_OBJECTS;
+			if (numThreads > this->_entries.size()) numThreads = this->_entries.size();
+			if (!numThreads) return; // empty archive
+
+			// Workers share the read-only mapping; each one takes a strided slice
+			// of the member index, so no two of them ever touch the same output file.
+			struct _job_pack final {
+				archive*            pSelf;
+				const std::wstring* pDestFolder;
+				size_t              firstIndex, stride;
+				std::atomic<size_t>* pNumDone;
+				std::mutex*          pProgressMtx;
+				std::function<void(size_t, size_t)>* pProgress;
+				std::exception_ptr   thrownExcept;
+			};
+
+			std::atomic<size_t> numDone{0};
+			std::mutex progressMtx;
+			std::vector<_job_pack> jobs(numThreads);
+			std::vector<HANDLE> workers(numThreads, nullptr);
+
+			for (size_t i = 0; i < numThreads; ++i) {
+				jobs[i] = {this, &destFolder, i, numThreads,
+					&numDone, &progressMtx, &progressCallback, nullptr};
+
+				workers[i] = reinterpret_cast<HANDLE>(
+					_beginthreadex(nullptr, 0, [](void* ptr) noexcept -> unsigned int {
+						_job_pack* pJob = reinterpret_cast<_job_pack*>(ptr);
+						try {
+							pJob->pSelf->_extract_slice(*pJob->pDestFolder,
+								pJob->firstIndex, pJob->stride,
+								*pJob->pNumDone, *pJob->pProgressMtx, *pJob->pProgress);
+						} catch (...) {
+							pJob->thrownExcept = std::current_exception();
+						}
+						return 0;
+					}, &jobs[i], 0, nullptr));
+			}
+
+			WaitForMultipleObjects(static_cast<DWORD>(numThreads), &workers[0], TRUE, INFINITE);
+			for (HANDLE hWorker : workers) CloseHandle(hWorker);
+			for (_job_pack& job : jobs) {
+				if (job.thrownExcept) std::rethrow_exception(job.thrownExcept); // 1st failure wins
+			}
+		}
+
+	private:
+		void _extract_slice(const std::wstring& destFolder, size_t firstIndex, size_t stride,
+			std::atomic<size_t>& numDone, std::mutex& progressMtx,
+			std::function<void(size_t, size_t)>& progressCallback)
+		{
+			for (size_t i = firstIndex; i < this->_entries.size(); i += stride) {
+				this->extract(this->_entries[i], destFolder);
+				size_t doneSoFar = ++numDone;
+				if (progressCallback) {
+					std::lock_guard<std::mutex> lock(progressMtx); // serialize user callback
+					progressCallback(doneSoFar, this->_entries.size());
+				}
+			}
+		}
+
+		void _inflate_member(const entry& memberEntry, BYTE* dst) {
+			const BYTE* pData = this->_member_data(memberEntry);
+
+			if (memberEntry.compressionMethod == _METHOD_STORED) {
+				memcpy(dst, pData, memberEntry.uncompressedSize);
+			} else if (memberEntry.compressionMethod == _METHOD_DEFLATE) {
+				_wli::zip_priv::inflate(pData, memberEntry.compressedSize,
+					dst, memberEntry.uncompressedSize);
+			} else {
+				throw std::runtime_error("Zip member uses an unsupported compression method.");
+			}
+
+			if (_wli::zip_priv::crc32(dst, memberEntry.uncompressedSize) != memberEntry.crc32) {
+				throw std::runtime_error("Zip member failed CRC-32 check.");
+			}
+		}
+
+		// Resolves the offset of the member data, past its local file header.
+		const BYTE* _member_data(const entry& memberEntry) {
+			const BYTE* pMem = this->_mappedFile.p_mem();
+			size_t fileSize = this->_mappedFile.size();
+
+			if (memberEntry.headerOffset + 30 > fileSize ||
+				this->_read_dword(pMem + memberEntry.headerOffset) != 0x04034B50) // "PK\3\4"
+			{
+				throw std::runtime_error("Zip local file header is corrupt.");
+			}
+
+			size_t nameLen = this->_read_word(pMem + memberEntry.headerOffset + 26);
+			size_t extraLen = this->_read_word(pMem + memberEntry.headerOffset + 28);
+			size_t dataOffset = memberEntry.headerOffset + 30 + nameLen + extraLen;
+			if (dataOffset + memberEntry.compressedSize > fileSize) {
+				throw std::runtime_error("Zip member data runs past end of file.");
+			}
+			return pMem + dataOffset;
+		}
+
+		void _parse_central_directory() {
+			const BYTE* pMem = this->_mappedFile.p_mem();
+			size_t fileSize = this->_mappedFile.size();
+			if (fileSize < 22) {
+				throw std::runtime_error("File is too small to be a zip archive.");
+			}
+
+			// Find the end-of-central-directory record, scanning backwards over
+			// a possible trailing comment (up to 64KB).
+			size_t scanFloor = fileSize > 22 + 0xFFFF ? fileSize - 22 - 0xFFFF : 0;
+			size_t eocdOffset = -1;
+			for (size_t i = fileSize - 22; ; --i) {
+				if (this->_read_dword(pMem + i) == 0x06054B50) { // "PK\5\6"
+					eocdOffset = i;
+					break;
+				}
+				if (i == scanFloor) break;
+			}
+			if (eocdOffset == -1) {
+				throw std::runtime_error("Zip end of central directory not found.");
+			}
+
+			size_t numEntries = this->_read_word(pMem + eocdOffset + 10);
+			size_t cdOffset = this->_read_dword(pMem + eocdOffset + 16);
+
+			this->_entries.clear();
+			this->_entries.reserve(numEntries);
+
+			size_t runner = cdOffset;
+			for (size_t i = 0; i < numEntries; ++i) {
+				if (runner + 46 > fileSize ||
+					this->_read_dword(pMem + runner) != 0x02014B50) // "PK\1\2"
+				{
+					throw std::runtime_error("Zip central directory is corrupt.");
+				}
+
+				entry e;
+				WORD flags           = this->_read_word(pMem + runner + 8);
+				e.compressionMethod  = this->_read_word(pMem + runner + 10);
+				e.crc32              = this->_read_dword(pMem + runner + 16);
+				e.compressedSize     = this->_read_dword(pMem + runner + 20);
+				e.uncompressedSize   = this->_read_dword(pMem + runner + 24);
+				size_t nameLen       = this->_read_word(pMem + runner + 28);
+				size_t extraLen      = this->_read_word(pMem + runner + 30);
+				size_t commentLen    = this->_read_word(pMem + runner + 32);
+				e.headerOffset       = this->_read_dword(pMem + runner + 42);
+
+				// The three variable lengths come from the file; unchecked, a
+				// truncated archive would read up to 64KB past the mapping.
+				if (runner + 46 + nameLen + extraLen + commentLen > fileSize) {
+					throw std::runtime_error("Zip central directory entry runs past end of file.");
+				}
+
+				e.name = this->_decode_name(pMem + runner + 46, nameLen,
+					(flags & 0x0800) != 0); // bit 11: name is UTF-8
+				this->_entries.emplace_back(std::move(e));
+
+				runner += 46 + nameLen + extraLen + commentLen;
+			}
+		}
+
+		std::wstring _decode_name(const BYTE* pName, size_t nameLen, bool isUtf8) const {
+			std::wstring name;
+			if (nameLen) {
+				int lenNeeded = MultiByteToWideChar(isUtf8 ? CP_UTF8 : CP_OEMCP, 0,
+					reinterpret_cast<const char*>(pName), static_cast<int>(nameLen), nullptr, 0);
+				name.resize(lenNeeded);
+				MultiByteToWideChar(isUtf8 ? CP_UTF8 : CP_OEMCP, 0,
+					reinterpret_cast<const char*>(pName), static_cast<int>(nameLen),
+					&name[0], lenNeeded);
+				for (wchar_t& ch : name) {
+					if (ch == L'/') ch = L'\\'; // normalize to Windows separators
+				}
+			}
+			return name;
+		}
+
+		// The member name becomes part of the output path, so a crafted archive
+		// could aim outside the destination folder: rejects rooted and
+		// drive-prefixed names, and any ".." path component.
+		static bool _is_unsafe_name(const std::wstring& name) noexcept {
+			if (name.empty() || name[0] == L'\\') return true; // rooted, "\foo" or "\\server\share"
+			if (name.size() >= 2 && name[1] == L':') return true; // drive-prefixed, "c:..."
+
+			size_t i = 0;
+			for (;;) { // walk the backslash-normalized components
+				size_t iSep = name.find(L'\\', i);
+				size_t len = (iSep == std::wstring::npos ? name.size() : iSep) - i;
+				if (len == 2 && name[i] == L'.' && name[i + 1] == L'.') return true;
+				if (iSep == std::wstring::npos) return false;
+				i = iSep + 1;
+			}
+		}
+
+		// Creates every intermediate directory of the given full path.
+		void _create_sub_dirs(const std::wstring& fullPath) const {
+			size_t iSep = fullPath.find(L'\\', 3); // skip drive/UNC root
+			while (iSep != std::wstring::npos) {
+				CreateDirectoryW(fullPath.substr(0, iSep).c_str(), nullptr); // fails silently if existing
+				iSep = fullPath.find(L'\\', iSep + 1);
+			}
+		}
+
+		WORD _read_word(const BYTE* p) const noexcept {
+			return static_cast<WORD>(p[0] | (p[1] << 8));
+		}
+
+		DWORD _read_dword(const BYTE* p) const noexcept {
+			return static_cast<DWORD>(p[0] | (p[1] << 8) | (p[2] << 16) |
+				(static_cast<DWORD>(p[3]) << 24));
+		}
+	};
+
+	// Extracts all members of a zip file into the given folder.
+	static void extract_all(const std::wstring& zipFile, const std::wstring& destFolder) {
+		if (!file::util::exists(zipFile)) {
+			throw std::invalid_argument("File doesn't exist.");
+		}
+		archive zipArchive;
+		zipArchive.open(zipFile);
+		zipArchive.extract_all(destFolder);
+	}
+};
+
+}//namespace wl